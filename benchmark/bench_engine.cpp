@@ -0,0 +1,153 @@
+#include "centipede/core/engines/engine_types.hpp"
+#include "centipede/core/engines/master_engine.hpp"
+#include "centipede/data/entry_base.hpp"
+#include "shared.hpp"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace centipede::bench
+{
+    namespace
+    {
+        constexpr auto FIXED_N_LOCALS = std::size_t{ 5 }; //!< Number of locals of the fixed-size local fit.
+        constexpr auto BATCH_SIZE = std::size_t{ 64 };    //!< Number of flat entries analyzed in one call.
+        static_assert(N_GENERATED_ENTRIES % BATCH_SIZE == 0);
+
+        template <core::engine::MatrixEngineType engine_type, std::size_t n_locals = internal::DYNAMIC_SIZE>
+        using Master =
+            core::engine::Master<float, core::engine::MasterOpt{ .engine_type = engine_type, .n_locals = n_locals }>;
+
+        /**
+         * @brief Add the entrypoints of an entry to the master. The analysis of the entry is excluded from the timing.
+         */
+        template <core::engine::MatrixEngineType engine_type>
+        void master_add_entrypoint(benchmark::State& state)
+        {
+            const auto shape = get_shape(state);
+            const auto entries = generate_entries(shape);
+            auto master = Master<engine_type>{ { .n_globals = shape.n_globals } };
+
+            auto entry_idx = std::size_t{};
+            for (auto _ : state)
+            {
+                for (const auto& point : entries[entry_idx % entries.size()])
+                {
+                    benchmark::DoNotOptimize(master.add_entrypoint(point));
+                }
+                ++entry_idx;
+                state.PauseTiming();
+                [[maybe_unused]] auto result = master.analyze();
+                state.ResumeTiming();
+            }
+            set_throughput(state, get_mean_record_size(entries));
+        }
+
+        /**
+         * @brief Add the entrypoints of an entry to the master and analyze the entry, including the local fit and the
+         * update of the global factor matrix.
+         */
+        template <core::engine::MatrixEngineType engine_type>
+        void master_analyze_entry(benchmark::State& state)
+        {
+            const auto shape = get_shape(state);
+            const auto entries = generate_entries(shape);
+            auto master = Master<engine_type>{ { .n_globals = shape.n_globals } };
+
+            auto entry_idx = std::size_t{};
+            for (auto _ : state)
+            {
+                for (const auto& point : entries[entry_idx % entries.size()])
+                {
+                    benchmark::DoNotOptimize(master.add_entrypoint(point));
+                }
+                benchmark::DoNotOptimize(master.analyze());
+                ++entry_idx;
+            }
+            set_throughput(state, get_mean_record_size(entries));
+        }
+
+        /**
+         * @brief Analyze flat entries, i.e. the path taken by entries streamed from a reader.
+         *
+         * With a compile-time `n_locals`, the master uses the fixed-size local fit.
+         */
+        template <core::engine::MatrixEngineType engine_type, std::size_t n_locals = internal::DYNAMIC_SIZE>
+        void master_analyze_flat_entry(benchmark::State& state)
+        {
+            const auto shape = get_shape(state);
+            const auto entries = generate_entries(shape);
+            const auto flat_entries = to_flat_entries(entries);
+            auto master = Master<engine_type, n_locals>{ { .n_globals = shape.n_globals } };
+
+            auto entry_idx = std::size_t{};
+            for (auto _ : state)
+            {
+                benchmark::DoNotOptimize(master.analyze(flat_entries[entry_idx % flat_entries.size()]));
+                ++entry_idx;
+            }
+            set_throughput(state, get_mean_record_size(entries));
+        }
+
+        /**
+         * @brief Analyze flat entries in batches of #BATCH_SIZE entries.
+         */
+        template <core::engine::MatrixEngineType engine_type>
+        void master_analyze_flat_batch(benchmark::State& state)
+        {
+            const auto shape = get_shape(state);
+            const auto entries = generate_entries(shape);
+            const auto flat_entries = to_flat_entries(entries);
+            const auto batches = std::span{ flat_entries };
+            auto master = Master<engine_type>{ { .n_globals = shape.n_globals } };
+
+            auto batch_idx = std::size_t{};
+            for (auto _ : state)
+            {
+                benchmark::DoNotOptimize(
+                    master.analyze(batches.subspan((batch_idx * BATCH_SIZE) % flat_entries.size(), BATCH_SIZE)));
+                ++batch_idx;
+            }
+            set_throughput(state, get_mean_record_size(entries), BATCH_SIZE);
+        }
+
+        /**
+         * @brief Entry shapes of the dense engine. The memory of the global factor matrix limits the total number of
+         * globals.
+         */
+        void apply_dense_shapes(benchmark::internal::Benchmark* bench)
+        {
+            bench->ArgNames(get_shape_arg_names())->ArgsProduct({ { 2, 5, 10 }, { 2, 8 }, { 5, 20 }, { 100, 2000 } });
+        }
+
+        /**
+         * @brief Entry shapes of the sparse engine.
+         */
+        void apply_sparse_shapes(benchmark::internal::Benchmark* bench)
+        {
+            bench->ArgNames(get_shape_arg_names())
+                ->ArgsProduct({ { 2, 5, 10 }, { 2, 8 }, { 5, 20 }, { 2000, 100000 } });
+        }
+
+        /**
+         * @brief Entry shapes of the dense engine with the fixed-size local fit.
+         */
+        void apply_fixed_local_shapes(benchmark::internal::Benchmark* bench)
+        {
+            bench->ArgNames(get_shape_arg_names())
+                ->ArgsProduct({ { static_cast<int64_t>(FIXED_N_LOCALS) }, { 2, 8 }, { 5, 20 }, { 100, 2000 } });
+        }
+
+        using enum core::engine::MatrixEngineType;
+    } // namespace
+
+    BENCHMARK_TEMPLATE(master_add_entrypoint, eigen)->Apply(apply_entry_shapes);
+    BENCHMARK_TEMPLATE(master_analyze_entry, eigen)->Apply(apply_dense_shapes);
+    BENCHMARK_TEMPLATE(master_analyze_entry, eigen_sparse)->Apply(apply_sparse_shapes);
+    BENCHMARK_TEMPLATE(master_analyze_flat_entry, eigen)->Apply(apply_dense_shapes);
+    BENCHMARK_TEMPLATE(master_analyze_flat_entry, eigen_sparse)->Apply(apply_sparse_shapes);
+    BENCHMARK_TEMPLATE(master_analyze_flat_entry, eigen, FIXED_N_LOCALS)->Apply(apply_fixed_local_shapes);
+    BENCHMARK_TEMPLATE(master_analyze_flat_batch, eigen)->Apply(apply_dense_shapes);
+    BENCHMARK_TEMPLATE(master_analyze_flat_batch, eigen_sparse)->Apply(apply_sparse_shapes);
+} // namespace centipede::bench
@@ -0,0 +1,173 @@
+#include "centipede/reader/binary.hpp"
+#include "centipede/reader/multi_file.hpp"
+#include "centipede/util/block_compression.hpp"
+#include "centipede/writer/binary.hpp"
+#include "shared.hpp"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace centipede::bench
+{
+    namespace
+    {
+        enum class ReadMode : uint8_t
+        {
+            entry, //!< reader::Binary::read_one_entry()
+            flat,  //!< reader::Binary::read_one_flat_entry()
+            raw,   //!< reader::Binary::read_one_raw_entry()
+        };
+
+        auto write_file(const std::string& filename,
+                        const std::vector<EntryPoints>& entries,
+                        common::Compression compression) -> bool
+        {
+            auto writer = writer::Binary{ writer::Binary::Config{ .out_filename = filename,
+                                                                  .compression = compression } };
+            if (not writer.init())
+            {
+                return false;
+            }
+            for (const auto& entry : entries)
+            {
+                for (const auto& point : entry)
+                {
+                    if (not writer.add_entrypoint(point))
+                    {
+                        return false;
+                    }
+                }
+                if (not writer.write_current_entry())
+                {
+                    return false;
+                }
+            }
+            writer.close();
+            return true;
+        }
+
+        auto read_entry(reader::Binary& reader, ReadMode mode)
+        {
+            switch (mode)
+            {
+                case ReadMode::flat:
+                    return reader.read_one_flat_entry();
+                case ReadMode::raw:
+                    return reader.read_one_raw_entry();
+                case ReadMode::entry:
+                default:
+                    return reader.read_one_entry();
+            }
+        }
+
+        /**
+         * @brief Read and parse the entries of a file. The file is read again from the beginning at its end.
+         */
+        void reader_read_entry(benchmark::State& state,
+                               ReadMode mode,
+                               bool use_memory_map,
+                               common::Compression compression)
+        {
+            const auto entries = generate_entries(get_shape(state));
+            const auto filename = std::string{ "benchmark_reader.bin" };
+            if (not write_file(filename, entries, compression))
+            {
+                state.SkipWithError("Failed to write the input file.");
+                return;
+            }
+            auto reader = reader::Binary{ reader::Binary::Config{ .in_filename = filename,
+                                                                  .use_memory_map = use_memory_map } };
+            if (not reader.init())
+            {
+                state.SkipWithError("Failed to open the input file.");
+                return;
+            }
+
+            for (auto _ : state)
+            {
+                auto result = read_entry(reader, mode);
+                if (not result.has_value())
+                {
+                    state.SkipWithError("Failed to read the input file.");
+                    break;
+                }
+                if (result.value() == 0U)
+                {
+                    state.PauseTiming();
+                    [[maybe_unused]] auto init_result = reader.init();
+                    state.ResumeTiming();
+                    continue;
+                }
+                benchmark::DoNotOptimize(result);
+            }
+            set_throughput(state, get_mean_record_size(entries));
+            reader.close();
+            std::filesystem::remove(filename);
+        }
+
+        /**
+         * @brief Read all entries of multiple files with the multi-file reader in each iteration.
+         */
+        void reader_multi_file(benchmark::State& state, std::size_t n_threads)
+        {
+            constexpr auto n_files = std::size_t{ 8 };
+            const auto entries = generate_entries(get_shape(state));
+            auto filenames = std::vector<std::string>{};
+            for (std::size_t file_idx = 0; file_idx < n_files; ++file_idx)
+            {
+                filenames.push_back(std::format("benchmark_reader_multi_file_{}.bin", file_idx));
+                if (not write_file(filenames.back(), entries, common::Compression::none))
+                {
+                    state.SkipWithError("Failed to write the input file.");
+                    return;
+                }
+            }
+
+            for (auto _ : state)
+            {
+                auto input = reader::MultiFile{ reader::MultiFile::Config{ .in_filenames = filenames,
+                                                                           .n_threads = n_threads } };
+                if (not input.start())
+                {
+                    state.SkipWithError("Failed to start the reader.");
+                    break;
+                }
+                while (auto batch = input.next_batch())
+                {
+                    benchmark::DoNotOptimize(batch->n_entries);
+                    input.recycle(std::move(batch.value()));
+                }
+                if (not input.is_ok())
+                {
+                    state.SkipWithError("Failed to read the input files.");
+                    break;
+                }
+            }
+            set_throughput(state, get_mean_record_size(entries), n_files * entries.size());
+            for (const auto& filename : filenames)
+            {
+                std::filesystem::remove(filename);
+            }
+        }
+    } // namespace
+
+    BENCHMARK_CAPTURE(reader_read_entry, entry_stream, ReadMode::entry, false, common::Compression::none)
+        ->Apply(apply_entry_shapes);
+    BENCHMARK_CAPTURE(reader_read_entry, entry_mmap, ReadMode::entry, true, common::Compression::none)
+        ->Apply(apply_entry_shapes);
+    BENCHMARK_CAPTURE(reader_read_entry, flat_stream, ReadMode::flat, false, common::Compression::none)
+        ->Apply(apply_entry_shapes);
+    BENCHMARK_CAPTURE(reader_read_entry, flat_mmap, ReadMode::flat, true, common::Compression::none)
+        ->Apply(apply_entry_shapes);
+    BENCHMARK_CAPTURE(reader_read_entry, raw_mmap, ReadMode::raw, true, common::Compression::none)
+        ->Apply(apply_entry_shapes);
+    BENCHMARK_CAPTURE(reader_read_entry, flat_zstd, ReadMode::flat, true, common::Compression::zstd)
+        ->Apply(apply_entry_shapes);
+    BENCHMARK_CAPTURE(reader_multi_file, threads_1, 1)->Apply(apply_entry_shapes)->UseRealTime();
+    BENCHMARK_CAPTURE(reader_multi_file, threads_4, 4)->Apply(apply_entry_shapes)->UseRealTime();
+} // namespace centipede::bench
@@ -0,0 +1,56 @@
+#include "centipede/util/block_compression.hpp"
+#include "centipede/writer/binary.hpp"
+#include "shared.hpp"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <filesystem>
+#include <string>
+
+namespace centipede::bench
+{
+    namespace
+    {
+        constexpr auto N_ENTRIES_PER_FILE = std::size_t{ 1U << 14U }; //!< The file is truncated afterwards.
+
+        /**
+         * @brief Add all entrypoints of an entry to the writer and write the entry.
+         */
+        void writer_write_entry(benchmark::State& state, writer::Binary::Config config)
+        {
+            const auto entries = generate_entries(get_shape(state));
+            config.out_filename = "benchmark_writer.bin";
+            auto writer = writer::Binary{ config };
+            if (not writer.init())
+            {
+                state.SkipWithError("Failed to open the output file.");
+                return;
+            }
+
+            auto entry_idx = std::size_t{};
+            for (auto _ : state)
+            {
+                for (const auto& point : entries[entry_idx % entries.size()])
+                {
+                    benchmark::DoNotOptimize(writer.add_entrypoint(point));
+                }
+                benchmark::DoNotOptimize(writer.write_current_entry());
+                if (++entry_idx % N_ENTRIES_PER_FILE == 0)
+                {
+                    state.PauseTiming();
+                    writer.close();
+                    [[maybe_unused]] auto result = writer.init();
+                    state.ResumeTiming();
+                }
+            }
+            writer.close();
+            set_throughput(state, get_mean_record_size(entries));
+            std::filesystem::remove(config.out_filename);
+        }
+    } // namespace
+
+    BENCHMARK_CAPTURE(writer_write_entry, sync, writer::Binary::Config{})->Apply(apply_entry_shapes);
+    BENCHMARK_CAPTURE(writer_write_entry, async, writer::Binary::Config{ .is_async = true })
+        ->Apply(apply_entry_shapes);
+    BENCHMARK_CAPTURE(writer_write_entry, zstd, writer::Binary::Config{ .compression = common::Compression::zstd })
+        ->Apply(apply_entry_shapes);
+} // namespace centipede::bench
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "centipede/data/entry.hpp"
+#include "centipede/data/flat_entry.hpp"
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <ranges>
+#include <string>
+#include <vector>
+
+/**
+ * @namespace centipede::bench
+ * @brief Benchmarks of centipede library.
+ */
+namespace centipede::bench
+{
+    constexpr auto RANDOM_SEED = 42U;
+    constexpr auto N_GENERATED_ENTRIES = std::size_t{ 256 }; //!< Number of distinct entries replayed in a benchmark.
+    constexpr auto MIN_DERIV = 0.5F;
+    constexpr auto MAX_DERIV = 2.F;
+
+    using EntryPoints = std::vector<EntryPoint<>>;
+
+    /**
+     * @brief Shape of the generated entries, taken from the benchmark arguments.
+     */
+    struct EntryShape
+    {
+        std::size_t n_locals = 0;            //!< Number of local parameters.
+        std::size_t n_globals_per_point = 0; //!< Number of global derivatives of each entrypoint.
+        std::size_t n_points = 0;            //!< Number of entrypoints in each entry.
+        std::size_t n_globals = 0;           //!< Total number of global parameters.
+    };
+
+    /**
+     * @brief Read the entry shape from the arguments `{n_locals, n_globals_per_point, n_points, n_globals}`.
+     */
+    inline auto get_shape(const benchmark::State& state) -> EntryShape
+    {
+        constexpr auto n_globals_arg_idx = 3;
+        return EntryShape{
+            .n_locals = static_cast<std::size_t>(state.range(0)),
+            .n_globals_per_point = static_cast<std::size_t>(state.range(1)),
+            .n_points = static_cast<std::size_t>(state.range(2)),
+            .n_globals = static_cast<std::size_t>(state.range(n_globals_arg_idx)),
+        };
+    }
+
+    /**
+     * @brief Generate entries following a linear track model.
+     *
+     * Each entrypoint has the derivatives to a random set of local parameters and a contiguous range of global
+     * parameters at a random position. The measurements are consistent with the model within the sigma, such that
+     * the local fits are accepted.
+     */
+    inline auto generate_entries(const EntryShape& shape, std::size_t n_entries = N_GENERATED_ENTRIES)
+        -> std::vector<EntryPoints>
+    {
+        auto engine = std::mt19937{ RANDOM_SEED };
+        auto deriv_gen = std::uniform_real_distribution<float>{ MIN_DERIV, MAX_DERIV };
+        auto noise_gen = std::normal_distribution<float>{};
+        auto first_global_gen = std::uniform_int_distribution<std::size_t>{
+            0, shape.n_globals > shape.n_globals_per_point ? shape.n_globals - shape.n_globals_per_point : 0
+        };
+
+        auto entries = std::vector<EntryPoints>(n_entries);
+        for (auto& entry : entries)
+        {
+            const auto local_params =
+                std::views::iota(0U, shape.n_locals) | std::views::transform([&](auto) { return deriv_gen(engine); }) |
+                std::ranges::to<std::vector<float>>();
+            entry.resize(shape.n_points);
+            for (auto& point : entry)
+            {
+                auto measurement = 0.F;
+                point.reserve_locals(shape.n_locals).reserve_globals(shape.n_globals_per_point);
+                for (const auto param : local_params)
+                {
+                    const auto deriv = deriv_gen(engine);
+                    measurement += deriv * param;
+                    point.add_local(deriv);
+                }
+                const auto first_global = first_global_gen(engine);
+                for (const auto global_idx : std::views::iota(first_global, first_global + shape.n_globals_per_point))
+                {
+                    point.add_global(global_idx, deriv_gen(engine));
+                }
+                point.set_measurement(measurement + noise_gen(engine)).set_sigma(1.F);
+            }
+        }
+        return entries;
+    }
+
+    /**
+     * @brief Convert entries to flat entries.
+     */
+    inline auto to_flat_entries(const std::vector<EntryPoints>& entries) -> std::vector<FlatEntry>
+    {
+        auto flat_entries = std::vector<FlatEntry>(entries.size());
+        for (const auto& [entry, flat_entry] : std::views::zip(entries, flat_entries))
+        {
+            for (const auto& point : entry)
+            {
+                flat_entry.add_point(point.get_measurement(), point.get_sigma());
+                for (const auto& [local_idx, local] : std::views::enumerate(point.get_locals()))
+                {
+                    flat_entry.add_local(static_cast<uint32_t>(local_idx), local);
+                }
+                for (const auto& [global_idx, global] : point.get_globals())
+                {
+                    flat_entry.add_global(global_idx, global);
+                }
+            }
+        }
+        return flat_entries;
+    }
+
+    /**
+     * @brief Size of the record of an entry in a binary file.
+     */
+    inline auto get_record_size(const EntryPoints& entry) -> std::size_t
+    {
+        auto n_pairs = std::size_t{ 1 };
+        for (const auto& point : entry)
+        {
+            n_pairs += 2 + point.get_locals().size() + point.get_globals().size();
+        }
+        return sizeof(uint32_t) + (n_pairs * (sizeof(uint32_t) + sizeof(float)));
+    }
+
+    /**
+     * @brief Report entries/s and bytes/s of a benchmark.
+     * @param state Benchmark state.
+     * @param n_bytes_per_entry Average number of record bytes of an entry.
+     * @param n_entries_per_iteration Number of entries processed in each iteration.
+     */
+    inline void set_throughput(benchmark::State& state,
+                               std::size_t n_bytes_per_entry,
+                               std::size_t n_entries_per_iteration = 1)
+    {
+        const auto n_entries = state.iterations() * static_cast<int64_t>(n_entries_per_iteration);
+        state.SetBytesProcessed(n_entries * static_cast<int64_t>(n_bytes_per_entry));
+        state.counters["entries/s"] = benchmark::Counter{ static_cast<double>(n_entries), benchmark::Counter::kIsRate };
+    }
+
+    /**
+     * @brief Average record size of entries.
+     */
+    inline auto get_mean_record_size(const std::vector<EntryPoints>& entries) -> std::size_t
+    {
+        auto total_size = std::size_t{};
+        for (const auto& entry : entries)
+        {
+            total_size += get_record_size(entry);
+        }
+        return entries.empty() ? 0 : total_size / entries.size();
+    }
+
+    /**
+     * @brief Argument names of the entry shape.
+     */
+    inline auto get_shape_arg_names() -> std::vector<std::string>
+    {
+        return { "n_locals", "n_globals_per_point", "n_points", "n_globals" };
+    }
+
+    /**
+     * @brief Entry shapes of the micro benchmarks, whose performance doesn't depend on the total number of globals.
+     */
+    inline void apply_entry_shapes(benchmark::internal::Benchmark* bench)
+    {
+        bench->ArgNames(get_shape_arg_names())->ArgsProduct({ { 2, 5, 10 }, { 2, 8 }, { 5, 20 }, { 1000 } });
+    }
+} // namespace centipede::bench
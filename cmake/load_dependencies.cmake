@@ -2,8 +2,14 @@ find_package(spdlog REQUIRED CONFIG)
 find_package(magic_enum REQUIRED CONFIG)
 find_package(CLI11 REQUIRED CONFIG)
 find_package(Eigen3 REQUIRED CONFIG)
+find_package(zstd REQUIRED CONFIG)
 find_package(GSL REQUIRED)
+find_package(Threads REQUIRED)
 
 if(ENABLE_TEST)
     find_package(GTest CONFIG REQUIRED)
 endif()
+
+if(ENABLE_BENCHMARK)
+    find_package(benchmark CONFIG REQUIRED)
+endif()
@@ -1,4 +1,5 @@
 option(ENABLE_TEST "Enable testing framework of the project." ON)
+option(ENABLE_BENCHMARK "Enable the benchmark suite of the project." OFF)
 option(BUILD_DOC "Build the documentation for this project." OFF)
 option(BUILD_DOC_ONLY "Only build the documentation for this project." OFF)
 option(ENABLE_COVERAGE "Enable coverage flags" OFF)
@@ -22,3 +23,4 @@ endif()
 
 # set the cmake variables for the communication with conan
 set(ENV{CMAKE_ENABLE_TEST} ${ENABLE_TEST})
+set(ENV{CMAKE_ENABLE_BENCHMARK} ${ENABLE_BENCHMARK})
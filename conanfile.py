@@ -15,10 +15,13 @@ class CompressorRecipe(ConanFile):
         self.requires("magic_enum/0.9.7")   # type: ignore
         self.requires("cli11/2.6.0")        # type: ignore
         self.requires("eigen/5.0.1")        # type: ignore
+        self.requires("zstd/1.5.7")         # type: ignore
 
         # Conditions on cmake variables set from cmake/project_options
         if os.environ["CMAKE_ENABLE_TEST"] == "ON":
             self.requires("gtest/1.17.0")  # type: ignore
+        if os.environ["CMAKE_ENABLE_BENCHMARK"] == "ON":
+            self.requires("benchmark/1.9.4")  # type: ignore
 
     def generate(self):
         tc = CMakeToolchain(self)
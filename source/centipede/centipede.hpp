@@ -6,6 +6,8 @@
 #include "centipede/core/engines/result.hpp"        // IWYU pragma: export
 #include "centipede/core/handler.hpp"               // IWYU pragma: export
 #include "centipede/data/entry.hpp"                 // IWYU pragma: export
+#include "centipede/data/flat_entry.hpp"            // IWYU pragma: export
+#include "centipede/util/entry_index.hpp"           // IWYU pragma: export
 #include "centipede/util/error_types.hpp"           // IWYU pragma: export
 #include "centipede/util/return_types.hpp"          // IWYU pragma: export
 #include "centipede/writer/binary.hpp"              // IWYU pragma: export
@@ -3,6 +3,7 @@
 #include "centipede/core/engines/engine_types.hpp"
 #include "centipede/core/engines/result.hpp"
 #include "centipede/data/entry.hpp"
+#include "centipede/data/flat_entry.hpp"
 #include "centipede/util/error_types.hpp"
 #include "centipede/util/return_types.hpp"
 #include <cassert>
@@ -10,6 +11,7 @@
 #include <cstdint>
 #include <expected>
 #include <gsl/gsl_cdf.h>
+#include <span>
 #include <utility>
 
 namespace centipede::core::engine
@@ -47,6 +49,19 @@ namespace centipede::core::engine
             uint64_t n_entries_local_rank_deficit = 0; //!< Total number of unused entries because of rank deficit.
             uint64_t n_entries_rejected =
                 0; //!< Total number of unused entries because of p-value below the significance level.
+
+            /**
+             * @brief Add the counts of another log, e.g. from another engine or a checkpoint.
+             */
+            auto operator+=(const Log& other) -> Log&
+            {
+                n_entries_read += other.n_entries_read;
+                n_entries_success += other.n_entries_success;
+                n_entries_low_stat += other.n_entries_low_stat;
+                n_entries_local_rank_deficit += other.n_entries_local_rank_deficit;
+                n_entries_rejected += other.n_entries_rejected;
+                return *this;
+            }
         };
 
         /**
@@ -54,8 +69,8 @@ namespace centipede::core::engine
          *
          * Before filling the entry data, all buffers in derived classes can be resized by defining the method
          * `resize_buffers()`. Values in the derived class can be set by defining following methods:
-         * - `fill_measurements(const std::vector<DataType>&)`: Fill the value of measurements.
-         * - `fill_sigmas(const std::vector<DataType>&)`: Fill the value of sigmas.
+         * - `fill_measurements(const auto&)`: Fill the value of measurements from a range.
+         * - `fill_sigmas(const auto&)`: Fill the value of sigmas from a range.
          * - `fill_local_derivs(const std::vector<Entry<DataType>::Deriv>&)`: Fill the value of the first-order local
          * derivatives.
          * - `fill_global_derivs(const std::vector<Entry<DataType>::Deriv>&)`: Fill the value of the first-order global
@@ -69,6 +84,19 @@ namespace centipede::core::engine
          */
         void fill_data(this auto&& self, const Entry<DataType>& entry);
 
+        /**
+         * @brief Fill the data of a flat entry and increment the current entry counter.
+         *
+         * This is the same as the overload for #Entry, except that the derivatives are filled by the method
+         * `fill_flat_derivs(const FlatEntry&)` in derived classes directly from the flat arrays. The number of local
+         * parameters is the fixed number given to the constructor, or FlatEntry::get_n_locals() otherwise.
+         *
+         * @param self Reference to the caller object.
+         * @param entry Flat entry data.
+         * @see #FlatEntry
+         */
+        void fill_data(this auto&& self, const FlatEntry& entry);
+
         /**
          * @brief Analyze the data from the current entry.
          *
@@ -87,6 +115,37 @@ namespace centipede::core::engine
 
         [[nodiscard]] auto get_current_state() const -> const auto& { return state_; }
         [[nodiscard]] auto get_log() const -> const auto& { return log_; }
+        [[nodiscard]] auto get_outlier_config() const -> const auto& { return outlier_config_; }
+
+        /**
+         * @brief Set the down-weighting of outliers in the local fit of the following entries.
+         *
+         * The down-weighting is done by the local fit of derived classes. The \f$\chi^2\f$ value of the entry is then
+         * calculated with the final weights, such that entries are only rejected if they still have a bad fit after
+         * the down-weighting.
+         */
+        void set_outlier_config(const OutlierConfig& config) { outlier_config_ = config; }
+
+        /**
+         * @brief Set the factor \f$f\f$ of the \f$\chi^2\f$ cut of the following entries.
+         *
+         * An entry is rejected if the p-value of \f$\chi^2 / f\f$ is not larger than the significance level, i.e. if
+         * its \f$\chi^2\f$ value is larger than \f$f\f$ times the critical value. This is used to loosen the cut in
+         * the first iterations, where the global parameters are still far from their final values. The p-value in
+         * the state is the one of the scaled value.
+         */
+        void set_chi2_cut_factor(double factor) { chi2_cut_factor_ = factor; }
+
+        /**
+         * @brief Set the current values of the global parameters, indexed by the global parameter index.
+         *
+         * The contributions of the global parameters to the measurements of the following entries are subtracted by
+         * derived classes when the global derivatives are filled, such that the global system is solved for the
+         * corrections to these values. The values are not copied and must outlive the analysis of the entries. An
+         * empty span disables the subtraction.
+         */
+        void set_global_parameters(std::span<const DataType> parameters) { global_parameters_ = parameters; }
+        [[nodiscard]] auto get_global_parameters() const -> std::span<const DataType> { return global_parameters_; }
 
         /**
          * @brief Add number of total entries and rejected entries to the result.
@@ -99,12 +158,33 @@ namespace centipede::core::engine
             result.n_entries_rejected += log_.n_entries_rejected;
         }
 
+        /**
+         * @brief Add the entry statistics to a log.
+         */
+        void add_to_log(Log& log) const { log += log_; }
+
       protected:
-        explicit Base(std::size_t n_globals) { state_.n_globals = n_globals; }
+        /**
+         * @brief Constructor.
+         *
+         * @param n_globals Number of global parameters.
+         * @param n_fixed_locals Number of local parameters of all flat entries, or 0 to take it from each flat entry.
+         * Since zero derivatives are not stored in binary files, a flat entry read from a file misses its last local
+         * parameters if their derivatives are zero in all entrypoints.
+         */
+        explicit Base(std::size_t n_globals, std::size_t n_fixed_locals = 0)
+            : n_fixed_locals_{ n_fixed_locals }
+        {
+            state_.n_globals = n_globals;
+        }
 
       private:
         State state_;
         Log log_;
+        OutlierConfig outlier_config_;
+        double chi2_cut_factor_ = 1.;
+        std::size_t n_fixed_locals_ = 0;
+        std::span<const DataType> global_parameters_;
     };
 
     template <typename DataType>
@@ -128,6 +208,26 @@ namespace centipede::core::engine
         ++self.log_.n_entries_read;
     }
 
+    template <typename DataType>
+    void Base<DataType>::fill_data(this auto&& self, const FlatEntry& entry)
+    {
+        if (entry.empty())
+        {
+            return;
+        }
+        self.state_.n_points = entry.size();
+        assert(self.n_fixed_locals_ == 0 or entry.get_n_locals() <= self.n_fixed_locals_);
+        self.state_.n_locals = (self.n_fixed_locals_ != 0) ? self.n_fixed_locals_ : entry.get_n_locals();
+
+        self.resize_buffers();
+
+        self.fill_measurements(entry.get_measurements());
+        self.fill_sigmas(entry.get_sigmas());
+        self.fill_flat_derivs(entry);
+
+        ++self.log_.n_entries_read;
+    }
+
     template <typename DataType>
     auto Base<DataType>::analyze(this auto&& self, double alpha) -> EnumError<>
     {
@@ -137,7 +237,7 @@ namespace centipede::core::engine
             .and_then(
                 [&self, alpha](const auto& ndf_chi2) -> EnumError<>
                 {
-                    const auto p_value = gsl_cdf_chisq_Q(ndf_chi2.second, ndf_chi2.first);
+                    const auto p_value = gsl_cdf_chisq_Q(ndf_chi2.second / self.chi2_cut_factor_, ndf_chi2.first);
 
                     self.state_.p_value = p_value;
                     self.state_.chi2 = ndf_chi2.second;
@@ -177,8 +277,10 @@ namespace centipede::core::engine
 
     /**
      * @brief Empty base engine class. The real implementation is defined in its specialization.
+     *
+     * @tparam NLocals Compile-time number of local parameters. internal::DYNAMIC_SIZE if it's only known at runtime.
      */
-    template <MatrixEngineType engine_type, typename DataType>
+    template <MatrixEngineType engine_type, typename DataType, std::size_t NLocals = internal::DYNAMIC_SIZE>
     class Engine
     {
     };
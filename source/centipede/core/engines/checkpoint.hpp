@@ -0,0 +1,659 @@
+#pragma once
+
+#include "centipede/core/engines/base_engine.hpp"
+#include "centipede/util/error_types.hpp"
+#include "centipede/util/label_map.hpp"
+#include "centipede/util/mapped_file.hpp"
+#include "centipede/util/return_types.hpp"
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <ios>
+#include <limits>
+#include <span>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace centipede::core::engine
+{
+    /**
+     * @brief Checkpoint of an accumulated global system.
+     *
+     * A checkpoint stores the global factor matrix and rhs vector of an engine (see Engine::Globals) together with
+     * its entry statistics (see Base::Log), such that a long accumulation can be resumed after a crash and partial
+     * systems accumulated by separate processes can be merged by summing them up (see #add_to_globals()). If the
+     * global labels are mapped by a label map, the labels of the dense parameter indices are stored as well.
+     *
+     * The file starts with a fixed-size #Header, followed by sections which are all aligned to 8 bytes: the labels
+     * (32 bit words), the rhs vector and the factor matrix. The factor matrix is stored either as a column-major dense
+     * matrix or in the compressed sparse column format of its upper triangle: the column offsets (64 bit words), the
+     * row indices (32 bit words) and the values. Since the sections have no other encoding, #open() maps the file into
+     * memory and the values are read in place without copying or parsing.
+     *
+     * For a distributed accumulation, each process analyzes a shard of the input files (see
+     * reader::MultiFile::select_shard()) and writes its partial system to a checkpoint. The partial systems are then
+     * summed up by #reduce() in a tree reduction, whose result is added to a master with Master::add_checkpoint()
+     * before solving.
+     *
+     * #### Example usage
+     *
+     * ```cpp
+     * using Checkpoint = centipede::core::engine::Checkpoint<double>;
+     * auto write_err = Checkpoint::write("system.ckpt", globals, engine.get_log());
+     *
+     * auto checkpoint = Checkpoint{};
+     * auto open_err = checkpoint.open("system.ckpt");
+     * auto add_err = checkpoint.add_to_globals(other_globals);
+     *
+     * auto reduce_err = Checkpoint::reduce(std::vector<std::string>{ "part_0.ckpt", "part_1.ckpt" }, "system.ckpt");
+     * ```
+     *
+     * @tparam DataType Floating point type of the global system.
+     */
+    template <typename DataType>
+    class Checkpoint
+    {
+      public:
+        constexpr static auto MAGIC = uint32_t{ 0x534E4543 }; //!< Bytes "CENS" in little endian.
+        constexpr static auto VERSION = uint32_t{ 1 };        //!< Version of the checkpoint layout.
+        constexpr static auto skipped_index = std::numeric_limits<uint32_t>::max(); //!< Index of dropped parameters.
+
+        using Log = Base<DataType>::Log;
+
+        /**
+         * @brief Configuration of the tree reduction of checkpoints. See #reduce().
+         */
+        struct ReduceConfig
+        {
+            std::size_t fan_in = 2;    //!< Number of checkpoints merged into one at each level of the tree.
+            std::size_t n_threads = 0; //!< Number of threads merging at the same level. 0 to use all hardware threads.
+            bool is_sparse = true;     //!< Store the merged factor matrices in the sparse format.
+        };
+
+        /**
+         * @brief Header of the checkpoint file.
+         */
+        struct Header
+        {
+            uint32_t magic = MAGIC;
+            uint32_t version = VERSION;
+            uint32_t value_size = sizeof(DataType); //!< Size of the floating point values in bytes.
+            uint32_t is_sparse = 0;                 //!< Whether the factor matrix is stored in the sparse format.
+            uint64_t n_globals = 0;                 //!< Number of global parameters.
+            uint64_t n_nonzeros = 0;                //!< Number of stored elements of the sparse factor matrix.
+            uint64_t n_labels = 0;                  //!< Number of labels. 0 if no label map is used.
+            std::array<uint64_t, 5> log_counts{};   //!< Entry counts in the order of the members of Base::Log.
+        };
+
+        /**
+         * @brief Write a global system to a checkpoint file.
+         *
+         * The checkpoint is written to the temporary file `<filename>.tmp` first, which is renamed to the checkpoint
+         * file once it's completely written. Thus, an existing checkpoint file stays valid if the writing fails or the
+         * process is terminated.
+         *
+         * @param filename Name of the checkpoint file.
+         * @param globals Global factor matrix and rhs vector. Only the upper triangle of the factor matrix is used.
+         * @param log Entry statistics.
+         * @param labels Labels of the global parameters if a label map is used. Otherwise empty.
+         * @param is_sparse Store the factor matrix in the sparse format, which only contains the non-zero elements.
+         * @return ErrorCode::writer_file_fail_to_open if the file cannot be written. The existing checkpoint file is
+         * kept in this case.
+         */
+        template <typename GlobalsType>
+        [[nodiscard]] static auto write(const std::string& filename,
+                                        const GlobalsType& globals,
+                                        const Log& log,
+                                        std::span<const uint32_t> labels = {},
+                                        bool is_sparse = is_sparse_matrix<typename GlobalsType::MatrixType>)
+            -> EnumError<>;
+
+        /**
+         * @brief Merge checkpoints into a single checkpoint by summing up their global systems and entry statistics.
+         *
+         * If the checkpoints have labels, the merged checkpoint contains the sorted union of all labels and each
+         * global system is added to the parameters of its labels. Otherwise, the merged system has the size of the
+         * largest system.
+         *
+         * @param in_filenames Names of the checkpoint files to be merged.
+         * @param out_filename Name of the merged checkpoint file.
+         * @param is_sparse Store the factor matrix in the sparse format. The merged system is also accumulated in a
+         * sparse matrix in this case.
+         * @return Any error from #open() or #write(). ErrorCode::reader_invalid_checkpoint if only some of the
+         * checkpoints have labels.
+         */
+        [[nodiscard]] static auto merge(std::span<const std::string> in_filenames,
+                                        const std::string& out_filename,
+                                        bool is_sparse = true) -> EnumError<>;
+
+        /**
+         * @brief Merge many checkpoints in a tree reduction.
+         *
+         * At each level of the tree, groups of ReduceConfig::fan_in checkpoints are merged into intermediate
+         * checkpoints (see #merge()) in parallel threads, until a single checkpoint is left. The intermediate files
+         * are named after `out_filename` and removed once they are merged.
+         *
+         * @return Any error from #merge(). ErrorCode::reader_invalid_filename if `in_filenames` is empty.
+         */
+        [[nodiscard]] static auto reduce(std::span<const std::string> in_filenames,
+                                         const std::string& out_filename,
+                                         const ReduceConfig& config = {}) -> EnumError<>;
+
+        /**
+         * @brief Map a checkpoint file into memory and validate its layout.
+         * @return ErrorCode::reader_file_fail_to_open if the file cannot be mapped.
+         * ErrorCode::reader_invalid_checkpoint if the file is corrupted or has a different floating point type.
+         */
+        [[nodiscard]] auto open(const std::string& filename) -> EnumError<>;
+
+        /**
+         * @brief Add the stored global system to a global system.
+         *
+         * The global system must have been resized to its number of global parameters. If `indices` is given, the
+         * parameter `i` of the checkpoint is added to the parameter `indices[i]` of the global system, or dropped if
+         * `indices[i]` is #skipped_index. This is used to merge checkpoints with different label maps.
+         *
+         * @return ErrorCode::reader_invalid_checkpoint if a parameter index is out of the bounds of the global system.
+         */
+        template <typename GlobalsType>
+        [[nodiscard]] auto add_to_globals(GlobalsType& globals, std::span<const uint32_t> indices = {}) const
+            -> EnumError<>;
+
+        /**
+         * @brief Add the stored entry statistics to a log.
+         */
+        void add_to_log(Log& log) const;
+
+        [[nodiscard]] auto get_header() const -> const Header& { return header_; }
+        [[nodiscard]] auto get_n_globals() const -> std::size_t { return static_cast<std::size_t>(header_.n_globals); }
+        [[nodiscard]] auto get_labels() const -> std::span<const uint32_t> { return labels_; }
+        [[nodiscard]] auto get_rhs_vector() const -> std::span<const DataType> { return rhs_vec_; }
+        [[nodiscard]] auto is_open() const -> bool { return file_.is_open(); }
+
+      private:
+        template <typename MatrixType>
+        constexpr static auto is_sparse_matrix = std::is_base_of_v<Eigen::SparseMatrixBase<MatrixType>, MatrixType>;
+
+        /**
+         * @brief Global system with the same layout as Engine::Globals, used for merging checkpoints.
+         */
+        template <typename MatrixTypeUsed>
+        struct MergedGlobals
+        {
+            using MatrixType = MatrixTypeUsed;
+            MatrixType factor_matrix{};
+            Eigen::Matrix<DataType, Eigen::Dynamic, 1> rhs_vec{};
+        };
+
+        static void remove_files(std::span<const std::string> filenames)
+        {
+            for (const auto& filename : filenames)
+            {
+                auto error = std::error_code{};
+                std::filesystem::remove(filename, error);
+            }
+        }
+
+        template <typename GlobalsType>
+        static auto merge_as(std::span<const std::string> in_filenames, const std::string& out_filename, bool is_sparse)
+            -> EnumError<>;
+
+        constexpr static auto alignment = sizeof(uint64_t); //!< Alignment of the sections in bytes.
+
+        common::MappedFile file_;
+        Header header_{};
+        std::span<const uint32_t> labels_;
+        std::span<const DataType> rhs_vec_;
+        std::span<const DataType> dense_values_;
+        std::span<const uint64_t> col_offsets_;
+        std::span<const uint32_t> row_indices_;
+        std::span<const DataType> sparse_values_;
+
+        static auto get_padded_size(std::size_t n_bytes) -> std::size_t
+        {
+            return (n_bytes + alignment - 1) / alignment * alignment;
+        }
+
+        template <typename T>
+            requires(std::is_trivially_copyable_v<T>)
+        static void write_section(std::ofstream& output_file, std::span<T> data)
+        {
+            constexpr auto padding = std::array<char, alignment>{};
+            // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
+            output_file.write(reinterpret_cast<const char*>(data.data()),
+                              static_cast<std::streamsize>(data.size_bytes()));
+            // NOLINTEND (cppcoreguidelines-pro-type-reinterpret-cast)
+            output_file.write(padding.data(),
+                              static_cast<std::streamsize>(get_padded_size(data.size_bytes()) - data.size_bytes()));
+        }
+
+        /**
+         * @brief Take the next section with `size` elements of type `T` from the mapped bytes.
+         * @return False if the mapped bytes are too short.
+         */
+        template <typename T>
+        static auto take_section(std::span<const std::byte>& data, uint64_t size, std::span<const T>& section) -> bool
+        {
+            if (size > data.size() / sizeof(T))
+            {
+                return false;
+            }
+            const auto n_bytes = static_cast<std::size_t>(size) * sizeof(T);
+            // NOLINTNEXTLINE (cppcoreguidelines-pro-type-reinterpret-cast)
+            section = std::span{ reinterpret_cast<const T*>(data.data()), static_cast<std::size_t>(size) };
+            data = data.subspan(std::min(get_padded_size(n_bytes), data.size()));
+            return true;
+        }
+
+        static auto to_log_counts(const Log& log) -> std::array<uint64_t, 5>
+        {
+            return { log.n_entries_read,
+                     log.n_entries_success,
+                     log.n_entries_low_stat,
+                     log.n_entries_local_rank_deficit,
+                     log.n_entries_rejected };
+        }
+
+        /**
+         * @brief Call `func(row, col, value)` for each stored element of the upper triangle of the factor matrix.
+         */
+        template <typename Func>
+        void for_each_element(Func&& func) const;
+    };
+
+    template <typename DataType>
+    template <typename GlobalsType>
+    auto Checkpoint<DataType>::write(const std::string& filename,
+                                     const GlobalsType& globals,
+                                     const Log& log,
+                                     std::span<const uint32_t> labels,
+                                     bool is_sparse) -> EnumError<>
+    {
+        using MatrixType = GlobalsType::MatrixType;
+        const auto n_globals = static_cast<std::size_t>(globals.rhs_vec.size());
+        const auto temp_filename = filename + ".tmp";
+        auto output_file = std::ofstream{ temp_filename, std::ios::binary | std::ios::out | std::ios::trunc };
+        if (not output_file.is_open())
+        {
+            return std::unexpected{ ErrorCode::writer_file_fail_to_open };
+        }
+
+        auto header = Header{ .is_sparse = is_sparse ? 1U : 0U,
+                              .n_globals = n_globals,
+                              .n_labels = labels.size(),
+                              .log_counts = to_log_counts(log) };
+        auto col_offsets = std::vector<uint64_t>{};
+        auto row_indices = std::vector<uint32_t>{};
+        auto values = std::vector<DataType>{};
+        if (is_sparse)
+        {
+            // Upper triangle in the compressed sparse column format.
+            col_offsets.reserve(n_globals + 1);
+            col_offsets.push_back(0);
+            for (std::size_t col = 0; col < n_globals; ++col)
+            {
+                const auto col_idx = static_cast<Eigen::Index>(col);
+                if constexpr (is_sparse_matrix<MatrixType>)
+                {
+                    for (auto iter = typename MatrixType::InnerIterator{ globals.factor_matrix, col_idx }; iter; ++iter)
+                    {
+                        if (iter.row() <= col_idx and iter.value() != DataType{})
+                        {
+                            row_indices.push_back(static_cast<uint32_t>(iter.row()));
+                            values.push_back(iter.value());
+                        }
+                    }
+                }
+                else
+                {
+                    for (Eigen::Index row = 0; row <= col_idx; ++row)
+                    {
+                        if (const auto value = globals.factor_matrix(row, col_idx); value != DataType{})
+                        {
+                            row_indices.push_back(static_cast<uint32_t>(row));
+                            values.push_back(value);
+                        }
+                    }
+                }
+                col_offsets.push_back(row_indices.size());
+            }
+            header.n_nonzeros = values.size();
+        }
+
+        write_section(output_file, std::span{ &header, 1 });
+        write_section(output_file, labels);
+        write_section(output_file, std::span{ globals.rhs_vec.data(), n_globals });
+        if (is_sparse)
+        {
+            write_section(output_file, std::span<const uint64_t>{ col_offsets });
+            write_section(output_file, std::span<const uint32_t>{ row_indices });
+            write_section(output_file, std::span<const DataType>{ values });
+        }
+        else if constexpr (is_sparse_matrix<MatrixType>)
+        {
+            using DenseMatrix = Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic>;
+            auto dense_matrix = DenseMatrix{ globals.factor_matrix.toDense() };
+            dense_matrix.template triangularView<Eigen::StrictlyLower>().setZero();
+            write_section(output_file, std::span{ dense_matrix.data(), n_globals * n_globals });
+        }
+        else
+        {
+            write_section(output_file, std::span{ globals.factor_matrix.data(), n_globals * n_globals });
+        }
+
+        output_file.close();
+        auto error = std::error_code{};
+        if (output_file.fail())
+        {
+            std::filesystem::remove(temp_filename, error);
+            return std::unexpected{ ErrorCode::writer_file_fail_to_open };
+        }
+        std::filesystem::rename(temp_filename, filename, error);
+        if (error)
+        {
+            std::filesystem::remove(temp_filename, error);
+            return std::unexpected{ ErrorCode::writer_file_fail_to_open };
+        }
+        return {};
+    }
+
+    template <typename DataType>
+    auto Checkpoint<DataType>::merge(std::span<const std::string> in_filenames,
+                                     const std::string& out_filename,
+                                     bool is_sparse) -> EnumError<>
+    {
+        if (is_sparse)
+        {
+            return merge_as<MergedGlobals<Eigen::SparseMatrix<DataType>>>(in_filenames, out_filename, is_sparse);
+        }
+        return merge_as<MergedGlobals<Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic>>>(
+            in_filenames, out_filename, is_sparse);
+    }
+
+    template <typename DataType>
+    template <typename GlobalsType>
+    auto Checkpoint<DataType>::merge_as(std::span<const std::string> in_filenames,
+                                        const std::string& out_filename,
+                                        bool is_sparse) -> EnumError<>
+    {
+        auto checkpoints = std::vector<Checkpoint>(in_filenames.size());
+        auto label_map = common::LabelMap{};
+        auto n_globals = std::size_t{};
+        auto n_checkpoints_with_labels = std::size_t{};
+        for (std::size_t idx = 0; idx < in_filenames.size(); ++idx)
+        {
+            auto& checkpoint = checkpoints[idx];
+            if (auto res = checkpoint.open(in_filenames[idx]); not res)
+            {
+                return res;
+            }
+            n_globals = std::max(n_globals, checkpoint.get_n_globals());
+            if (not checkpoint.get_labels().empty())
+            {
+                label_map.insert(checkpoint.get_labels());
+                ++n_checkpoints_with_labels;
+            }
+        }
+        const auto has_labels = (n_checkpoints_with_labels != 0);
+        if (has_labels and n_checkpoints_with_labels != checkpoints.size())
+        {
+            return std::unexpected{ ErrorCode::reader_invalid_checkpoint };
+        }
+        if (has_labels)
+        {
+            label_map.sort();
+            n_globals = label_map.size();
+        }
+
+        auto globals = GlobalsType{};
+        const auto size = static_cast<Eigen::Index>(n_globals);
+        globals.rhs_vec.setZero(size);
+        globals.factor_matrix.resize(size, size);
+        globals.factor_matrix.setZero();
+        auto log = Log{};
+        auto indices = std::vector<uint32_t>{};
+        for (const auto& checkpoint : checkpoints)
+        {
+            indices.clear();
+            for (const auto label : checkpoint.get_labels())
+            {
+                indices.push_back(label_map.find(label).value());
+            }
+            if (auto res = checkpoint.add_to_globals(globals, indices); not res)
+            {
+                return res;
+            }
+            checkpoint.add_to_log(log);
+        }
+        return write(out_filename, globals, log, has_labels ? label_map.get_labels() : std::span<const uint32_t>{},
+                     is_sparse);
+    }
+
+    template <typename DataType>
+    auto Checkpoint<DataType>::reduce(std::span<const std::string> in_filenames,
+                                      const std::string& out_filename,
+                                      const ReduceConfig& config) -> EnumError<>
+    {
+        if (in_filenames.empty())
+        {
+            return std::unexpected{ ErrorCode::reader_invalid_filename };
+        }
+        const auto fan_in = std::max(config.fan_in, std::size_t{ 2 });
+        const auto n_threads = (config.n_threads == 0)
+                                   ? std::max(std::size_t{ std::thread::hardware_concurrency() }, std::size_t{ 1 })
+                                   : config.n_threads;
+
+        auto level_filenames = std::vector<std::string>{ in_filenames.begin(), in_filenames.end() };
+        auto is_intermediate = false;
+        for (auto level = std::size_t{}; level == 0 or level_filenames.size() > 1; ++level)
+        {
+            const auto n_groups = (level_filenames.size() + fan_in - 1) / fan_in;
+            auto out_filenames = std::vector<std::string>(n_groups);
+            for (std::size_t group_idx = 0; group_idx < n_groups; ++group_idx)
+            {
+                out_filenames[group_idx] =
+                    (n_groups == 1) ? out_filename : std::format("{}.reduce_{}_{}", out_filename, level, group_idx);
+            }
+
+            auto results = std::vector<EnumError<>>(n_groups);
+            auto next_group_idx = std::atomic<std::size_t>{ 0 };
+            {
+                auto workers = std::vector<std::jthread>{};
+                for (std::size_t thread_idx = 0; thread_idx < std::min(n_threads, n_groups); ++thread_idx)
+                {
+                    workers.emplace_back(
+                        [&]()
+                        {
+                            for (auto group_idx = next_group_idx++; group_idx < n_groups; group_idx = next_group_idx++)
+                            {
+                                const auto first_idx = group_idx * fan_in;
+                                const auto group = std::span{ level_filenames }.subspan(
+                                    first_idx, std::min(fan_in, level_filenames.size() - first_idx));
+                                results[group_idx] = merge(group, out_filenames[group_idx], config.is_sparse);
+                            }
+                        });
+                }
+            }
+
+            if (is_intermediate)
+            {
+                remove_files(level_filenames);
+            }
+            const auto failed_result =
+                std::ranges::find_if(results, [](const EnumError<>& result) -> bool { return not result; });
+            if (failed_result != results.end())
+            {
+                if (n_groups > 1)
+                {
+                    remove_files(out_filenames);
+                }
+                return *failed_result;
+            }
+            level_filenames = std::move(out_filenames);
+            is_intermediate = true;
+        }
+        return {};
+    }
+
+    template <typename DataType>
+    auto Checkpoint<DataType>::open(const std::string& filename) -> EnumError<>
+    {
+        header_ = Header{};
+        if (auto res = file_.open(filename); not res)
+        {
+            return res;
+        }
+        auto data = file_.get_data();
+        if (data.size() < sizeof(Header))
+        {
+            file_.close();
+            return std::unexpected{ ErrorCode::reader_invalid_checkpoint };
+        }
+        std::memcpy(&header_, data.data(), sizeof(Header));
+        data = data.subspan(sizeof(Header));
+
+        const auto n_globals = header_.n_globals;
+        const auto is_valid =
+            header_.magic == MAGIC and header_.version == VERSION and header_.value_size == sizeof(DataType) and
+            n_globals < std::numeric_limits<uint32_t>::max() and take_section(data, header_.n_labels, labels_) and
+            (labels_.empty() or labels_.size() == n_globals) and take_section(data, n_globals, rhs_vec_) and
+            ((header_.is_sparse == 0U)
+                 ? take_section(data, n_globals * n_globals, dense_values_)
+                 : (take_section(data, n_globals + 1, col_offsets_) and
+                    take_section(data, header_.n_nonzeros, row_indices_) and
+                    take_section(data, header_.n_nonzeros, sparse_values_) and col_offsets_.front() == 0 and
+                    col_offsets_.back() == header_.n_nonzeros and std::ranges::is_sorted(col_offsets_) and
+                    std::ranges::all_of(row_indices_, [n_globals](uint32_t row) -> bool { return row < n_globals; })));
+        if (not is_valid or not data.empty())
+        {
+            file_.close();
+            header_ = Header{};
+            return std::unexpected{ ErrorCode::reader_invalid_checkpoint };
+        }
+        return {};
+    }
+
+    template <typename DataType>
+    template <typename Func>
+    void Checkpoint<DataType>::for_each_element(Func&& func) const
+    {
+        const auto n_globals = get_n_globals();
+        for (std::size_t col = 0; col < n_globals; ++col)
+        {
+            if (header_.is_sparse == 0U)
+            {
+                for (std::size_t row = 0; row <= col; ++row)
+                {
+                    if (const auto value = dense_values_[(col * n_globals) + row]; value != DataType{})
+                    {
+                        func(row, col, value);
+                    }
+                }
+            }
+            else
+            {
+                for (auto idx = col_offsets_[col]; idx < col_offsets_[col + 1]; ++idx)
+                {
+                    func(std::size_t{ row_indices_[idx] }, col, sparse_values_[idx]);
+                }
+            }
+        }
+    }
+
+    template <typename DataType>
+    template <typename GlobalsType>
+    auto Checkpoint<DataType>::add_to_globals(GlobalsType& globals, std::span<const uint32_t> indices) const
+        -> EnumError<>
+    {
+        using MatrixType = GlobalsType::MatrixType;
+        const auto n_globals = get_n_globals();
+        const auto target_size = static_cast<std::size_t>(globals.rhs_vec.size());
+        const auto has_indices = not indices.empty();
+        if ((has_indices and indices.size() != n_globals) or
+            (not has_indices and n_globals > target_size) or
+            std::ranges::any_of(indices,
+                                [target_size](uint32_t index) -> bool
+                                { return index != skipped_index and index >= target_size; }))
+        {
+            return std::unexpected{ ErrorCode::reader_invalid_checkpoint };
+        }
+        const auto get_index = [&indices, has_indices](std::size_t idx) -> std::size_t
+        { return has_indices ? std::size_t{ indices[idx] } : idx; };
+
+        if constexpr (not is_sparse_matrix<MatrixType>)
+        {
+            if (not has_indices and header_.is_sparse == 0U)
+            {
+                // Fast path: both are dense matrices with the same parameter order.
+                using ConstMap = Eigen::Map<const Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic>>;
+                using ConstVecMap = Eigen::Map<const Eigen::Matrix<DataType, Eigen::Dynamic, 1>>;
+                const auto size = static_cast<Eigen::Index>(n_globals);
+                globals.factor_matrix.topLeftCorner(size, size) += ConstMap{ dense_values_.data(), size, size };
+                globals.rhs_vec.head(size) += ConstVecMap{ rhs_vec_.data(), size };
+                return {};
+            }
+        }
+
+        for (std::size_t idx = 0; idx < n_globals; ++idx)
+        {
+            if (const auto index = get_index(idx); index != skipped_index)
+            {
+                globals.rhs_vec(static_cast<Eigen::Index>(index)) += rhs_vec_[idx];
+            }
+        }
+
+        auto triplets = std::vector<Eigen::Triplet<DataType>>{};
+        for_each_element(
+            [&](std::size_t row, std::size_t col, DataType value)
+            {
+                const auto row_index = get_index(row);
+                const auto col_index = get_index(col);
+                if (row_index == skipped_index or col_index == skipped_index)
+                {
+                    return;
+                }
+                // Only the upper triangle is filled, also if the mapping swaps the parameter order.
+                const auto upper_row = static_cast<Eigen::Index>(std::min(row_index, col_index));
+                const auto upper_col = static_cast<Eigen::Index>(std::max(row_index, col_index));
+                if constexpr (is_sparse_matrix<MatrixType>)
+                {
+                    triplets.emplace_back(upper_row, upper_col, value);
+                }
+                else
+                {
+                    globals.factor_matrix(upper_row, upper_col) += value;
+                }
+            });
+        if constexpr (is_sparse_matrix<MatrixType>)
+        {
+            auto matrix = MatrixType(globals.factor_matrix.rows(), globals.factor_matrix.cols());
+            matrix.setFromTriplets(triplets.begin(), triplets.end());
+            globals.factor_matrix += matrix;
+        }
+        return {};
+    }
+
+    template <typename DataType>
+    void Checkpoint<DataType>::add_to_log(Log& log) const
+    {
+        const auto& counts = header_.log_counts;
+        log += Log{ .n_entries_read = counts[0],
+                    .n_entries_success = counts[1],
+                    .n_entries_low_stat = counts[2],
+                    .n_entries_local_rank_deficit = counts[3],
+                    .n_entries_rejected = counts[4] };
+    }
+} // namespace centipede::core::engine
@@ -1,22 +1,33 @@
 #pragma once
 
 #include "centipede/core/engines/base_engine.hpp"
+#include "centipede/core/engines/eigen_preconditioner.hpp"
 #include "centipede/core/engines/engine_types.hpp"
 #include "centipede/core/engines/result.hpp"
 #include "centipede/data/entry.hpp"
+#include "centipede/data/flat_entry.hpp"
+#include "centipede/util/arena.hpp"
 #include "centipede/util/error_types.hpp"
 #include "centipede/util/return_types.hpp"
 #include <Eigen/Cholesky>
 #include <Eigen/Core>
-#include <Eigen/Eigenvalues>
+#include <Eigen/IterativeLinearSolvers>
+#include <Eigen/LU>
 #include <Eigen/Sparse>
 #include <Eigen/SparseCore>
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <expected>
+#include <iterator>
 #include <limits>
+#include <new>
 #include <ranges>
+#include <span>
+#include <type_traits>
+#include <unsupported/Eigen/IterativeSolvers>
 #include <utility>
 #include <vector>
 
@@ -24,24 +35,60 @@ namespace centipede::core::engine
 {
     /**
      * @brief Engine template specialization for Eigen library implementation.
+     *
+     * The global factor matrix is stored either as a dense matrix (MatrixEngineType::eigen) or as a sparse matrix
+     * (MatrixEngineType::eigen_sparse). In the sparse mode, only the upper triangle of the symmetric factor matrix is
+     * stored and the updates from each entry are buffered as triplets, which are merged into the matrix once the buffer
+     * grows larger than the matrix itself. Therefore, the memory consumption only grows with the number of non-zero
+     * elements. The global system is then solved with a sparse LDLT decomposition. In the dense mode, the updates are
+     * also only added to the upper triangle, whose self-adjoint view is decomposed with a Cholesky decomposition.
+     *
+     * Alternatively, the global system can be solved iteratively with the conjugate gradient or MINRES method (see
+     * #SolverConfig), which only requires matrix-vector products and is preferred for very large numbers of global
+     * parameters. Linear equality constraints on the global parameters are added to the global system as a border of
+     * Lagrange multipliers (see #solve(const Globals&, std::span<const Constraint<DataType>>, Result<DataType>&,
+     * const SolverConfig&)).
+     *
+     * If the number of local parameters is known at compile time (`NLocals`), all matrices of the local fit have
+     * fixed numbers of rows and the Cholesky decomposition of the local system is done with fixed-size matrices,
+     * which are kept in registers and whose loops are fully unrolled by the compiler. All entries must then have
+     * exactly `NLocals` local parameters.
+     *
+     * Outliers in the local fit can be down-weighted with an M-estimator (see Base::set_outlier_config()). The
+     * re-weighting iterations update the Cholesky factor of the local matrix with rank-one updates of the changed
+     * weights instead of decomposing it again.
+     *
+     * All scratch memory of the current entry is taken from an arena owned by the engine, which is reset when the next
+     * entry is filled. Once the arena is large enough, filling and analyzing an entry doesn't allocate any memory,
+     * which is checked by Eigen in debug builds (see `EIGEN_RUNTIME_NO_MALLOC`). The only exception is merging the
+     * buffered triplets of the sparse factor matrix. Eigen's check doesn't cover the arena itself, whose heap
+     * allocations are counted instead (see common::Arena::get_n_overflows()).
      */
-    template <typename DataType>
-    class Engine<MatrixEngineType::eigen, DataType> : public Base<DataType>
+    template <MatrixEngineType engine_type, typename DataType, std::size_t NLocals>
+        requires(engine_type == MatrixEngineType::eigen or engine_type == MatrixEngineType::eigen_sparse)
+    class Engine<engine_type, DataType, NLocals> : public Base<DataType>
     {
       public:
+        constexpr static auto is_sparse = (engine_type == MatrixEngineType::eigen_sparse); //!< Sparse storage or not.
+        constexpr static auto has_fixed_n_locals = (NLocals != internal::DYNAMIC_SIZE); //!< Fixed-size local fit.
+
         /**
          * @brief Matrix and vector used to solve global parameter updates
+         *
+         * Only the upper triangle of the symmetric factor matrix is filled. The strictly lower triangle is zero and
+         * never accessed by the solvers.
          */
         struct Globals
         {
-            // TODO:  matrix is symmetric. Thus it's more efficient to represent it with a special memory layout.
-            using MatrixType = Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic>;
+            using MatrixType = std::conditional_t<is_sparse,
+                                                  Eigen::SparseMatrix<DataType>,
+                                                  Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic>>;
             MatrixType factor_matrix{};
             Eigen::Matrix<DataType, Eigen::Dynamic, 1> rhs_vec{};
         };
 
         explicit Engine(std::size_t n_globals)
-            : Base<DataType>(n_globals)
+            : Base<DataType>(n_globals, has_fixed_n_locals ? NLocals : 0)
         {
             resize_globals(globals_, n_globals);
         }
@@ -49,15 +96,76 @@ namespace centipede::core::engine
         [[nodiscard]] auto get_local_solutions() const -> const auto& { return buffers_.local_solutions; };
         [[nodiscard]] auto get_global_factor_matrix() const -> const auto& { return globals_.factor_matrix; };
         [[nodiscard]] auto get_global_rhs_vector() const -> const auto& { return globals_.rhs_vec; };
+        [[nodiscard]] auto get_arena() const -> const auto& { return arena_; };
 
         /**
-         * @brief solve the updates of global parameters.
+         * @brief Fill the data of an entry. See Base::fill_data().
+         *
+         * The scratch memory of the previous entry is released.
+         */
+        template <typename EntryType>
+        void fill_data(const EntryType& entry)
+        {
+            const auto permission = MallocPermission{ false };
+            this->Base<DataType>::fill_data(entry);
+        }
+
+        /**
+         * @brief Analyze the current entry. See Base::analyze().
+         */
+        auto analyze(double alpha) -> EnumError<>
+        {
+            const auto permission = MallocPermission{ false };
+            auto res = this->Base<DataType>::analyze(alpha);
+            flush_pending_update();
+            return res;
+        }
+
+        /**
+         * @brief Fill and analyze a batch of flat entries.
+         *
+         * The entries are analyzed in an order which groups the entries with the same number of local parameters and
+         * the same global labels. The global updates of consecutive entries with identical global parameters are
+         * summed up in a dense block, which is only added to the global system once per group. Errors of individual
+         * entries are recorded in the log (see Base::get_log()). Empty entries are skipped.
+         *
+         * @param entries Flat entries to be analyzed.
+         * @param alpha Significance level to reject an entry.
+         * @return Number of entries used for updating the global system.
          */
-        static void solve(const Globals& globals, Result<DataType>& result)
+        auto analyze(std::span<const FlatEntry> entries, double alpha) -> std::size_t
         {
-            assert(globals.factor_matrix.isApprox(globals.factor_matrix.transpose()));
+            const auto permission = MallocPermission{ false };
+            order_batch(entries);
+            auto n_entries_success = std::size_t{};
+            for (const auto& [key, entry_idx] : batch_order_)
+            {
+                this->Base<DataType>::fill_data(entries[entry_idx]);
+                if (this->Base<DataType>::analyze(alpha).has_value())
+                {
+                    ++n_entries_success;
+                }
+            }
+            flush_pending_update();
+            return n_entries_success;
+        }
 
-            if (globals.factor_matrix.isZero())
+        /**
+         * @brief solve the updates of global parameters.
+         *
+         * If SolverConfig::compute_errors is set, the direct solver also fills the errors of the parameters, i.e. the
+         * square roots of the diagonal of the inverse factor matrix. The dense engine inverts the Cholesky factor and
+         * the sparse engine computes the diagonal by a selected inversion of the sparse LDLT factor (see
+         * #sparse_inverse_diagonal()), without inverting the factor matrix.
+         *
+         * @param globals Global factor matrix and rhs vector.
+         * @param result Result where the parameter updates are filled to.
+         * @param solver_config Configuration of the solver.
+         */
+        static void solve(const Globals& globals, Result<DataType>& result, const SolverConfig& solver_config = {})
+        {
+            result.errors.clear();
+            if (is_zero_matrix(globals.factor_matrix))
             {
                 result.error_status = ErrorCode::analysis_factor_matrix_zero;
                 return;
@@ -68,106 +176,251 @@ namespace centipede::core::engine
                 return;
             }
 
-            auto cholesky_decomp = globals.factor_matrix.llt();
+            if (solver_config.type != SolverType::direct)
+            {
+                solve_iterative(globals, result, solver_config);
+            }
+            else if constexpr (is_sparse)
+            {
+                solve_sparse(globals, result, solver_config.compute_errors);
+            }
+            else
+            {
+                solve_dense(globals, result, solver_config.compute_errors);
+            }
+        }
 
-            if (cholesky_decomp.info() == Eigen::ComputationInfo::Success)
+        /**
+         * @brief Solve the updates of global parameters with linear equality constraints.
+         *
+         * The constraints \f$A\,x = c\f$ are added with Lagrange multipliers \f$\lambda\f$ as a border of the global
+         * system:
+         * \f[
+         *     \begin{pmatrix} C & A^T \\ A & 0 \end{pmatrix} \begin{pmatrix} x \\ \lambda \end{pmatrix} =
+         *     \begin{pmatrix} b \\ c \end{pmatrix}
+         * \f]
+         * The border only consists of the non-zero coefficients of the constraints, such that a sparse factor matrix
+         * stays sparse. The bordered system is regular if the constraints fix the weak modes of the factor matrix.
+         * Since it's indefinite, the direct solver uses a LU decomposition and the iterative solvers use MINRES,
+         * where the incomplete Cholesky preconditioner is replaced by the diagonal one. If the bordered system is
+         * singular, #centipede::ErrorCode::analysis_rank_deficit is set.
+         *
+         * @param globals Global factor matrix and rhs vector.
+         * @param constraints Constraints whose terms have global parameter indices. Without constraints, the
+         * unconstrained system is solved.
+         * @param result Result where the parameter updates are filled to. The Lagrange multipliers are not included.
+         * The errors of the parameters are only computed without constraints.
+         * @param solver_config Configuration of the solver.
+         */
+        static void solve(const Globals& globals,
+                          std::span<const Constraint<DataType>> constraints,
+                          Result<DataType>& result,
+                          const SolverConfig& solver_config = {})
+        {
+            if (constraints.empty())
             {
-                // NOTE: memory allocation here
-                auto global_par_solution = cholesky_decomp.solve(globals.rhs_vec).eval();
-                result.parameters.clear();
-                std::ranges::copy(
-                    std::views::zip_transform([](auto idx, const DataType& val) -> Result<DataType>::IdxValuePair
-                                              { return typename Result<DataType>::IdxValuePair{ idx, val }; },
-                                              std::views::iota(std::size_t{}),
-                                              global_par_solution),
-                    std::back_inserter(result.parameters));
-                result.error_status = ErrorCode::success;
+                solve(globals, result, solver_config);
+                return;
+            }
+            result.errors.clear();
+            if (is_zero_matrix(globals.factor_matrix))
+            {
+                result.error_status = ErrorCode::analysis_factor_matrix_zero;
+                return;
+            }
+
+            const auto bordered_globals = make_bordered_globals(globals, constraints);
+            if (bordered_globals.rhs_vec.isZero())
+            {
+                result.error_status = ErrorCode::analysis_rhs_vector_zero;
+                return;
+            }
+            if (solver_config.type != SolverType::direct)
+            {
+                auto bordered_config = solver_config;
+                bordered_config.type = SolverType::minres;
+                if (bordered_config.preconditioner == PreconditionerType::incomplete_cholesky)
+                {
+                    bordered_config.preconditioner = PreconditionerType::diagonal;
+                }
+                solve_iterative(bordered_globals, result, bordered_config);
             }
             else
             {
-                check_rank_deficit(globals, result);
+                solve_bordered_direct(bordered_globals, result);
+            }
+            if (result.error_status == ErrorCode::success)
+            {
+                result.parameters.resize(static_cast<std::size_t>(globals.rhs_vec.size()));
             }
         }
 
+        /**
+         * @brief Add the global factor matrix and rhs vector of this engine to the globals.
+         *
+         * Empty globals are resized to the number of global parameters beforehand. This is used to sum up the
+         * results from multiple engines.
+         * @param globals Globals where the values are added to.
+         */
         void add_to_globals(Globals& globals)
         {
-            globals.factor_matrix += globals_.factor_matrix.eval();
-            globals.rhs_vec += globals_.rhs_vec.eval();
+            if (globals.rhs_vec.size() == 0)
+            {
+                resize_globals(globals, Base<DataType>::get_current_state().n_globals);
+            }
+            flush_pending_update();
+            if constexpr (is_sparse)
+            {
+                flush_global_triplets();
+                globals.factor_matrix += globals_.factor_matrix;
+            }
+            else
+            {
+                globals.factor_matrix.template triangularView<Eigen::Upper>() += globals_.factor_matrix;
+            }
+            globals.rhs_vec += globals_.rhs_vec;
+        }
+
+        /**
+         * @brief Keep only the first `n_globals` global parameters, e.g. the parameters used by a label map.
+         */
+        static void shrink_globals(Globals& globals, std::size_t n_globals)
+        {
+            const auto size = static_cast<Eigen::Index>(n_globals);
+            assert(size <= globals.rhs_vec.size());
+            globals.factor_matrix.conservativeResize(size, size);
+            globals.rhs_vec.conservativeResize(size);
         }
 
       private:
-        constexpr static auto max_n_local = 20;
-        using LocalRectangleMatrix =
-            Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, max_n_local>;
+        constexpr static auto max_n_local = has_fixed_n_locals ? static_cast<int>(NLocals) : 20;
+        constexpr static auto n_local_rows = has_fixed_n_locals ? static_cast<int>(NLocals) : Eigen::Dynamic;
+        constexpr static auto initial_n_local_rows = has_fixed_n_locals ? static_cast<Eigen::Index>(NLocals) : 0;
+        using LocalRectangleMatrix = Eigen::Map<Eigen::Matrix<DataType, n_local_rows, Eigen::Dynamic>>;
         using LocalSquareMatrix =
-            Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, max_n_local, max_n_local>;
-        using LocalSquareVec = Eigen::Matrix<DataType, Eigen::Dynamic, 1, Eigen::ColMajor, max_n_local>;
+            Eigen::Matrix<DataType, n_local_rows, n_local_rows, Eigen::ColMajor, max_n_local, max_n_local>;
+        using LocalSquareVec = Eigen::Matrix<DataType, n_local_rows, 1, Eigen::ColMajor, max_n_local>;
+        using DenseBlock = Eigen::Map<Eigen::Matrix<DataType, Eigen::Dynamic, Eigen::Dynamic>>;
+        using DenseBlockVec = Eigen::Map<Eigen::Matrix<DataType, Eigen::Dynamic, 1>>;
+
+        constexpr static auto min_n_global_triplets = std::size_t{ 1U << 16U };
+        //! Thresholds of the M-estimators with 95% efficiency for normally distributed residuals.
+        constexpr static auto default_huber_threshold = static_cast<DataType>(1.345);
+        constexpr static auto default_cauchy_threshold = static_cast<DataType>(2.3849);
 
-        std::vector<Eigen::Triplet<DataType>> triplets_;
-        LocalRectangleMatrix local_t_{}; //!< Transpose of the local derivs matrix. The row size is n_locals and
-                                         //!< the column size is the number of entrypoints.
-        Eigen::SparseMatrix<DataType> global_t_{}; //!< Transpose of the global derivs matrix. The row size is number of
-                                                   //!< global parameters and column size is the number of entrypoints.
-        Eigen::Matrix<DataType, Eigen::Dynamic, 1> sigmas_{};       //!< Sigma values
-        Eigen::Matrix<DataType, Eigen::Dynamic, 1> measurements_{}; //!< Sigma values
+        /**
+         * @brief Scoped permission of memory allocations by Eigen. The previous permission is restored on exit.
+         */
+        class MallocPermission
+        {
+          public:
+            explicit MallocPermission(bool is_allowed)
+                : previous_{ Eigen::internal::is_malloc_allowed() }
+            {
+                Eigen::internal::set_is_malloc_allowed(is_allowed);
+            }
+            ~MallocPermission() { Eigen::internal::set_is_malloc_allowed(previous_); }
+            MallocPermission(const MallocPermission&) = delete;
+            MallocPermission(MallocPermission&&) = delete;
+            auto operator=(const MallocPermission&) -> MallocPermission& = delete;
+            auto operator=(MallocPermission&&) -> MallocPermission& = delete;
+
+          private:
+            bool previous_ = true;
+        };
+
+        common::Arena arena_;                                   //!< Scratch memory of the current entry.
+        std::vector<Eigen::Triplet<DataType>> triplets_;        //!< Global derivatives as (label, point, value).
+        std::vector<Eigen::Triplet<DataType>> global_triplets_; //!< Pending updates of the sparse factor matrix.
+        LocalRectangleMatrix local_t_{ nullptr, initial_n_local_rows, 0 }; //!< Transpose of the local derivs matrix.
+                                                                           //!< The row size is n_locals and the
+                                                                           //!< column size is the number of points.
+        DenseBlockVec sigmas_{ nullptr, 0 };       //!< Weights, i.e. inverse squared sigma values.
+        DenseBlockVec measurements_{ nullptr, 0 }; //!< Measurement values.
 
         Globals globals_;
 
+        std::vector<std::pair<uint64_t, std::size_t>> batch_order_; //!< Grouping keys and indices of a batch.
+        std::vector<Eigen::Index> pending_labels_;                  //!< Global parameters of the pending update.
+        std::vector<DataType> pending_factor_update_;               //!< Pending update of the factor matrix.
+        std::vector<DataType> pending_rhs_vector_update_;           //!< Pending update of the rhs vector.
+
         struct
         {
-            LocalRectangleMatrix local_weighted_t{};
+            LocalRectangleMatrix local_weighted_t{ nullptr, initial_n_local_rows, 0 };
             LocalSquareMatrix local_weighted_square{};
             LocalSquareMatrix local_weighted_square_inv{};
             LocalSquareVec local_weighted_meas{};
             Eigen::LLT<LocalSquareMatrix> cholesky_solver{ max_n_local };
-            Eigen::Matrix<DataType, Eigen::Dynamic, 1> residual_values{};
-            Eigen::Matrix<DataType, Eigen::Dynamic, 1> local_solutions{}; // Local solutions
-            Eigen::SparseMatrix<DataType> local_weighted_square_inv_sparse{};
-            Eigen::SparseMatrix<DataType> global_local_weighted_t{};
-            Eigen::SparseMatrix<DataType> global_weighted_square{};
-            Eigen::SparseMatrix<DataType> global_square_update{};
-            Eigen::SparseMatrix<DataType> global_rhs_vector_update{};
-            Eigen::SparseMatrix<DataType> sigmas_sparse_view{};
+            LocalSquareMatrix cholesky_factor{}; // Lower Cholesky factor updated by the outlier down-weighting.
+            LocalSquareVec cholesky_update_vec{}; // Vector of the rank-one update of the Cholesky factor.
+            DenseBlockVec residual_values{ nullptr, 0 };
+            LocalSquareVec local_solutions{}; // Local solutions
+            Eigen::SparseMatrix<DataType> global_triplets_matrix{};
+
+            // Dense blocks of the global update, restricted to the global parameters of the entry.
+            std::span<Eigen::Index> touched_labels{};                 //!< Sorted global parameters of the entry.
+            DenseBlock global_derivs{ nullptr, 0, 0 };                //!< Global derivatives (n_points x n_touched).
+            DenseBlock weighted_global_derivs{ nullptr, 0, 0 };       //!< Weighted global derivatives.
+            DenseBlock local_global_weighted{ nullptr, 0, 0 };        //!< Local-global block (n_locals x n_touched).
+            DenseBlock local_global_weighted_solved{ nullptr, 0, 0 }; //!< Inverse local matrix times previous block.
         } buffers_;
 
         friend Base<DataType>;
 
         void resize_buffers()
         {
-
             const auto& current_state = Base<DataType>::get_current_state();
-            const auto entrypoint_size = current_state.n_points;
-            const auto n_globals = current_state.n_globals;
-            const auto n_locals = current_state.n_locals;
+            const auto entrypoint_size = static_cast<Eigen::Index>(current_state.n_points);
+            const auto n_locals = static_cast<Eigen::Index>(current_state.n_locals);
+            assert(not has_fixed_n_locals or current_state.n_locals == NLocals);
+            assert(n_locals <= max_n_local);
 
-            // NOTE: resize may cause memory allocation.
-            local_t_.resize(n_locals, entrypoint_size);
+            arena_.reset();
+            allocate_block(local_t_, n_locals, entrypoint_size);
             local_t_.setZero();
-            buffers_.local_weighted_t.resize(n_locals, entrypoint_size);
+            allocate_block(buffers_.local_weighted_t, n_locals, entrypoint_size);
+            allocate_block(buffers_.residual_values, entrypoint_size, 1);
+            allocate_block(sigmas_, entrypoint_size, 1);
+            allocate_block(measurements_, entrypoint_size, 1);
+
+            // NOTE: The local square matrices have bounded sizes and don't allocate memory.
             buffers_.local_weighted_square.resize(n_locals, n_locals);
             buffers_.local_weighted_meas.resize(n_locals);
-            buffers_.residual_values.resize(entrypoint_size);
             buffers_.local_weighted_square_inv.resize(n_locals, n_locals);
             buffers_.local_solutions.resize(n_locals);
-            sigmas_.resize(entrypoint_size);
-            measurements_.resize(entrypoint_size);
+            buffers_.cholesky_factor.resize(n_locals, n_locals);
+            buffers_.cholesky_update_vec.resize(n_locals);
+        }
 
-            // NOTE: resize initializes the sparse matrix to zero values
-            global_t_.resize(n_globals, entrypoint_size);
-            buffers_.global_local_weighted_t.resize(n_locals, n_globals);
-            buffers_.global_weighted_square.resize(n_globals, n_globals);
-            buffers_.global_square_update.resize(n_globals, n_globals);
-            buffers_.local_weighted_square_inv_sparse.resize(n_locals, n_locals);
-            buffers_.sigmas_sparse_view.resize(entrypoint_size, entrypoint_size);
+        /**
+         * @brief Let a block map onto a new array from the arena.
+         */
+        template <typename BlockType>
+        void allocate_block(BlockType& block, Eigen::Index rows, Eigen::Index cols)
+        {
+            auto storage = arena_.allocate<DataType>(static_cast<std::size_t>(rows * cols));
+            // NOTE: Placement new is the way to change the array of an Eigen::Map (see Eigen documentation).
+            new (&block) BlockType{ storage.data(), rows, cols };
         }
 
-        void fill_sigmas(const std::vector<DataType>& data)
+        void fill_sigmas(const std::ranges::input_range auto& data)
         {
-            std::ranges::copy(std::views::transform(data, [](DataType val) -> DataType { return 1. / (val * val); }),
+            std::ranges::copy(std::views::transform(data,
+                                                    [](auto val) -> DataType
+                                                    {
+                                                        const auto sigma = static_cast<DataType>(val);
+                                                        return DataType{ 1 } / (sigma * sigma);
+                                                    }),
                               sigmas_.begin());
         }
 
-        void fill_measurements(const std::vector<DataType>& data) { std::ranges::copy(data, measurements_.begin()); }
+        void fill_measurements(const std::ranges::input_range auto& data)
+        {
+            std::ranges::copy(std::views::transform(data,
+                                                    [](auto val) -> DataType { return static_cast<DataType>(val); }),
+                              measurements_.begin());
+        }
 
         void fill_local_derivs(const std::vector<typename Entry<DataType>::Deriv>& data)
         {
@@ -185,40 +438,233 @@ namespace centipede::core::engine
 
             for (const auto& [point_idx, deriv] : data)
             {
-                assert(point_idx < global_t_.cols());
-                assert(deriv.first < global_t_.rows());
+                assert(point_idx < Base<DataType>::get_current_state().n_points);
+                assert(deriv.first < Base<DataType>::get_current_state().n_globals);
                 triplets_.emplace_back(deriv.first, point_idx, deriv.second);
             }
-            global_t_.setFromSortedTriplets(triplets_.begin(), triplets_.end());
+            subtract_global_parameters();
+        }
+
+        void fill_flat_derivs(const FlatEntry& entry)
+        {
+            const auto local_offsets = entry.get_local_offsets();
+            const auto local_labels = entry.get_local_labels();
+            const auto local_values = entry.get_local_values();
+            const auto global_offsets = entry.get_global_offsets();
+            const auto global_labels = entry.get_global_labels();
+            const auto global_values = entry.get_global_values();
+
+            triplets_.clear();
+            for (auto point_idx = std::size_t{}; point_idx < entry.size(); ++point_idx)
+            {
+                for (auto idx = local_offsets[point_idx]; idx < local_offsets[point_idx + 1]; ++idx)
+                {
+                    assert(local_labels[idx] < local_t_.rows());
+                    local_t_(local_labels[idx], static_cast<Eigen::Index>(point_idx)) =
+                        static_cast<DataType>(local_values[idx]);
+                }
+
+                for (auto idx = global_offsets[point_idx]; idx < global_offsets[point_idx + 1]; ++idx)
+                {
+                    assert(global_labels[idx] < Base<DataType>::get_current_state().n_globals);
+                    triplets_.emplace_back(global_labels[idx], point_idx, static_cast<DataType>(global_values[idx]));
+                }
+            }
+            subtract_global_parameters();
+        }
+
+        /**
+         * @brief Subtract the contributions of the current global parameters from the measurements.
+         *
+         * See Base::set_global_parameters().
+         */
+        void subtract_global_parameters()
+        {
+            const auto parameters = Base<DataType>::get_global_parameters();
+            if (parameters.empty())
+            {
+                return;
+            }
+            for (const auto& triplet : triplets_)
+            {
+                assert(static_cast<std::size_t>(triplet.row()) < parameters.size());
+                measurements_(triplet.col()) -= triplet.value() * parameters[static_cast<std::size_t>(triplet.row())];
+            }
         }
 
         auto fit_local_pars() -> EnumError<>
         {
-            // NOTE: Multiplications will trigger temporary object (memory allocation later during the assignment.)
-            Eigen::internal::set_is_malloc_allowed(false);
+            // NOTE: Only lazy products are used, since the other products may allocate temporary objects.
             buffers_.local_weighted_t.noalias() = local_t_ * sigmas_.asDiagonal();
 
             buffers_.local_weighted_square.noalias() = buffers_.local_weighted_t.lazyProduct(local_t_.transpose());
-            // TODO: What if the inversion fails?
             buffers_.cholesky_solver.compute(buffers_.local_weighted_square);
-            buffers_.local_weighted_square_inv.setIdentity();
-            buffers_.cholesky_solver.solveInPlace(buffers_.local_weighted_square_inv);
             if (buffers_.cholesky_solver.info() != Eigen::ComputationInfo::Success)
             {
                 return std::unexpected{ ErrorCode::analysis_local_fit_rank_deficit };
             }
+            buffers_.local_weighted_meas.noalias() = buffers_.local_weighted_t.lazyProduct(measurements_);
+            buffers_.local_solutions = buffers_.local_weighted_meas;
+            buffers_.cholesky_solver.solveInPlace(buffers_.local_solutions);
 
-            buffers_.local_solutions.noalias() =
-                buffers_.local_weighted_square_inv.lazyProduct(buffers_.local_weighted_t).lazyProduct(measurements_);
+            if (const auto& outlier_config = Base<DataType>::get_outlier_config();
+                outlier_config.type != OutlierWeightType::none)
+            {
+                return down_weight_outliers(outlier_config);
+            }
+            buffers_.local_weighted_square_inv.setIdentity();
+            buffers_.cholesky_solver.solveInPlace(buffers_.local_weighted_square_inv);
+            return {};
+        }
 
-            Eigen::internal::set_is_malloc_allowed(true);
+        /**
+         * @brief Down-weight the outliers of the local fit with an M-estimator and fit the local parameters again.
+         *
+         * In each iteration, the original weight \f$w_i\f$ of each point is scaled by the M-estimator weight of its
+         * normalized residual \f$z_i = r_i \sqrt{w_i}\f$ from the previous fit. A weight change \f$\Delta w_i\f$
+         * changes the local matrix by the rank-one term \f$\Delta w_i a_i a_i^T\f$ with the local derivatives
+         * \f$a_i\f$ of the point, which is applied to the existing Cholesky factor by a rank update in \f$O(n^2)\f$
+         * instead of a new decomposition in \f$O(n^3)\f$ (see #update_cholesky_factor()). The local matrix is only
+         * decomposed again if a downdate fails numerically. The iterations stop early once no weight changes anymore.
+         *
+         * The weights of the points are overwritten with the final weights, which are then used in the
+         * \f$\chi^2\f$ value and the update of the global system.
+         */
+        auto down_weight_outliers(const OutlierConfig& config) -> EnumError<>
+        {
+            const auto n_points = static_cast<Eigen::Index>(Base<DataType>::get_current_state().n_points);
+            auto original_weights = DenseBlockVec{ nullptr, 0 };
+            allocate_block(original_weights, n_points, 1);
+            original_weights = sigmas_;
+            const auto threshold = get_outlier_threshold(config);
+            auto& cholesky_factor = buffers_.cholesky_factor;
+            cholesky_factor = buffers_.cholesky_solver.matrixLLT();
 
+            for (auto iteration = std::size_t{}; iteration < config.n_iterations; ++iteration)
+            {
+                buffers_.residual_values.noalias() =
+                    measurements_ - local_t_.transpose().lazyProduct(buffers_.local_solutions);
+                auto is_changed = false;
+                auto is_factor_valid = true;
+                for (auto point_idx = Eigen::Index{}; point_idx < n_points; ++point_idx)
+                {
+                    const auto normalized_residual =
+                        std::abs(buffers_.residual_values(point_idx)) * std::sqrt(original_weights(point_idx));
+                    const auto weight = original_weights(point_idx) *
+                                        get_outlier_weight(config.type, normalized_residual / threshold);
+                    const auto weight_change = weight - sigmas_(point_idx);
+                    if (weight_change == DataType{})
+                    {
+                        continue;
+                    }
+                    is_changed = true;
+                    sigmas_(point_idx) = weight;
+                    if (is_factor_valid)
+                    {
+                        buffers_.cholesky_update_vec = local_t_.col(point_idx);
+                        is_factor_valid =
+                            update_cholesky_factor(cholesky_factor, buffers_.cholesky_update_vec, weight_change);
+                    }
+                }
+                if (not is_changed)
+                {
+                    break;
+                }
+
+                buffers_.local_weighted_t.noalias() = local_t_ * sigmas_.asDiagonal();
+                if (not is_factor_valid)
+                {
+                    buffers_.local_weighted_square.noalias() =
+                        buffers_.local_weighted_t.lazyProduct(local_t_.transpose());
+                    buffers_.cholesky_solver.compute(buffers_.local_weighted_square);
+                    if (buffers_.cholesky_solver.info() != Eigen::ComputationInfo::Success)
+                    {
+                        return std::unexpected{ ErrorCode::analysis_local_fit_rank_deficit };
+                    }
+                    cholesky_factor = buffers_.cholesky_solver.matrixLLT();
+                }
+                buffers_.local_weighted_meas.noalias() = buffers_.local_weighted_t.lazyProduct(measurements_);
+                buffers_.local_solutions = buffers_.local_weighted_meas;
+                cholesky_factor.template triangularView<Eigen::Lower>().solveInPlace(buffers_.local_solutions);
+                cholesky_factor.template triangularView<Eigen::Lower>().transpose().solveInPlace(
+                    buffers_.local_solutions);
+            }
+
+            buffers_.local_weighted_square_inv.setIdentity();
+            cholesky_factor.template triangularView<Eigen::Lower>().solveInPlace(buffers_.local_weighted_square_inv);
+            cholesky_factor.template triangularView<Eigen::Lower>().transpose().solveInPlace(
+                buffers_.local_weighted_square_inv);
             return {};
         }
 
+        /**
+         * @brief Rank-one update \f$L L^T + \sigma v v^T\f$ of a lower Cholesky factor \f$L\f$ in place.
+         *
+         * Same algorithm as `Eigen::LLT::rankUpdate()` for negative \f$\sigma\f$, which works for both signs, but
+         * without allocating a temporary vector. The vector is overwritten.
+         * @return False if the updated matrix is not positive definite. The factor is then invalid.
+         */
+        static auto update_cholesky_factor(LocalSquareMatrix& factor, LocalSquareVec& vec, DataType sigma) -> bool
+        {
+            const auto size = factor.cols();
+            auto beta = DataType{ 1 };
+            for (auto col = Eigen::Index{}; col < size; ++col)
+            {
+                const auto diag = factor(col, col);
+                const auto diag_square = diag * diag;
+                const auto vec_val = vec(col);
+                const auto sigma_vec_square = sigma * vec_val * vec_val;
+                const auto gamma = (diag_square * beta) + sigma_vec_square;
+                const auto new_diag_square = diag_square + (sigma_vec_square / beta);
+                if (new_diag_square <= DataType{})
+                {
+                    return false;
+                }
+                const auto new_diag = std::sqrt(new_diag_square);
+                factor(col, col) = new_diag;
+                beta += sigma_vec_square / diag_square;
+
+                const auto n_below = size - col - 1;
+                if (n_below > 0)
+                {
+                    vec.tail(n_below) -= (vec_val / diag) * factor.col(col).tail(n_below);
+                    if (gamma != DataType{})
+                    {
+                        factor.col(col).tail(n_below) *= new_diag / diag;
+                        factor.col(col).tail(n_below) += (new_diag * sigma * vec_val / gamma) * vec.tail(n_below);
+                    }
+                }
+            }
+            return true;
+        }
+
+        static auto get_outlier_threshold(const OutlierConfig& config) -> DataType
+        {
+            if (config.threshold > 0.)
+            {
+                return static_cast<DataType>(config.threshold);
+            }
+            return (config.type == OutlierWeightType::cauchy) ? default_cauchy_threshold : default_huber_threshold;
+        }
+
+        /**
+         * @brief M-estimator weight of a normalized residual in units of the threshold.
+         */
+        static auto get_outlier_weight(OutlierWeightType type, DataType scaled_residual) -> DataType
+        {
+            switch (type)
+            {
+                case OutlierWeightType::huber:
+                    return (scaled_residual <= DataType{ 1 }) ? DataType{ 1 } : DataType{ 1 } / scaled_residual;
+                case OutlierWeightType::cauchy:
+                    return DataType{ 1 } / (DataType{ 1 } + (scaled_residual * scaled_residual));
+                default:
+                    return DataType{ 1 };
+            }
+        }
+
         auto calculate_local_fit_chi_square() -> EnumError<std::pair<std::size_t, double>>
         {
-            Eigen::internal::set_is_malloc_allowed(false);
             const auto entrypoint_size = Base<DataType>::get_current_state().n_points;
             const auto local_size = buffers_.local_solutions.rows();
             const auto ndf = entrypoint_size - local_size;
@@ -228,50 +674,210 @@ namespace centipede::core::engine
                 return std::unexpected{ ErrorCode::analysis_local_fit_low_stat };
             }
 
-            buffers_.residual_values.noalias() = measurements_ - (local_t_.transpose() * buffers_.local_solutions);
+            buffers_.residual_values.noalias() =
+                measurements_ - local_t_.transpose().lazyProduct(buffers_.local_solutions);
             const auto chi_square = buffers_.residual_values.dot(sigmas_.asDiagonal() * buffers_.residual_values);
-            Eigen::internal::set_is_malloc_allowed(true);
             return std::pair{ ndf, chi_square };
         }
 
+        /**
+         * @brief Update the global factor matrix with the entry.
+         *
+         * With the local derivatives \f$A\f$, the global derivatives \f$G\f$, the weights \f$W\f$ and the local
+         * matrix \f$C = A^T W A\f$, the update is \f$G^T W G - B^T C^{-1} B\f$ with \f$B = A^T W G\f$. Only the
+         * columns of \f$G\f$ belonging to the global parameters of the entry are non-zero. Thus, these columns are
+         * gathered into dense blocks, the update is calculated with dense products and the upper triangle of the
+         * result is scattered to the factor matrix.
+         */
         auto update_global_factor_matrix() -> EnumError<>
         {
-            // TODO: Perform the production using index accessing.
-            // NOTE: Seems that there is no way to prevent memory allocation with sparse matrices.
-            // Eigen::internal::set_is_malloc_allowed(false);
-            buffers_.sigmas_sparse_view = sigmas_.asDiagonal();
-            buffers_.global_local_weighted_t = local_t_.sparseView();
-            buffers_.global_local_weighted_t =
-                buffers_.global_local_weighted_t * buffers_.sigmas_sparse_view * global_t_.transpose();
-            buffers_.global_weighted_square = global_t_ * buffers_.sigmas_sparse_view * global_t_.transpose();
-            buffers_.local_weighted_square_inv_sparse = buffers_.local_weighted_square_inv.sparseView().eval();
-
-            buffers_.global_square_update = buffers_.global_local_weighted_t;
-            buffers_.global_square_update = buffers_.global_square_update.transpose() *
-                                            buffers_.local_weighted_square_inv_sparse *
-                                            buffers_.global_local_weighted_t;
-            buffers_.global_square_update += buffers_.global_weighted_square;
-            assert(buffers_.global_square_update.isApprox(buffers_.global_square_update.transpose()));
-            globals_.factor_matrix += buffers_.global_square_update;
-            // Eigen::internal::set_is_malloc_allowed(true);
+            gather_global_derivs();
+            const auto n_points = static_cast<Eigen::Index>(Base<DataType>::get_current_state().n_points);
+            const auto n_locals = static_cast<Eigen::Index>(Base<DataType>::get_current_state().n_locals);
+            const auto n_touched = static_cast<Eigen::Index>(buffers_.touched_labels.size());
+
+            const auto& global_derivs = buffers_.global_derivs;
+            auto& weighted_global_derivs = buffers_.weighted_global_derivs;
+            auto& local_global_weighted = buffers_.local_global_weighted;
+            auto& local_global_weighted_solved = buffers_.local_global_weighted_solved;
+            allocate_block(weighted_global_derivs, n_points, n_touched);
+            allocate_block(local_global_weighted, n_locals, n_touched);
+            allocate_block(local_global_weighted_solved, n_locals, n_touched);
+            auto global_square_update = DenseBlock{ nullptr, 0, 0 };
+            allocate_block(global_square_update, n_touched, n_touched);
+
+            weighted_global_derivs.noalias() = sigmas_.asDiagonal() * global_derivs;
+            local_global_weighted.noalias() = local_t_.lazyProduct(weighted_global_derivs);
+            local_global_weighted_solved.noalias() =
+                buffers_.local_weighted_square_inv.lazyProduct(local_global_weighted);
+            global_square_update.setZero();
+            global_square_update.template triangularView<Eigen::Upper>() +=
+                global_derivs.transpose().lazyProduct(weighted_global_derivs);
+            global_square_update.template triangularView<Eigen::Upper>() -=
+                local_global_weighted.transpose().lazyProduct(local_global_weighted_solved);
+
+            if (not std::ranges::equal(pending_labels_, buffers_.touched_labels))
+            {
+                flush_pending_update();
+                start_pending_update();
+            }
+            get_pending_factor_update().template triangularView<Eigen::Upper>() += global_square_update;
             return {};
         }
 
+        /**
+         * @brief Update the global rhs vector with the entry.
+         *
+         * The update is \f$(W G)^T y - B^T x\f$ with the measurements \f$y\f$ and the local solutions \f$x\f$.
+         * It reuses the dense blocks from #update_global_factor_matrix().
+         */
         auto update_global_rhs_vector() -> EnumError<>
         {
-            // TODO: Perform the production using index accessing.
-            // NOTE: Seems that there is no way to prevent memory allocation with sparse matrices.
-            buffers_.global_rhs_vector_update = (sigmas_.asDiagonal() * measurements_).sparseView();
-            buffers_.global_rhs_vector_update = global_t_ * buffers_.global_rhs_vector_update;
-            globals_.rhs_vec += buffers_.global_rhs_vector_update;
-            buffers_.global_rhs_vector_update = buffers_.local_solutions.sparseView();
-            buffers_.global_rhs_vector_update =
-                buffers_.global_local_weighted_t.transpose() * buffers_.global_rhs_vector_update;
-            globals_.rhs_vec -= buffers_.global_rhs_vector_update;
+            const auto n_touched = static_cast<Eigen::Index>(buffers_.touched_labels.size());
+            auto global_rhs_vector_update = DenseBlockVec{ nullptr, 0 };
+            allocate_block(global_rhs_vector_update, n_touched, 1);
+
+            global_rhs_vector_update.noalias() = buffers_.weighted_global_derivs.transpose().lazyProduct(measurements_);
+            global_rhs_vector_update.noalias() -=
+                buffers_.local_global_weighted.transpose().lazyProduct(buffers_.local_solutions);
 
+            get_pending_rhs_vector_update() += global_rhs_vector_update;
             return {};
         }
 
+        auto get_pending_factor_update() -> DenseBlock
+        {
+            const auto n_labels = static_cast<Eigen::Index>(pending_labels_.size());
+            return DenseBlock{ pending_factor_update_.data(), n_labels, n_labels };
+        }
+
+        auto get_pending_rhs_vector_update() -> DenseBlockVec
+        {
+            const auto n_labels = static_cast<Eigen::Index>(pending_labels_.size());
+            return DenseBlockVec{ pending_rhs_vector_update_.data(), n_labels };
+        }
+
+        /**
+         * @brief Start a pending update with the global parameters of the current entry.
+         */
+        void start_pending_update()
+        {
+            pending_labels_.assign(buffers_.touched_labels.begin(), buffers_.touched_labels.end());
+            const auto n_labels = pending_labels_.size();
+            pending_factor_update_.resize(std::max(pending_factor_update_.size(), n_labels * n_labels));
+            pending_rhs_vector_update_.resize(std::max(pending_rhs_vector_update_.size(), n_labels));
+            get_pending_factor_update().setZero();
+            get_pending_rhs_vector_update().setZero();
+        }
+
+        /**
+         * @brief Scatter the pending update to the global factor matrix and rhs vector.
+         *
+         * Only the upper triangle of the pending factor update is used.
+         */
+        void flush_pending_update()
+        {
+            if (pending_labels_.empty())
+            {
+                return;
+            }
+            const auto factor_update = get_pending_factor_update();
+            const auto rhs_vector_update = get_pending_rhs_vector_update();
+            for (auto col = Eigen::Index{}; col < factor_update.cols(); ++col)
+            {
+                const auto global_col = pending_labels_[static_cast<std::size_t>(col)];
+                for (auto row = Eigen::Index{}; row <= col; ++row)
+                {
+                    const auto global_row = pending_labels_[static_cast<std::size_t>(row)];
+                    if constexpr (is_sparse)
+                    {
+                        global_triplets_.emplace_back(global_row, global_col, factor_update(row, col));
+                    }
+                    else
+                    {
+                        globals_.factor_matrix(global_row, global_col) += factor_update(row, col);
+                    }
+                }
+                globals_.rhs_vec(global_col) += rhs_vector_update(col);
+            }
+            pending_labels_.clear();
+            if constexpr (is_sparse)
+            {
+                if (global_triplets_.size() >
+                    std::max(min_n_global_triplets, static_cast<std::size_t>(globals_.factor_matrix.nonZeros())))
+                {
+                    flush_global_triplets();
+                }
+            }
+        }
+
+        /**
+         * @brief Order the entries of a batch, such that entries with the same number of local parameters and the
+         * same global labels are next to each other.
+         */
+        void order_batch(std::span<const FlatEntry> entries)
+        {
+            batch_order_.clear();
+            for (const auto& [entry_idx, entry] : std::views::enumerate(entries))
+            {
+                if (not entry.empty())
+                {
+                    batch_order_.emplace_back(get_batch_key(entry), static_cast<std::size_t>(entry_idx));
+                }
+            }
+            std::ranges::sort(batch_order_);
+        }
+
+        /**
+         * @brief FNV-1a hash of the number of local parameters and the global labels of an entry.
+         */
+        static auto get_batch_key(const FlatEntry& entry) -> uint64_t
+        {
+            constexpr auto fnv_offset = uint64_t{ 14695981039346656037U };
+            constexpr auto fnv_prime = uint64_t{ 1099511628211U };
+            auto key = fnv_offset;
+            const auto add_to_key = [&key](uint64_t value)
+            {
+                key ^= value;
+                key *= fnv_prime;
+            };
+            add_to_key(entry.get_n_locals());
+            for (const auto label : entry.get_global_labels())
+            {
+                add_to_key(label);
+            }
+            return key;
+        }
+
+        /**
+         * @brief Gather the global derivatives of the entry into a dense block.
+         *
+         * The columns of the block are the global parameters of the entry in ascending order.
+         */
+        void gather_global_derivs()
+        {
+            auto touched_labels = arena_.allocate<Eigen::Index>(triplets_.size());
+            std::ranges::transform(triplets_,
+                                   touched_labels.begin(),
+                                   [](const auto& triplet) -> Eigen::Index { return triplet.row(); });
+            std::ranges::sort(touched_labels);
+            const auto n_touched = static_cast<std::size_t>(
+                std::distance(touched_labels.begin(), std::ranges::unique(touched_labels).begin()));
+            buffers_.touched_labels = touched_labels.first(n_touched);
+
+            auto& global_derivs = buffers_.global_derivs;
+            allocate_block(global_derivs,
+                           static_cast<Eigen::Index>(Base<DataType>::get_current_state().n_points),
+                           static_cast<Eigen::Index>(n_touched));
+            global_derivs.setZero();
+            for (const auto& triplet : triplets_)
+            {
+                const auto touched_iter = std::ranges::lower_bound(buffers_.touched_labels, triplet.row());
+                global_derivs(triplet.col(), std::distance(buffers_.touched_labels.begin(), touched_iter)) +=
+                    triplet.value();
+            }
+        }
+
         static void resize_globals(Globals& globals, std::size_t n_globals)
         {
             globals.rhs_vec.resize(n_globals);
@@ -280,57 +886,518 @@ namespace centipede::core::engine
             globals.factor_matrix.setZero();
         }
 
-        static auto find_redundant_parameter_idx(const auto& eigen_solver, Result<DataType>& result)
+        void flush_global_triplets()
         {
-            result.redundant_parameter_indices.clear();
-            const auto& unitary_matrix = eigen_solver.eigenvectors();
-            const auto& eigen_values = eigen_solver.eigenvalues();
-            const auto n_globals = eigen_values.rows();
-            auto prob_mat = Eigen::MatrixX<DataType>::Zero(n_globals, n_globals).eval();
+            if (global_triplets_.empty())
+            {
+                return;
+            }
+            const auto permission = MallocPermission{ true };
+            const auto n_globals = globals_.factor_matrix.rows();
+            buffers_.global_triplets_matrix.resize(n_globals, n_globals);
+            buffers_.global_triplets_matrix.setFromTriplets(global_triplets_.begin(), global_triplets_.end());
+            globals_.factor_matrix += buffers_.global_triplets_matrix;
+            global_triplets_.clear();
+        }
 
-            for (const auto [idx, val] : std::views::zip(std::views::iota(0), eigen_values))
+        static auto is_zero_matrix(const typename Globals::MatrixType& matrix) -> bool
+        {
+            if constexpr (is_sparse)
             {
-                if (std::abs(val) < Eigen::NumTraits<DataType>::dummy_precision())
+                for (auto col = Eigen::Index{}; col < matrix.outerSize(); ++col)
                 {
-                    prob_mat(idx, idx) = 1;
+                    for (auto iter = typename Globals::MatrixType::InnerIterator{ matrix, col }; iter; ++iter)
+                    {
+                        if (iter.value() != DataType{})
+                        {
+                            return false;
+                        }
+                    }
                 }
+                return true;
+            }
+            else
+            {
+                return matrix.isZero();
             }
-            const auto diagonal_values = (unitary_matrix * prob_mat * unitary_matrix.transpose()).diagonal().eval();
-            for (const auto [idx, diagonal_val] : std::views::zip(std::views::iota(0), diagonal_values))
+        }
+
+        static void fill_parameters(const Eigen::Matrix<DataType, Eigen::Dynamic, 1>& solution,
+                                    Result<DataType>& result)
+        {
+            result.parameters.clear();
+            std::ranges::copy(
+                std::views::zip_transform([](auto idx, const DataType& val) -> Result<DataType>::IdxValuePair
+                                          { return typename Result<DataType>::IdxValuePair{ idx, val }; },
+                                          std::views::iota(std::size_t{}),
+                                          solution),
+                std::back_inserter(result.parameters));
+            result.error_status = ErrorCode::success;
+        }
+
+        static void fill_errors(const Eigen::Matrix<DataType, Eigen::Dynamic, 1>& inverse_diagonal,
+                                Result<DataType>& result)
+        {
+            result.errors.clear();
+            std::ranges::copy(
+                std::views::zip_transform([](auto idx, const DataType& val) -> Result<DataType>::IdxValuePair
+                                          { return typename Result<DataType>::IdxValuePair{ idx, std::sqrt(val) }; },
+                                          std::views::iota(std::size_t{}),
+                                          inverse_diagonal),
+                std::back_inserter(result.errors));
+        }
+
+        /**
+         * @brief Solve the dense global system with a Cholesky decomposition \f$C = L L^T\f$.
+         *
+         * The diagonal elements of the inverse factor matrix are the squared norms of the columns of \f$L^{-1}\f$.
+         */
+        static void solve_dense(const Globals& globals, Result<DataType>& result, bool compute_errors)
+        {
+            auto cholesky_decomp = globals.factor_matrix.template selfadjointView<Eigen::Upper>().llt();
+
+            if (cholesky_decomp.info() == Eigen::ComputationInfo::Success)
             {
-                if (std::abs(diagonal_val) > Eigen::NumTraits<DataType>::dummy_precision())
+                // NOTE: memory allocation here
+                fill_parameters(cholesky_decomp.solve(globals.rhs_vec).eval(), result);
+                if (compute_errors)
                 {
-                    result.redundant_parameter_indices.push_back(idx);
+                    auto inverse_lower = typename Globals::MatrixType{ Globals::MatrixType::Identity(
+                        globals.factor_matrix.rows(), globals.factor_matrix.cols()) };
+                    cholesky_decomp.matrixL().solveInPlace(inverse_lower);
+                    fill_errors(inverse_lower.colwise().squaredNorm().transpose(), result);
                 }
             }
+            else
+            {
+                check_rank_deficit(globals, result, compute_errors);
+            }
         }
 
-        static void check_rank_deficit(const Globals& globals, Result<DataType>& result)
+        /**
+         * @brief Solve the sparse global system with a sparse LDLT decomposition.
+         *
+         * The pivots of the decomposition are used to check whether the factor matrix is positive definite. Parameters
+         * with vanishing pivots are reported as possible redundant parameters.
+         */
+        static void solve_sparse(const Globals& globals, Result<DataType>& result, bool compute_errors)
         {
-            result.eigen_values.clear();
-            auto eigen_solver = Eigen::SelfAdjointEigenSolver<typename Globals::MatrixType>{ globals.factor_matrix };
-            const auto& eigen_values = eigen_solver.eigenvalues();
-            std::ranges::copy(eigen_solver.eigenvalues(), std::back_inserter(result.eigen_values));
+            using LDLTSolver = Eigen::SimplicialLDLT<typename Globals::MatrixType, Eigen::Upper>;
+            auto ldlt_decomp = LDLTSolver{ globals.factor_matrix };
+            result.pivots.clear();
+            result.redundant_parameter_indices.clear();
             result.rank_deficit = 0;
-            for (const auto [idx, val] : std::views::zip(std::views::iota(0), eigen_values))
+            if (ldlt_decomp.info() != Eigen::ComputationInfo::Success)
+            {
+                result.error_status = ErrorCode::analysis_rank_deficit;
+                return;
+            }
+
+            const auto& pivots = ldlt_decomp.vectorD();
+            const auto& pivot_to_par_idx = ldlt_decomp.permutationPinv().indices();
+            const auto threshold = std::numeric_limits<DataType>::epsilon() * pivots.cwiseAbs().maxCoeff() *
+                                   static_cast<DataType>(pivots.size());
+            for (const auto [pivot_idx, pivot] : std::views::zip(std::views::iota(Eigen::Index{}), pivots))
             {
-                if (val + std::numeric_limits<DataType>::epsilon() < 0)
+                if (pivot < -threshold)
                 {
                     result.error_status = ErrorCode::analysis_global_negative_definite;
+                    std::ranges::copy(pivots, std::back_inserter(result.pivots));
                     return;
                 }
-                if (std::abs(val) < std::numeric_limits<DataType>::epsilon())
+                if (pivot <= threshold)
                 {
                     ++result.rank_deficit;
+                    result.redundant_parameter_indices.push_back(
+                        static_cast<std::size_t>(pivot_to_par_idx(pivot_idx)));
                 }
             }
-
             if (result.rank_deficit != 0)
+            {
+                std::ranges::copy(pivots, std::back_inserter(result.pivots));
+                std::ranges::sort(result.redundant_parameter_indices);
+                result.error_status = ErrorCode::analysis_rank_deficit;
+                return;
+            }
+            fill_parameters(ldlt_decomp.solve(globals.rhs_vec).eval(), result);
+            if (compute_errors)
+            {
+                fill_errors(ldlt_decomp.permutationPinv() * sparse_inverse_diagonal(ldlt_decomp), result);
+            }
+        }
+
+        /**
+         * @brief Diagonal of the inverse of a decomposed sparse factor matrix by the Takahashi recurrence.
+         *
+         * The inverse \f$Z = (L D L^T)^{-1}\f$ of the permuted factor matrix fulfills
+         * \f$Z = D^{-1} L^{-1} + (I - L^T) Z\f$. Going backwards through the columns, the entries of \f$Z\f$ on the
+         * sparsity pattern of \f$L\f$ only depend on entries of the later columns on the same pattern:
+         * \f[
+         *     Z_{ij} = -\sum_{k>j} L_{kj} Z_{ik}, \quad Z_{jj} = D_j^{-1} - \sum_{k>j} L_{kj} Z_{kj}.
+         * \f]
+         * This selected inversion costs about as much as the decomposition and no entry outside of the pattern is
+         * computed.
+         * @param ldlt_decomp Decomposition whose factor \f$L\f$ stores the rows of each column in ascending order.
+         * @return Diagonal of \f$Z\f$ in the order of the decomposition.
+         */
+        static auto sparse_inverse_diagonal(const auto& ldlt_decomp) -> Eigen::Matrix<DataType, Eigen::Dynamic, 1>
+        {
+            const auto& lower_matrix = ldlt_decomp.matrixL().nestedExpression();
+            const auto& pivots = ldlt_decomp.vectorD();
+            const auto* outer_indices = lower_matrix.outerIndexPtr();
+            const auto* inner_indices = lower_matrix.innerIndexPtr();
+            const auto* lower_values = lower_matrix.valuePtr();
+            // Entries of Z on the pattern of L, in the same order as the values of L.
+            auto inverse_values = std::vector<DataType>(static_cast<std::size_t>(lower_matrix.nonZeros()));
+            auto inverse_diagonal = Eigen::Matrix<DataType, Eigen::Dynamic, 1>{ lower_matrix.cols() };
+            const auto get_inverse = [&](Eigen::Index row, Eigen::Index col) -> DataType
+            {
+                if (row == col)
+                {
+                    return inverse_diagonal(row);
+                }
+                const auto [min_idx, max_idx] = std::minmax(row, col);
+                const auto* iter = std::lower_bound(inner_indices + outer_indices[min_idx],
+                                                    inner_indices + outer_indices[min_idx + 1],
+                                                    max_idx);
+                return inverse_values[static_cast<std::size_t>(iter - inner_indices)];
+            };
+
+            for (auto col = lower_matrix.cols() - 1; col >= 0; --col)
+            {
+                const auto col_begin = outer_indices[col];
+                const auto col_end = outer_indices[col + 1];
+                auto diagonal = DataType{ 1 } / pivots(col);
+                for (auto idx = col_begin; idx < col_end; ++idx)
+                {
+                    auto value = DataType{};
+                    for (auto other_idx = col_begin; other_idx < col_end; ++other_idx)
+                    {
+                        value -= lower_values[other_idx] * get_inverse(inner_indices[idx], inner_indices[other_idx]);
+                    }
+                    inverse_values[static_cast<std::size_t>(idx)] = value;
+                    diagonal -= lower_values[idx] * value;
+                }
+                inverse_diagonal(col) = diagonal;
+            }
+            return inverse_diagonal;
+        }
+
+        /**
+         * @brief Build the global system bordered by the constraints (see #solve()).
+         *
+         * Only the upper triangle is filled, i.e. the transposed constraint matrix is in the last columns.
+         */
+        static auto make_bordered_globals(const Globals& globals, std::span<const Constraint<DataType>> constraints)
+            -> Globals
+        {
+            const auto n_globals = globals.rhs_vec.size();
+            const auto n_rows = n_globals + static_cast<Eigen::Index>(constraints.size());
+            auto bordered_globals = Globals{};
+            bordered_globals.rhs_vec.resize(n_rows);
+            bordered_globals.rhs_vec.head(n_globals) = globals.rhs_vec;
+            for (const auto& [constraint_idx, constraint] : std::views::enumerate(constraints))
+            {
+                bordered_globals.rhs_vec(n_globals + constraint_idx) = constraint.value;
+            }
+
+            if constexpr (is_sparse)
+            {
+                auto triplets = std::vector<Eigen::Triplet<DataType>>{};
+                triplets.reserve(static_cast<std::size_t>(globals.factor_matrix.nonZeros()));
+                for (auto col = Eigen::Index{}; col < globals.factor_matrix.outerSize(); ++col)
+                {
+                    for (auto iter = typename Globals::MatrixType::InnerIterator{ globals.factor_matrix, col };
+                         iter and iter.row() <= col;
+                         ++iter)
+                    {
+                        triplets.emplace_back(iter.row(), col, iter.value());
+                    }
+                }
+                for (const auto& [constraint_idx, constraint] : std::views::enumerate(constraints))
+                {
+                    for (const auto& [par_idx, coefficient] : constraint.terms)
+                    {
+                        assert(static_cast<Eigen::Index>(par_idx) < n_globals);
+                        triplets.emplace_back(par_idx, n_globals + constraint_idx, coefficient);
+                    }
+                }
+                bordered_globals.factor_matrix.resize(n_rows, n_rows);
+                bordered_globals.factor_matrix.setFromTriplets(triplets.begin(), triplets.end());
+            }
+            else
+            {
+                bordered_globals.factor_matrix.setZero(n_rows, n_rows);
+                bordered_globals.factor_matrix.topLeftCorner(n_globals, n_globals)
+                    .template triangularView<Eigen::Upper>() = globals.factor_matrix;
+                for (const auto& [constraint_idx, constraint] : std::views::enumerate(constraints))
+                {
+                    for (const auto& [par_idx, coefficient] : constraint.terms)
+                    {
+                        assert(static_cast<Eigen::Index>(par_idx) < n_globals);
+                        bordered_globals.factor_matrix(par_idx, n_globals + constraint_idx) += coefficient;
+                    }
+                }
+            }
+            return bordered_globals;
+        }
+
+        /**
+         * @brief Solve the bordered global system with a LU decomposition.
+         *
+         * A sparse system is decomposed by a sparse LU decomposition with a fill-reducing column ordering. A singular
+         * system is detected by a failed decomposition or a large residual of the solution.
+         */
+        static void solve_bordered_direct(const Globals& bordered_globals, Result<DataType>& result)
+        {
+            using MatrixType = typename Globals::MatrixType;
+            const auto full_matrix =
+                MatrixType{ bordered_globals.factor_matrix.template selfadjointView<Eigen::Upper>() };
+            auto solution = Eigen::Matrix<DataType, Eigen::Dynamic, 1>{};
+            if constexpr (is_sparse)
+            {
+                using LUSolver = Eigen::SparseLU<MatrixType, Eigen::COLAMDOrdering<typename MatrixType::StorageIndex>>;
+                auto lu_decomp = LUSolver{};
+                lu_decomp.compute(full_matrix);
+                if (lu_decomp.info() != Eigen::ComputationInfo::Success)
+                {
+                    result.error_status = ErrorCode::analysis_rank_deficit;
+                    return;
+                }
+                solution = lu_decomp.solve(bordered_globals.rhs_vec);
+            }
+            else
+            {
+                solution = full_matrix.partialPivLu().solve(bordered_globals.rhs_vec);
+            }
+
+            const auto tolerance = std::sqrt(std::numeric_limits<DataType>::epsilon()) *
+                                   static_cast<DataType>(bordered_globals.rhs_vec.norm());
+            if (not solution.allFinite() or (full_matrix * solution - bordered_globals.rhs_vec).norm() > tolerance)
             {
                 result.error_status = ErrorCode::analysis_rank_deficit;
-                find_redundant_parameter_idx(eigen_solver, result);
                 return;
             }
+            fill_parameters(solution, result);
+        }
+
+        /**
+         * @brief Solve the global system iteratively with the solver and preconditioner from the configuration.
+         *
+         * Only the upper triangle of the factor matrix is accessed.
+         */
+        static void solve_iterative(const Globals& globals, Result<DataType>& result, const SolverConfig& config)
+        {
+            if (config.type == SolverType::minres)
+            {
+                solve_iterative_with_preconditioner<Eigen::MINRES>(globals, result, config);
+            }
+            else
+            {
+                solve_iterative_with_preconditioner<Eigen::ConjugateGradient>(globals, result, config);
+            }
+        }
+
+        template <template <typename, int, typename> class SolverTemplate>
+        static void solve_iterative_with_preconditioner(const Globals& globals,
+                                                        Result<DataType>& result,
+                                                        const SolverConfig& config)
+        {
+            using MatrixType = typename Globals::MatrixType;
+            using IncompleteCholesky = std::conditional_t<is_sparse,
+                                                          Eigen::IncompleteCholesky<DataType, Eigen::Upper>,
+                                                          JacobiPreconditioner<DataType>>;
+            switch (config.preconditioner)
+            {
+                case PreconditionerType::none:
+                    solve_iterative_with<SolverTemplate<MatrixType, Eigen::Upper, Eigen::IdentityPreconditioner>>(
+                        globals, result, config);
+                    break;
+                case PreconditionerType::diagonal:
+                    solve_iterative_with<SolverTemplate<MatrixType, Eigen::Upper, JacobiPreconditioner<DataType>>>(
+                        globals, result, config);
+                    break;
+                case PreconditionerType::incomplete_cholesky:
+                    solve_iterative_with<SolverTemplate<MatrixType, Eigen::Upper, IncompleteCholesky>>(
+                        globals, result, config);
+                    break;
+            }
+        }
+
+        template <typename Solver>
+        static void solve_iterative_with(const Globals& globals, Result<DataType>& result, const SolverConfig& config)
+        {
+            auto solver = Solver{};
+            if (config.tolerance > 0.)
+            {
+                solver.setTolerance(static_cast<DataType>(config.tolerance));
+            }
+            if (config.max_iterations != 0)
+            {
+                solver.setMaxIterations(static_cast<Eigen::Index>(config.max_iterations));
+            }
+            solver.compute(globals.factor_matrix);
+            // NOTE: memory allocation here
+            auto solution = solver.solve(globals.rhs_vec).eval();
+            result.n_solver_iterations = static_cast<std::size_t>(solver.iterations());
+            result.solver_error = static_cast<double>(solver.error());
+            if (solver.info() != Eigen::ComputationInfo::Success)
+            {
+                result.error_status = ErrorCode::analysis_solver_not_converged;
+                return;
+            }
+            fill_parameters(solution, result);
+        }
+
+        /**
+         * @brief Pivoted LDLT decomposition \f$P C P^T = L D L^T\f$ of a dense symmetric matrix.
+         *
+         * In each step, the largest diagonal element of the updated Schur complement is chosen as the pivot (as in
+         * LAPACK `?pstrf`), which makes the decomposition rank-revealing for positive semi-definite matrices. The
+         * decomposition stops once the largest remaining diagonal element is not larger than the threshold
+         * \f$\epsilon \, n \max_i C_{ii}\f$. The first #rank columns of the strictly lower triangle of #matrix contain
+         * \f$L\f$ and the trailing block contains the remaining Schur complement.
+         */
+        struct PivotedLDLT
+        {
+            typename Globals::MatrixType matrix;                //!< Factor and remaining Schur complement.
+            Eigen::Matrix<DataType, Eigen::Dynamic, 1> pivots;  //!< Diagonal in the pivot order.
+            std::vector<Eigen::Index> order;                    //!< Parameter index of each pivot.
+            Eigen::Index rank = 0;                              //!< Number of pivots above the threshold.
+            DataType threshold = 0;                             //!< Threshold of vanishing pivots.
+        };
+
+        static auto decompose_pivoted_ldlt(const Globals& globals) -> PivotedLDLT
+        {
+            auto decomp = PivotedLDLT{};
+            decomp.matrix = globals.factor_matrix.template selfadjointView<Eigen::Upper>();
+            auto& matrix = decomp.matrix;
+            const auto size = matrix.rows();
+            decomp.order.resize(static_cast<std::size_t>(size));
+            std::ranges::copy(std::views::iota(Eigen::Index{}, size), decomp.order.begin());
+            decomp.threshold = std::numeric_limits<DataType>::epsilon() * static_cast<DataType>(size) *
+                               std::max(matrix.diagonal().maxCoeff(), DataType{});
+            for (auto pivot_idx = Eigen::Index{}; pivot_idx < size; ++pivot_idx)
+            {
+                auto max_idx = Eigen::Index{};
+                if (matrix.diagonal().tail(size - pivot_idx).maxCoeff(&max_idx) <= decomp.threshold)
+                {
+                    break;
+                }
+                max_idx += pivot_idx;
+                if (max_idx != pivot_idx)
+                {
+                    matrix.row(pivot_idx).swap(matrix.row(max_idx));
+                    matrix.col(pivot_idx).swap(matrix.col(max_idx));
+                    std::swap(decomp.order[static_cast<std::size_t>(pivot_idx)],
+                              decomp.order[static_cast<std::size_t>(max_idx)]);
+                }
+                const auto n_rest = size - pivot_idx - 1;
+                const auto pivot = matrix(pivot_idx, pivot_idx);
+                auto column = matrix.col(pivot_idx).tail(n_rest);
+                matrix.bottomRightCorner(n_rest, n_rest).noalias() -= (column / pivot) * column.transpose();
+                column /= pivot;
+                ++decomp.rank;
+            }
+            decomp.pivots = matrix.diagonal();
+            return decomp;
+        }
+
+        /**
+         * @brief Check the rank deficit of the dense factor matrix, whose Cholesky decomposition failed.
+         *
+         * The factor matrix is decomposed by the rank-revealing pivoted LDLT decomposition (see #PivotedLDLT). If all
+         * pivots are above the threshold, the system is solved with the decomposition. Otherwise, the remaining Schur
+         * complement of a positive semi-definite matrix is negligible. If any of its elements is larger than the
+         * threshold, the factor matrix is reported as negative definite. Otherwise, the size of the remaining block is
+         * the rank deficit and the parameters with non-zero components in the null space are reported as redundant
+         * parameters.
+         */
+        static void check_rank_deficit(const Globals& globals, Result<DataType>& result, bool compute_errors)
+        {
+            result.pivots.clear();
+            result.redundant_parameter_indices.clear();
+            result.rank_deficit = 0;
+            const auto decomp = decompose_pivoted_ldlt(globals);
+            const auto size = decomp.matrix.rows();
+            const auto lower = decomp.matrix.template triangularView<Eigen::UnitLower>();
+            if (decomp.rank == size)
+            {
+                auto solution = Eigen::Matrix<DataType, Eigen::Dynamic, 1>(size);
+                for (const auto [pivot_idx, par_idx] : std::views::enumerate(decomp.order))
+                {
+                    solution(pivot_idx) = globals.rhs_vec(par_idx);
+                }
+                lower.solveInPlace(solution);
+                solution.array() /= decomp.pivots.array();
+                lower.transpose().solveInPlace(solution);
+                fill_parameters(permute_to_parameters(solution, decomp.order), result);
+                if (compute_errors)
+                {
+                    auto inverse_lower = typename Globals::MatrixType{ Globals::MatrixType::Identity(size, size) };
+                    lower.solveInPlace(inverse_lower);
+                    fill_errors(permute_to_parameters(
+                                    inverse_lower.cwiseAbs2().transpose() * decomp.pivots.cwiseInverse(), decomp.order),
+                                result);
+                }
+                return;
+            }
+
+            std::ranges::copy(decomp.pivots, std::back_inserter(result.pivots));
+            const auto n_rest = size - decomp.rank;
+            if (decomp.matrix.bottomRightCorner(n_rest, n_rest).cwiseAbs().maxCoeff() > decomp.threshold)
+            {
+                result.error_status = ErrorCode::analysis_global_negative_definite;
+                return;
+            }
+            result.rank_deficit = static_cast<std::size_t>(n_rest);
+            result.error_status = ErrorCode::analysis_rank_deficit;
+            find_redundant_parameter_idx(decomp, result);
+        }
+
+        static auto permute_to_parameters(const Eigen::Matrix<DataType, Eigen::Dynamic, 1>& values,
+                                          std::span<const Eigen::Index> order)
+            -> Eigen::Matrix<DataType, Eigen::Dynamic, 1>
+        {
+            auto par_values = Eigen::Matrix<DataType, Eigen::Dynamic, 1>(values.size());
+            for (const auto [pivot_idx, par_idx] : std::views::enumerate(order))
+            {
+                par_values(par_idx) = values(pivot_idx);
+            }
+            return par_values;
+        }
+
+        /**
+         * @brief Find the parameters with non-zero components in the null space.
+         *
+         * With the blocks \f$L_{11}\f$ and \f$L_{21}\f$ of the first #PivotedLDLT::rank columns of \f$L\f$, the
+         * columns of \f$P^T \left[ -L_{11}^{-T} L_{21}^T ; I \right]\f$ span the null space of the factor matrix.
+         */
+        static void find_redundant_parameter_idx(const PivotedLDLT& decomp, Result<DataType>& result)
+        {
+            const auto size = decomp.matrix.rows();
+            const auto n_rest = size - decomp.rank;
+            auto null_basis = typename Globals::MatrixType{ Globals::MatrixType::Zero(size, n_rest) };
+            null_basis.bottomRows(n_rest).setIdentity();
+            null_basis.topRows(decomp.rank) = -decomp.matrix.bottomLeftCorner(n_rest, decomp.rank).transpose();
+            decomp.matrix.topLeftCorner(decomp.rank, decomp.rank)
+                .template triangularView<Eigen::UnitLower>()
+                .transpose()
+                .solveInPlace(null_basis.topRows(decomp.rank));
+            null_basis.colwise().normalize();
+
+            auto max_components = Eigen::Matrix<DataType, Eigen::Dynamic, 1>(size);
+            for (const auto [pivot_idx, par_idx] : std::views::enumerate(decomp.order))
+            {
+                max_components(par_idx) = null_basis.row(pivot_idx).cwiseAbs().maxCoeff();
+            }
+            for (const auto [idx, max_component] : std::views::zip(std::views::iota(std::size_t{}), max_components))
+            {
+                if (max_component > Eigen::NumTraits<DataType>::dummy_precision())
+                {
+                    result.redundant_parameter_indices.push_back(idx);
+                }
+            }
         }
     };
 }; // namespace centipede::core::engine
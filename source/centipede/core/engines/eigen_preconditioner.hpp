@@ -0,0 +1,86 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <type_traits>
+
+namespace centipede::core::engine
+{
+    /**
+     * @brief Jacobi preconditioner for Eigen iterative solvers.
+     *
+     * Unlike `Eigen::DiagonalPreconditioner`, which only accepts sparse matrices, this preconditioner works for both
+     * dense and sparse matrices. Zero diagonal elements are replaced by 1.
+     *
+     * @tparam DataType Floating point type of the matrix.
+     */
+    template <typename DataType>
+    class JacobiPreconditioner
+    {
+      public:
+        using Vector = Eigen::Matrix<DataType, Eigen::Dynamic, 1>;
+
+        JacobiPreconditioner() = default;
+
+        template <typename MatrixType>
+        explicit JacobiPreconditioner(const MatrixType& matrix)
+        {
+            compute(matrix);
+        }
+
+        [[nodiscard]] auto rows() const -> Eigen::Index { return inv_diagonal_.size(); }
+        [[nodiscard]] auto cols() const -> Eigen::Index { return inv_diagonal_.size(); }
+
+        template <typename MatrixType>
+        auto analyzePattern(const MatrixType& /*matrix*/) -> JacobiPreconditioner&
+        {
+            return *this;
+        }
+
+        template <typename MatrixType>
+        auto factorize(const MatrixType& matrix) -> JacobiPreconditioner&
+        {
+            if constexpr (std::is_base_of_v<Eigen::SparseMatrixBase<MatrixType>, MatrixType>)
+            {
+                inv_diagonal_.setZero(matrix.cols());
+                for (auto col = Eigen::Index{}; col < matrix.outerSize(); ++col)
+                {
+                    for (auto iter = typename MatrixType::InnerIterator{ matrix, col }; iter; ++iter)
+                    {
+                        if (iter.row() == iter.col())
+                        {
+                            inv_diagonal_(col) = iter.value();
+                        }
+                    }
+                }
+            }
+            else
+            {
+                inv_diagonal_ = matrix.diagonal();
+            }
+            inv_diagonal_ = inv_diagonal_.unaryExpr([](DataType val) -> DataType
+                                                    { return val == DataType{} ? DataType{ 1 } : 1 / val; });
+            return *this;
+        }
+
+        template <typename MatrixType>
+        auto compute(const MatrixType& matrix) -> JacobiPreconditioner&
+        {
+            return factorize(matrix);
+        }
+
+        /**
+         * @brief Apply the preconditioner to a vector.
+         */
+        template <typename Rhs>
+        [[nodiscard]] auto solve(const Eigen::MatrixBase<Rhs>& rhs) const
+        {
+            return inv_diagonal_.asDiagonal() * rhs;
+        }
+
+        [[nodiscard]] static auto info() -> Eigen::ComputationInfo { return Eigen::Success; }
+
+      private:
+        Vector inv_diagonal_{};
+    };
+} // namespace centipede::core::engine
@@ -4,9 +4,11 @@
 #include "centipede/core/engines/engine_types.hpp"
 #include "centipede/core/engines/result.hpp"
 #include "centipede/data/entry.hpp"
+#include "centipede/data/flat_entry.hpp"
 #include "centipede/util/return_types.hpp"
 #include <concepts>
 #include <cstddef>
+#include <span>
 
 namespace centipede::core::engine
 {
@@ -14,20 +16,54 @@ namespace centipede::core::engine
     /**
      * @brief Concept used for core::engine::Master option.
      */
-    template <EngineType engine_type, typename DataType>
-    concept EngineLike = requires(Engine<engine_type, DataType> engine,
+    template <EngineType engine_type, typename DataType, std::size_t NLocals = internal::DYNAMIC_SIZE>
+    concept EngineLike = requires(Engine<engine_type, DataType, NLocals> engine,
                                   Result<DataType>& result,
-                                  typename Engine<engine_type, DataType>::Globals& globals) {
-        typename Engine<engine_type, DataType>;
-        typename Engine<engine_type, DataType>::Globals;
-        { Engine<engine_type, DataType>{ std::size_t{ 0 } } };
+                                  typename Engine<engine_type, DataType, NLocals>::Globals& globals) {
+        typename Engine<engine_type, DataType, NLocals>;
+        typename Engine<engine_type, DataType, NLocals>::Globals;
+        { Engine<engine_type, DataType, NLocals>{ std::size_t{ 0 } } };
 
         // { Engine<engine_type, DataType>::resize_globals(globals, std::size_t{}) } -> std::same_as<void>;
-        { Engine<engine_type, DataType>::solve(globals, result) } -> std::same_as<void>;
+        { Engine<engine_type, DataType, NLocals>::solve(globals, result, SolverConfig{}) } -> std::same_as<void>;
         { engine.add_to_globals(globals) } -> std::same_as<void>;
         { engine.add_to_result(result) } -> std::same_as<void>;
         { engine.analyze(double{}) } -> std::same_as<EnumError<>>;
         { engine.fill_data(Entry<DataType>{}) } -> std::same_as<void>;
+        { engine.fill_data(FlatEntry{}) } -> std::same_as<void>;
     };
 
+    /**
+     * @brief Engine whose global system and entry statistics can be written to a checkpoint (see Checkpoint).
+     */
+    template <typename EngineImp>
+    concept CheckpointableEngine =
+        requires(const EngineImp& engine, typename EngineImp::Globals& globals, typename EngineImp::Log& log) {
+            globals.factor_matrix;
+            globals.rhs_vec;
+            { engine.add_to_log(log) } -> std::same_as<void>;
+        };
+
+    /**
+     * @brief Engine which solves the global system with linear equality constraints (see Constraint).
+     */
+    template <typename EngineImp, typename DataType>
+    concept ConstrainedEngine = requires(const typename EngineImp::Globals& globals,
+                                         std::span<const Constraint<DataType>> constraints,
+                                         Result<DataType>& result) {
+        { EngineImp::solve(globals, constraints, result, SolverConfig{}) } -> std::same_as<void>;
+    };
+
+    /**
+     * @brief Engine whose local fit can be configured, i.e. the down-weighting of outliers (see OutlierConfig), the
+     * factor of the \f$\chi^2\f$ cut and the current values of the global parameters (see Base).
+     */
+    template <typename EngineImp, typename DataType>
+    concept LocalFitConfigurableEngine =
+        requires(EngineImp& engine, const OutlierConfig& config, std::span<const DataType> parameters) {
+            { engine.set_outlier_config(config) } -> std::same_as<void>;
+            { engine.set_chi2_cut_factor(double{}) } -> std::same_as<void>;
+            { engine.set_global_parameters(parameters) } -> std::same_as<void>;
+        };
+
 } // namespace centipede::core::engine
@@ -1,6 +1,10 @@
 #pragma once
 
+#include "centipede/data/entry_base.hpp"
+#include <cstddef>
 #include <cstdint>
+#include <utility>
+#include <vector>
 
 namespace centipede::core::engine
 {
@@ -10,18 +14,88 @@ namespace centipede::core::engine
      */
     enum class MatrixEngineType : uint8_t
     {
-        eigen,
+        eigen,        //!< Eigen library with a dense global factor matrix.
+        eigen_sparse, //!< Eigen library with a sparse global factor matrix.
         xtensor,
         mock,
     };
 
+    /**
+     * @brief Types of the solver for the global system.
+     */
+    enum class SolverType : uint8_t
+    {
+        direct,             //!< Cholesky (dense) or LDLT (sparse) decomposition.
+        conjugate_gradient, //!< Iterative conjugate gradient method.
+        minres,             //!< Iterative minimal residual method (MINRES).
+    };
+
+    /**
+     * @brief Types of the preconditioner for the iterative solvers.
+     */
+    enum class PreconditionerType : uint8_t
+    {
+        none,                //!< No preconditioning.
+        diagonal,            //!< Inverse of the diagonal of the factor matrix (Jacobi preconditioner).
+        incomplete_cholesky, //!< Incomplete Cholesky decomposition. Only for sparse matrices, diagonal otherwise.
+    };
+
+    /**
+     * @brief Runtime configuration of the solver for the global system.
+     */
+    struct SolverConfig
+    {
+        SolverType type = SolverType::direct;                             //!< Solver type.
+        PreconditionerType preconditioner = PreconditionerType::diagonal; //!< Preconditioner of iterative solvers.
+        double tolerance = 0.; //!< Relative residual tolerance of iterative solvers. 0 to use the machine epsilon.
+        std::size_t max_iterations = 0; //!< Iteration cap of iterative solvers. 0 to use twice the matrix size.
+        bool compute_errors = false;    //!< Compute the parameter errors. Only for the direct solver.
+    };
+
+    /**
+     * @brief M-estimators to down-weight outliers in the local fit.
+     */
+    enum class OutlierWeightType : uint8_t
+    {
+        none,   //!< No down-weighting. Entries with outliers are only rejected by the p-value cut.
+        huber,  //!< Huber weights \f$\min(1, c/|z|)\f$ of the normalized residuals \f$z\f$.
+        cauchy, //!< Cauchy weights \f$1/(1 + (z/c)^2)\f$ of the normalized residuals \f$z\f$.
+    };
+
+    /**
+     * @brief Runtime configuration of the outlier down-weighting in the local fit.
+     */
+    struct OutlierConfig
+    {
+        OutlierWeightType type = OutlierWeightType::none; //!< M-estimator of the weights.
+        std::size_t n_iterations = 3;                     //!< Maximal number of re-weighting iterations.
+        double threshold = 0.; //!< Constant \f$c\f$ of the M-estimator in units of sigma. 0 to use the default value.
+    };
+
+    /**
+     * @brief Linear equality constraint \f$\sum_i a_i\,p_i = c\f$ on the global parameters \f$p_i\f$.
+     *
+     * Constraints remove the weak modes of the global system, e.g. a common shift or rotation of all parameters.
+     */
+    template <typename DataType>
+    struct Constraint
+    {
+        using Term = std::pair<uint32_t, DataType>; //!< Global label (or parameter index) and coefficient.
+        std::vector<Term> terms;                    //!< Non-zero coefficients of the constraint.
+        DataType value{};                           //!< Value \f$c\f$ of the constrained sum.
+    };
+
     /**
      * @brief Compile-time options for the master engine class
      */
     struct MasterOpt
     {
         MatrixEngineType engine_type = MatrixEngineType::eigen;
-        bool has_multi_slaves = false; //!< Use taskflow or not.
+        bool has_multi_slaves = false; //!< Analyze entries with multiple slave engines in parallel threads.
+        bool has_label_map = false;    //!< Map sparse global labels to dense parameter indices.
+
+        std::size_t n_locals = internal::DYNAMIC_SIZE; //!< Compile-time number of local parameters of all entries.
+                                                       //!< The local fit then uses fixed-size matrices.
     };
 
 } // namespace centipede::core::engine
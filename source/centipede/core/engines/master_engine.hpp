@@ -1,19 +1,31 @@
 #pragma once
 
 #include "centipede/core/engines/base_engine.hpp"
+#include "centipede/core/engines/checkpoint.hpp"
 #include "centipede/core/engines/eigen_engine.hpp" // IWYU pragma: keep
 #include "centipede/core/engines/engine_concept.hpp"
 #include "centipede/core/engines/engine_types.hpp"
 #include "centipede/core/engines/result.hpp"
+#include "centipede/core/engines/slave_pool.hpp"
 #include "centipede/data/entry.hpp"
 #include "centipede/data/entry_base.hpp"
+#include "centipede/data/flat_entry.hpp"
 #include "centipede/util/error_types.hpp"
+#include "centipede/util/label_map.hpp"
 #include "centipede/util/return_types.hpp"
 #include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <expected>
+#include <iterator>
+#include <limits>
 #include <ranges>
+#include <span>
+#include <string>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace centipede::core::engine
 {
@@ -23,9 +35,41 @@ namespace centipede::core::engine
 
     /**
      * @brief Master interface class.
+     *
+     * If MasterOpt::has_multi_slaves is true, the master owns a pool of slave engines (see #SlavePool) running in
+     * parallel threads. Each call of #analyze() then only submits the current entry to the pool and returns
+     * immediately. The global systems from all slaves are summed up in #solve() after all submitted entries are
+     * analyzed. Combined with reader::MultiFile, whose batches are submitted as single jobs, reading the input files
+     * and the fitting of the entries overlap in different threads.
+     *
+     * With Config::outlier, outliers in the local fit are down-weighted by an M-estimator instead of rejecting the
+     * whole entry by the p-value cut alone. For iterative alignments, the current values of the global parameters
+     * can be set with #set_global_parameters(), such that the entries are fitted with these values and the solution
+     * is the correction to them, and the \f$\chi^2\f$ cut can be loosened by Config::chi2_cut_factor (see
+     * IterationDriver).
+     *
+     * Linear equality constraints on the global parameters, e.g. to fix a common shift of all parameters, are added
+     * with #add_constraint(). #solve() then solves the global system bordered by the constraints (see
+     * Engine::solve()). If global parameters are set, the constraints apply to the sums of their values and the
+     * corrections.
+     *
+     * If MasterOpt::n_locals is set, the engine uses a local fit specialized for this number of local parameters and
+     * entries with a different number of local parameters are refused.
+     *
+     * If MasterOpt::has_label_map is true, the global labels of the entries are mapped to dense parameter indices by a
+     * common::LabelMap. Config::n_globals is then the maximal number of used global parameters instead of the largest
+     * label. The map either comes from a pre-pass (Config::label_map) or is filled incrementally with the labels of
+     * the analyzed entries. The parameters in the result are reported with their original labels. If
+     * Config::is_label_map_fixed is true, the derivatives of the labels not in the map are skipped instead, i.e. these
+     * parameters are fixed. This is used to exclude poorly constrained parameters found in a pre-pass (see
+     * reader::LabelStatistics).
+     *
+     * The accumulated global system can be saved with #write_checkpoint() at any time. A new master resumes the
+     * accumulation by adding the checkpoint with #add_checkpoint(), which can also be used to merge the partial
+     * systems accumulated by other processes before #solve().
      */
     template <typename DataType, MasterOpt opt = {}>
-        requires EngineLike<opt.engine_type, DataType>
+        requires EngineLike<opt.engine_type, DataType, opt.n_locals>
     class Master
     {
       public:
@@ -35,8 +79,15 @@ namespace centipede::core::engine
          */
         struct Config
         {
-            std::size_t n_globals = 0;                 //!< Number of global parameters.
+            std::size_t n_globals = 0;                 //!< Number of global parameters, or capacity of the label map.
             double alpha = significance_level_3_sigma; //!< Significance level to reject the current entry data.
+            std::size_t n_slaves = 0;                  //!< Number of slave engines. 0 to use all hardware threads.
+            std::size_t max_n_queued_entries = 0;      //!< Capacity of the entry queue for the slave engines.
+            SolverConfig solver{};                     //!< Configuration of the global system solver.
+            OutlierConfig outlier{};                   //!< Down-weighting of outliers in the local fit.
+            double chi2_cut_factor = 1.;               //!< Factor of the chi2 cut of the local fit.
+            common::LabelMap label_map{};              //!< Initial label map, e.g. from a pre-pass over the data.
+            bool is_label_map_fixed = false;           //!< Skip the derivatives of labels not in the label map.
         };
 
         /**
@@ -49,28 +100,41 @@ namespace centipede::core::engine
         };
 
         using Result = Result<DataType>;
-        using EngineImp = Engine<opt.engine_type, DataType>;
+        using EngineImp = Engine<opt.engine_type, DataType, opt.n_locals>;
+        using CheckpointType = Checkpoint<DataType>;
+        using SlavePoolType = SlavePool<EngineImp, DataType>;
+        using EngineHolder = std::conditional_t<opt.has_multi_slaves, SlavePoolType, EngineImp>;
         using DataTypeUsed = DataType;
 
         explicit Master(Config config)
-            : config_{ config }
-            , engine_imp_{ config_.n_globals }
+            : config_{ std::move(config) }
+            , label_map_{ std::move(config_.label_map) }
+            , engine_imp_{ create_engine(config_) }
         {
             result_.parameters.reserve(config_.n_globals);
+            if constexpr (not opt.has_multi_slaves and LocalFitConfigurableEngine<EngineImp, DataType>)
+            {
+                engine_imp_.set_outlier_config(config_.outlier);
+                engine_imp_.set_chi2_cut_factor(config_.chi2_cut_factor);
+            }
         }
 
         /**
          * @brief Fill the entrypoint to the current entry.
          *
-         * The global derivative values are sorted in ascending order by global parameter indicies.
+         * The global derivative values of the entrypoint are sorted in ascending order by global parameter indicies.
          * @param entry_point Current entrypoint to be filled.
          * @return An expected value. True when the filling is successful.
          * #centipede::ErrorCode::handler_incomp_n_locals if local parameter numbers are changed during the current
-         * entry.
+         * entry or differ from MasterOpt::n_locals.
+         * #centipede::ErrorCode::handler_too_many_globals if the label map is full and a global label is not in it.
          */
         template <std::size_t NLocals, std::size_t NGlobals>
         [[nodiscard]] auto add_entrypoint(const EntryPoint<NLocals, NGlobals>& entry_point) -> EnumError<>
         {
+            static_assert(NLocals == internal::DYNAMIC_SIZE or opt.n_locals == internal::DYNAMIC_SIZE or
+                              NLocals == opt.n_locals,
+                          "Number of local parameters of the entrypoint differs from MasterOpt::n_locals.");
             const auto n_locals = [&entry_point]() -> std::size_t
             {
                 if constexpr (NLocals == internal::DYNAMIC_SIZE or NGlobals == internal::DYNAMIC_SIZE)
@@ -82,12 +146,42 @@ namespace centipede::core::engine
                     return NLocals;
                 }
             }();
-            if (current_state_.entry.n_locals.has_value() and current_state_.entry.n_locals.value() != n_locals)
+            if (not is_compatible_n_locals(n_locals) or
+                (current_state_.entry.n_locals.has_value() and current_state_.entry.n_locals.value() != n_locals))
             {
                 return std::unexpected{ ErrorCode::handler_incomp_n_locals };
             }
-            current_state_.entry.n_locals = n_locals;
 
+            const auto n_old_global_derivs = static_cast<std::ptrdiff_t>(current_state_.entry.global_derivs.size());
+            std::ranges::copy(entry_point.get_globals() |
+                                  std::views::transform([this](const auto& deriv) -> Entry<DataType>::Deriv
+                                                        { return std::pair{ current_state_.point_index, deriv }; }),
+                              std::back_inserter(current_state_.entry.global_derivs));
+            auto new_global_derivs =
+                std::ranges::subrange{ std::next(current_state_.entry.global_derivs.begin(), n_old_global_derivs),
+                                       current_state_.entry.global_derivs.end() };
+            if constexpr (opt.has_label_map)
+            {
+                auto res = map_global_labels(new_global_derivs |
+                                             std::views::transform([](Entry<DataType>::Deriv& deriv) -> uint32_t&
+                                                                   { return deriv.second.first; }));
+                if (not res)
+                {
+                    current_state_.entry.global_derivs.resize(static_cast<std::size_t>(n_old_global_derivs));
+                    return res;
+                }
+                const auto skipped_derivs = std::ranges::remove(
+                    new_global_derivs, skipped_label, [](const Entry<DataType>::Deriv& deriv) -> uint32_t
+                    { return deriv.second.first; });
+                new_global_derivs = { new_global_derivs.begin(), skipped_derivs.begin() };
+                current_state_.entry.global_derivs.erase(skipped_derivs.begin(), skipped_derivs.end());
+            }
+            // Derivatives from previous entrypoints are already sorted and have smaller entrypoint IDs.
+            std::ranges::sort(new_global_derivs,
+                              std::ranges::less{},
+                              [](const Entry<DataType>::Deriv& deriv) -> uint32_t { return deriv.second.first; });
+
+            current_state_.entry.n_locals = n_locals;
             current_state_.entry.measurements.push_back(entry_point.get_measurement());
             current_state_.entry.sigmas.push_back(entry_point.get_sigma());
             std::ranges::copy(std::views::zip_transform(
@@ -96,16 +190,6 @@ namespace centipede::core::engine
                                   std::views::iota(0),
                                   entry_point.get_locals()),
                               std::back_inserter(current_state_.entry.local_derivs));
-            std::ranges::copy(entry_point.get_globals() |
-                                  std::views::transform([this](const auto& deriv) -> Entry<DataType>::Deriv
-                                                        { return std::pair{ current_state_.point_index, deriv }; }),
-                              std::back_inserter(current_state_.entry.global_derivs));
-            std::ranges::sort(current_state_.entry.global_derivs,
-                              [](const Entry<DataType>::Deriv& left, const Entry<DataType>::Deriv& right) -> bool
-                              {
-                                  return left.first < right.first ||
-                                         ((left.first == right.first) && (left.second.first < right.second.first));
-                              });
 
             ++current_state_.point_index;
             return {};
@@ -114,17 +198,159 @@ namespace centipede::core::engine
         /**
          * @brief Fitting the current entry data.
          *
-         * This operation can be async.
-         * @see ref
+         * With multiple slaves, the current entry is submitted to the slave pool and the fitting is done
+         * asynchronously. In this case, errors from the fitting are only recorded in the entry statistics of the
+         * result.
          */
         auto analyze() -> EnumError<>
         {
-            engine_imp_.fill_data(current_state_.entry);
-            auto res = engine_imp_.analyze(config_.alpha);
-            reset_state();
-            if (not res)
+            if constexpr (opt.has_multi_slaves)
+            {
+                engine_imp_.submit(std::exchange(current_state_.entry, engine_imp_.acquire_entry()));
+                reset_state();
+                return {};
+            }
+            else
+            {
+                engine_imp_.fill_data(current_state_.entry);
+                auto res = engine_imp_.analyze(config_.alpha);
+                reset_state();
+                if (not res)
+                {
+                    return std::unexpected{ res.error() };
+                }
+                return {};
+            }
+        }
+
+        /**
+         * @brief Fitting the data of a flat entry.
+         *
+         * The flat entry is filled directly to the engine, bypassing #add_entrypoint(). This is the fastest way to
+         * replay entries read from a binary file (see reader::Binary::read_one_flat_entry()). With multiple slaves,
+         * the entry is copied to a recycled entry of the slave pool, such that the input entry can be reused
+         * immediately. Empty entries are ignored.
+         *
+         * @param entry Flat entry data.
+         * @return #centipede::ErrorCode::handler_incomp_n_locals if the number of local parameters is larger than
+         * MasterOpt::n_locals. Fewer local parameters are allowed, since the last local parameters are missing if their
+         * derivatives are zero (see FlatEntry::get_n_locals()).
+         * #centipede::ErrorCode::handler_too_many_globals if the label map is full and a global label is not in it.
+         */
+        auto analyze(const FlatEntry& entry) -> EnumError<>
+        {
+            if (entry.empty())
+            {
+                return {};
+            }
+            if (not is_compatible_flat_n_locals(entry.get_n_locals()))
+            {
+                return std::unexpected{ ErrorCode::handler_incomp_n_locals };
+            }
+            if constexpr (opt.has_multi_slaves)
+            {
+                auto flat_entry = engine_imp_.acquire_flat_entry();
+                flat_entry = entry;
+                if constexpr (opt.has_label_map)
+                {
+                    if (auto res = map_flat_entry(flat_entry); not res)
+                    {
+                        engine_imp_.release_flat_entry(std::move(flat_entry));
+                        return res;
+                    }
+                }
+                engine_imp_.submit(std::move(flat_entry));
+                return {};
+            }
+            else
+            {
+                const auto* mapped_entry = &entry;
+                if constexpr (opt.has_label_map)
+                {
+                    mapped_entries_.resize(std::max<std::size_t>(mapped_entries_.size(), 1));
+                    mapped_entries_.front() = entry;
+                    if (auto res = map_flat_entry(mapped_entries_.front()); not res)
+                    {
+                        return res;
+                    }
+                    mapped_entry = &mapped_entries_.front();
+                }
+                engine_imp_.fill_data(*mapped_entry);
+                auto res = engine_imp_.analyze(config_.alpha);
+                if (not res)
+                {
+                    return std::unexpected{ res.error() };
+                }
+                return {};
+            }
+        }
+
+        /**
+         * @brief Fitting the data of a batch of flat entries.
+         *
+         * Without multiple slaves, the whole batch is given to the engine, which groups the entries with the same
+         * global parameters and merges their global updates (see Engine::analyze()). With multiple slaves, the
+         * non-empty entries are copied to a recycled batch of the slave pool, which is submitted as a single job and
+         * analyzed by one slave in the same way. Errors from the fitting of individual entries are only recorded in
+         * the entry statistics of the result. Empty entries are ignored.
+         *
+         * @param entries Flat entries, e.g. read by reader::Binary::read_flat_entries().
+         * @return #centipede::ErrorCode::handler_incomp_n_locals if the number of local parameters of any entry is
+         * larger than MasterOpt::n_locals. No entry is analyzed in this case.
+         * #centipede::ErrorCode::handler_too_many_globals if the label map is full and a global label is not in it.
+         * The entries before the failing entry are analyzed in this case.
+         */
+        auto analyze(std::span<const FlatEntry> entries) -> EnumError<>
+        {
+            if (not std::ranges::all_of(entries,
+                                        [](const FlatEntry& entry) -> bool
+                                        { return entry.empty() or is_compatible_flat_n_locals(entry.get_n_locals()); }))
             {
-                return std::unexpected{ res.error() };
+                return std::unexpected{ ErrorCode::handler_incomp_n_locals };
+            }
+            if constexpr (opt.has_multi_slaves)
+            {
+                auto batch = engine_imp_.acquire_flat_batch();
+                auto n_entries = std::size_t{};
+                for (const auto& entry :
+                     entries | std::views::filter([](const FlatEntry& entry) -> bool { return not entry.empty(); }))
+                {
+                    batch.resize(std::max(batch.size(), n_entries + 1));
+                    auto& batch_entry = batch[n_entries];
+                    batch_entry = entry;
+                    if constexpr (opt.has_label_map)
+                    {
+                        if (auto res = map_flat_entry(batch_entry); not res)
+                        {
+                            batch.resize(n_entries);
+                            engine_imp_.submit(std::move(batch));
+                            return res;
+                        }
+                    }
+                    ++n_entries;
+                }
+                batch.resize(n_entries);
+                engine_imp_.submit(std::move(batch));
+            }
+            else if constexpr (opt.has_label_map)
+            {
+                mapped_entries_.resize(std::max(mapped_entries_.size(), entries.size()));
+                for (const auto& [entry_idx, entry] : std::views::enumerate(entries))
+                {
+                    auto& mapped_entry = mapped_entries_[static_cast<std::size_t>(entry_idx)];
+                    mapped_entry = entry;
+                    if (auto res = map_flat_entry(mapped_entry); not res)
+                    {
+                        engine_imp_.analyze(std::span{ mapped_entries_ }.first(static_cast<std::size_t>(entry_idx)),
+                                            config_.alpha);
+                        return res;
+                    }
+                }
+                engine_imp_.analyze(std::span{ mapped_entries_ }.first(entries.size()), config_.alpha);
+            }
+            else
+            {
+                engine_imp_.analyze(entries, config_.alpha);
             }
             return {};
         }
@@ -137,35 +363,388 @@ namespace centipede::core::engine
          */
         auto solve() -> EnumError<>
         {
-            engine_imp_.add_to_globals(globals_);
+            if constexpr (opt.has_multi_slaves)
+            {
+                engine_imp_.wait();
+            }
+            globals_ = {};
+            collect_globals(globals_);
             engine_imp_.add_to_result(result_);
-            engine_imp_.solve(globals_, result_);
+            result_.n_entries += checkpoint_log_.n_entries_read;
+            result_.n_entries_rejected += checkpoint_log_.n_entries_rejected;
+            if constexpr (ConstrainedEngine<EngineImp, DataType>)
+            {
+                EngineImp::solve(globals_, get_correction_constraints(), result_, config_.solver);
+            }
+            else
+            {
+                EngineImp::solve(globals_, result_, config_.solver);
+            }
+            if constexpr (opt.has_label_map)
+            {
+                map_result_to_labels();
+            }
 
             return (result_.error_status == ErrorCode::success) ? EnumError<>{}
                                                                 : std::unexpected{ result_.error_status };
         }
 
+        /**
+         * @brief Write the global system accumulated so far to a checkpoint file.
+         *
+         * The global systems of the engines and of the added checkpoints are summed up. With multiple slaves, the
+         * function waits until all submitted entries are analyzed. The current entry, which isn't analyzed yet, isn't
+         * included. With a label map, the labels of the parameters are stored as well.
+         *
+         * @param filename Name of the checkpoint file.
+         * @param is_sparse Store the factor matrix in the sparse format. See Checkpoint::write().
+         * @return #centipede::ErrorCode::writer_file_fail_to_open if the file cannot be written.
+         */
+        auto write_checkpoint(const std::string& filename, bool is_sparse = EngineImp::is_sparse) -> EnumError<>
+            requires CheckpointableEngine<EngineImp>
+        {
+            if constexpr (opt.has_multi_slaves)
+            {
+                engine_imp_.wait();
+            }
+            auto globals = typename EngineImp::Globals{};
+            collect_globals(globals);
+            auto log = checkpoint_log_;
+            engine_imp_.add_to_log(log);
+            auto labels = std::span<const uint32_t>{};
+            if constexpr (opt.has_label_map)
+            {
+                labels = label_map_.get_labels();
+            }
+            return CheckpointType::write(filename, globals, log, labels, is_sparse);
+        }
+
+        /**
+         * @brief Add the global system of a checkpoint file, e.g. to resume an accumulation or to merge the systems
+         * accumulated by other processes.
+         *
+         * With a label map, the labels stored in the checkpoint are mapped into the label map of this master, such
+         * that the checkpoints may have been written with different label maps.
+         *
+         * @param filename Name of the checkpoint file.
+         * @return Any error from Checkpoint::open().
+         * #centipede::ErrorCode::reader_invalid_checkpoint if the checkpoint has more global parameters than
+         * Config::n_globals or its labels don't match the usage of a label map.
+         * #centipede::ErrorCode::handler_too_many_globals if the label map is full and a label is not in it.
+         */
+        auto add_checkpoint(const std::string& filename) -> EnumError<>
+            requires CheckpointableEngine<EngineImp>
+        {
+            auto checkpoint = CheckpointType{};
+            if (auto res = checkpoint.open(filename); not res)
+            {
+                return res;
+            }
+            if (checkpoint_globals_.rhs_vec.size() == 0)
+            {
+                const auto n_globals = static_cast<Eigen::Index>(config_.n_globals);
+                checkpoint_globals_.rhs_vec.setZero(n_globals);
+                checkpoint_globals_.factor_matrix.resize(n_globals, n_globals);
+                checkpoint_globals_.factor_matrix.setZero();
+            }
+
+            auto add_res = EnumError<>{};
+            if constexpr (opt.has_label_map)
+            {
+                static_assert(skipped_label == CheckpointType::skipped_index);
+                const auto labels = checkpoint.get_labels();
+                if (labels.size() != checkpoint.get_n_globals())
+                {
+                    return std::unexpected{ ErrorCode::reader_invalid_checkpoint };
+                }
+                auto indices = std::vector<uint32_t>{ labels.begin(), labels.end() };
+                if (auto res = map_global_labels(indices); not res)
+                {
+                    return res;
+                }
+                add_res = checkpoint.add_to_globals(checkpoint_globals_, indices);
+            }
+            else
+            {
+                if (not checkpoint.get_labels().empty())
+                {
+                    return std::unexpected{ ErrorCode::reader_invalid_checkpoint };
+                }
+                add_res = checkpoint.add_to_globals(checkpoint_globals_);
+            }
+            if (add_res)
+            {
+                checkpoint.add_to_log(checkpoint_log_);
+            }
+            return add_res;
+        }
+
+        /**
+         * @brief Set the current values of the global parameters for the following entries.
+         *
+         * The contributions of these values are subtracted from the measurements of the entries analyzed afterwards,
+         * such that the result of #solve() is the correction to them. Parameters not given are zero. With multiple
+         * slaves, the function waits until all submitted entries are analyzed.
+         *
+         * @param parameters Pairs of global labels and values, e.g. the sum of the parameters of previous results.
+         * @return #centipede::ErrorCode::handler_too_many_globals if a label is not smaller than Config::n_globals or,
+         * with a label map, the label map is full and a label is not in it. Labels not in a fixed label map are
+         * ignored.
+         */
+        auto set_global_parameters(std::span<const typename Result::IdxValuePair> parameters) -> EnumError<>
+            requires LocalFitConfigurableEngine<EngineImp, DataType>
+        {
+            if constexpr (opt.has_multi_slaves)
+            {
+                engine_imp_.wait();
+            }
+            global_parameters_.assign(config_.n_globals, DataType{});
+            for (const auto& [label, value] : parameters)
+            {
+                auto index = label;
+                if constexpr (opt.has_label_map)
+                {
+                    auto mapped_label = std::array{ static_cast<uint32_t>(label) };
+                    if (auto res = map_global_labels(mapped_label); not res)
+                    {
+                        return res;
+                    }
+                    if (mapped_label.front() == skipped_label)
+                    {
+                        continue;
+                    }
+                    index = mapped_label.front();
+                }
+                if (index >= global_parameters_.size())
+                {
+                    return std::unexpected{ ErrorCode::handler_too_many_globals };
+                }
+                global_parameters_[index] = value;
+            }
+            engine_imp_.set_global_parameters(global_parameters_);
+            return {};
+        }
+
+        /**
+         * @brief Add a linear equality constraint on the global parameters, which is applied in #solve().
+         *
+         * With a label map, the labels of the terms are mapped like the labels of the entries, i.e. terms with labels
+         * not in a fixed label map are removed. Constraints without terms are ignored.
+         *
+         * @param constraint Constraint whose terms have global labels.
+         * @return #centipede::ErrorCode::handler_too_many_globals if a label is not smaller than Config::n_globals or,
+         * with a label map, the label map is full and a label is not in it.
+         */
+        auto add_constraint(Constraint<DataType> constraint) -> EnumError<>
+            requires ConstrainedEngine<EngineImp, DataType>
+        {
+            if constexpr (opt.has_label_map)
+            {
+                if (auto res = map_global_labels(constraint.terms |
+                                                 std::views::transform([](Constraint<DataType>::Term& term) -> uint32_t&
+                                                                       { return term.first; }));
+                    not res)
+                {
+                    return res;
+                }
+                std::erase_if(constraint.terms,
+                              [](const Constraint<DataType>::Term& term) -> bool
+                              { return term.first == skipped_label; });
+            }
+            else if (std::ranges::any_of(constraint.terms,
+                                         [this](const Constraint<DataType>::Term& term) -> bool
+                                         { return term.first >= config_.n_globals; }))
+            {
+                return std::unexpected{ ErrorCode::handler_too_many_globals };
+            }
+            if (not constraint.terms.empty())
+            {
+                constraints_.push_back(std::move(constraint));
+            }
+            return {};
+        }
+
+        [[nodiscard]] auto get_constraints() const -> const auto& { return constraints_; }
+
         [[nodiscard]] auto get_current_state() const -> const auto& { return current_state_; }
 
-        [[nodiscard]] auto get_engine() const -> const auto& { return engine_imp_; }
+        [[nodiscard]] auto get_engine() const -> const auto&
+            requires(not opt.has_multi_slaves)
+        {
+            return engine_imp_;
+        }
+
+        [[nodiscard]] auto get_slave_pool() const -> const auto&
+            requires(opt.has_multi_slaves)
+        {
+            return engine_imp_;
+        }
 
         [[nodiscard]] auto get_result() const -> const auto& { return result_; }
 
+        [[nodiscard]] auto get_label_map() const -> const auto&
+            requires(opt.has_label_map)
+        {
+            return label_map_;
+        }
+
       private:
         Config config_;
         Result result_;
         State current_state_;
-        EngineImp engine_imp_{};
+        common::LabelMap label_map_;
+        std::vector<FlatEntry> mapped_entries_;         //!< Copies of the flat entries with mapped global labels.
+        std::vector<DataType> global_parameters_;       //!< Current global parameter values by parameter index.
+        std::vector<Constraint<DataType>> constraints_; //!< Constraints with parameter indices.
+        EngineHolder engine_imp_;
         EngineImp::Globals globals_{};
+        EngineImp::Globals checkpoint_globals_{}; //!< Sum of the global systems from the added checkpoints.
+        CheckpointType::Log checkpoint_log_{};    //!< Sum of the entry statistics from the added checkpoints.
+
+        constexpr static auto skipped_label = std::numeric_limits<uint32_t>::max(); //!< Label of skipped derivatives.
+
+        static auto create_engine(const Config& config) -> EngineHolder
+        {
+            if constexpr (opt.has_multi_slaves)
+            {
+                return SlavePoolType{ typename SlavePoolType::Config{
+                    .n_globals = config.n_globals,
+                    .alpha = config.alpha,
+                    .n_slaves = config.n_slaves,
+                    .max_n_queued_entries = config.max_n_queued_entries,
+                    .outlier = config.outlier,
+                    .chi2_cut_factor = config.chi2_cut_factor,
+                } };
+            }
+            else
+            {
+                return EngineImp{ config.n_globals };
+            }
+        }
+
+        /**
+         * @brief Sum up the global systems of the engines and the added checkpoints.
+         */
+        void collect_globals(EngineImp::Globals& globals)
+        {
+            engine_imp_.add_to_globals(globals);
+            if constexpr (CheckpointableEngine<EngineImp>)
+            {
+                if (checkpoint_globals_.rhs_vec.size() != 0)
+                {
+                    globals.factor_matrix += checkpoint_globals_.factor_matrix;
+                    globals.rhs_vec += checkpoint_globals_.rhs_vec;
+                }
+            }
+            if constexpr (opt.has_label_map)
+            {
+                // The engines are sized for the capacity of the label map. Unused parameters are removed.
+                EngineImp::shrink_globals(globals, label_map_.size());
+            }
+        }
+
+        /**
+         * @brief Constraints on the corrections of the current global parameters.
+         *
+         * The values of the constraints are reduced by the constrained sums of the current global parameters.
+         */
+        auto get_correction_constraints() const -> std::vector<Constraint<DataType>>
+        {
+            auto correction_constraints = constraints_;
+            if (not global_parameters_.empty())
+            {
+                for (auto& constraint : correction_constraints)
+                {
+                    for (const auto& [par_idx, coefficient] : constraint.terms)
+                    {
+                        constraint.value -= coefficient * global_parameters_[par_idx];
+                    }
+                }
+            }
+            return correction_constraints;
+        }
+
+        static auto is_compatible_n_locals(std::size_t n_locals) -> bool
+        {
+            return opt.n_locals == internal::DYNAMIC_SIZE or n_locals == opt.n_locals;
+        }
+
+        static auto is_compatible_flat_n_locals(std::size_t n_locals) -> bool
+        {
+            return opt.n_locals == internal::DYNAMIC_SIZE or n_locals <= opt.n_locals;
+        }
+
+        /**
+         * @brief Replace global labels by their dense indices, inserting new labels into the label map.
+         *
+         * If the map is full and a label is not in it, the labels inserted by this call are removed from the map
+         * again. If the map is fixed, labels not in it are replaced by #skipped_label instead.
+         */
+        auto map_global_labels(std::ranges::range auto&& labels) -> EnumError<>
+        {
+            const auto n_old_labels = label_map_.size();
+            for (auto&& label : labels)
+            {
+                if (config_.is_label_map_fixed)
+                {
+                    label = label_map_.find(label).value_or(skipped_label);
+                }
+                else if (label_map_.size() < config_.n_globals)
+                {
+                    label = label_map_.insert(label);
+                }
+                else if (const auto index = label_map_.find(label); index.has_value())
+                {
+                    label = index.value();
+                }
+                else
+                {
+                    label_map_.truncate(n_old_labels);
+                    return std::unexpected{ ErrorCode::handler_too_many_globals };
+                }
+            }
+            return {};
+        }
+
+        /**
+         * @brief Map the global labels of a flat entry and remove the skipped derivatives.
+         */
+        auto map_flat_entry(FlatEntry& entry) -> EnumError<>
+        {
+            if (auto res = map_global_labels(entry.get_global_labels()); not res)
+            {
+                return res;
+            }
+            if (config_.is_label_map_fixed)
+            {
+                entry.remove_globals_if([](uint32_t label) -> bool { return label == skipped_label; });
+            }
+            return {};
+        }
+
+        /**
+         * @brief Replace the dense parameter indices in the result by their labels.
+         */
+        void map_result_to_labels()
+        {
+            for (auto& parameter : result_.parameters)
+            {
+                parameter.first = label_map_.get_label(parameter.first);
+            }
+            for (auto& error : result_.errors)
+            {
+                error.first = label_map_.get_label(error.first);
+            }
+            for (auto& index : result_.redundant_parameter_indices)
+            {
+                index = label_map_.get_label(index);
+            }
+        }
 
         void reset_state()
         {
             current_state_.point_index = 0;
-            current_state_.entry.global_derivs.clear();
-            current_state_.entry.local_derivs.clear();
-            current_state_.entry.measurements.clear();
-            current_state_.entry.sigmas.clear();
-            current_state_.entry.n_locals.reset();
+            current_state_.entry.clear();
         }
     };
 
@@ -20,9 +20,12 @@ namespace centipede::core::engine
         std::size_t rank_deficit = 0;                         //!< Rank deficit value.
         uint64_t n_entries = 0;                               //!< Total number of entries read.
         uint64_t n_entries_rejected = 0;                      //!< Total number of entries rejected.
-        std::vector<DataType> eigen_values;                   //!< Eigen values of global factor matrix.
+        std::size_t n_solver_iterations = 0;                  //!< Number of iterations of the iterative solver.
+        double solver_error = 0.;                             //!< Relative residual error of the iterative solver.
+        std::vector<DataType> pivots;                         //!< LDLT pivots of a singular global factor matrix.
         std::vector<std::size_t> redundant_parameter_indices; //!< Indices of parameters that are linear dependent.
         std::vector<IdxValuePair> parameters;                 //!< Resulting parameter values.
+        std::vector<IdxValuePair> errors;                     //!< Parameter errors if SolverConfig::compute_errors.
     };
 
 } // namespace centipede::core::engine
@@ -65,14 +68,14 @@ struct std::formatter<centipede::Result<DataType>>
                                   "Error: {}\n"
                                   "Rank deficit: {}. Possible redundant parameter indices: {}\n"
                                   "Total entries: {}\t Rejected entries: {}\t Rejected rate: {:.2}%\n"
-                                  "Eigen values from global factor matrix: {}",
+                                  "Pivots of the global factor matrix: {}",
                                   result.error_status,
                                   result.rank_deficit,
                                   result.redundant_parameter_indices,
                                   result.n_entries,
                                   result.n_entries_rejected,
                                   percentage,
-                                  result.eigen_values);
+                                  result.pivots);
         }
     }
 };
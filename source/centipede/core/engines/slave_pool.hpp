@@ -0,0 +1,341 @@
+#pragma once
+
+#include "centipede/core/engines/engine_types.hpp"
+#include "centipede/core/engines/result.hpp"
+#include "centipede/data/entry.hpp"
+#include "centipede/data/flat_entry.hpp"
+#include "centipede/util/bounded_queue.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace centipede::core::engine
+{
+    /**
+     * @brief Pool of slave engines analyzing entries in parallel threads.
+     *
+     * Each slave engine runs in its own thread and owns its own global factor matrix and rhs vector. Entries
+     * submitted to the pool are pushed to a bounded queue, from which the idle slaves pop and analyze them. Once all
+     * submitted entries are analyzed (see #wait()), the global systems of all slaves are summed up via
+     * #add_to_globals().
+     *
+     * Entry objects (both #Entry and #FlatEntry) are recycled to avoid memory reallocations: a slave clears the entry
+     * after the analysis and puts it back to the pool, which can be taken again via #acquire_entry() or
+     * #acquire_flat_entry().
+     *
+     * Flat entries can also be submitted in batches (see #acquire_flat_batch()), which are analyzed together by one
+     * slave (see Engine::analyze(std::span<const FlatEntry>, double)). This reduces the synchronization on the entry
+     * queue to once per batch.
+     *
+     * @tparam EngineImp Type of the slave engine.
+     * @tparam DataType Floating point type used in the engine.
+     */
+    template <typename EngineImp, typename DataType>
+    class SlavePool
+    {
+      public:
+        /**
+         * @brief Configuration of the pool.
+         */
+        struct Config
+        {
+            std::size_t n_globals = 0;            //!< Number of global parameters.
+            double alpha = 0.;                    //!< Significance level to reject an entry.
+            std::size_t n_slaves = 0;             //!< Number of slave engines. 0 to use all hardware threads.
+            std::size_t max_n_queued_entries = 0; //!< Capacity of the entry queue. 0 to use 4 entries per slave.
+            OutlierConfig outlier{};              //!< Down-weighting of outliers in the local fits of the slaves.
+            double chi2_cut_factor = 1.;          //!< Factor of the chi2 cut (see Base::set_chi2_cut_factor()).
+        };
+
+        /**
+         * @brief Constructor.
+         *
+         * All slave engines are constructed and their threads are started.
+         * @param config Configuration of the pool.
+         */
+        explicit SlavePool(const Config& config)
+            : alpha_{ config.alpha }
+            , entry_queue_{ get_queue_capacity(config) }
+        {
+            const auto n_slaves = get_n_slaves(config);
+            slaves_.reserve(n_slaves);
+            workers_.reserve(n_slaves);
+            for (std::size_t idx = 0; idx < n_slaves; ++idx)
+            {
+                auto& slave = slaves_.emplace_back(config.n_globals);
+                slave.set_outlier_config(config.outlier);
+                slave.set_chi2_cut_factor(config.chi2_cut_factor);
+            }
+            for (auto& slave : slaves_)
+            {
+                workers_.emplace_back([this, &slave]() { run(slave); });
+            }
+        }
+
+        /**
+         * @brief Destructor.
+         *
+         * The entry queue is closed and the destructor waits until all slave threads are finished.
+         */
+        ~SlavePool()
+        {
+            entry_queue_.close();
+            workers_.clear();
+        }
+
+        SlavePool(const SlavePool&) = delete;
+        SlavePool(SlavePool&&) = delete;
+        auto operator=(const SlavePool&) -> SlavePool& = delete;
+        auto operator=(SlavePool&&) -> SlavePool& = delete;
+
+        /**
+         * @brief Take an empty entry from the pool.
+         *
+         * The entry has been used by a slave before and its allocated memory is kept. A new entry is created if no
+         * recycled entry is available.
+         * @return An empty entry.
+         */
+        [[nodiscard]] auto acquire_entry() -> Entry<DataType> { return acquire_from(recycled_entries_); }
+
+        /**
+         * @brief Take an empty flat entry from the pool.
+         *
+         * Same as #acquire_entry() but for flat entries.
+         * @return An empty flat entry.
+         */
+        [[nodiscard]] auto acquire_flat_entry() -> FlatEntry { return acquire_from(recycled_flat_entries_); }
+
+        /**
+         * @brief Put a flat entry back to the pool without submitting it.
+         *
+         * The entry is cleared and can be taken again via #acquire_flat_entry().
+         * @param entry Flat entry taken from #acquire_flat_entry().
+         */
+        void release_flat_entry(FlatEntry entry)
+        {
+            entry.clear();
+            auto lock = std::scoped_lock{ recycle_mutex_ };
+            recycled_flat_entries_.push_back(std::move(entry));
+        }
+
+        /**
+         * @brief Take a batch of flat entries from the pool.
+         *
+         * The entries of a recycled batch are not cleared, such that their memory is reused when new entries are
+         * assigned to them. The batch should be resized to the number of entries before submitting.
+         * @return A recycled batch of flat entries.
+         */
+        [[nodiscard]] auto acquire_flat_batch() -> std::vector<FlatEntry>
+        {
+            return acquire_from(recycled_flat_batches_);
+        }
+
+        /**
+         * @brief Submit an entry to be analyzed by one of the slaves.
+         *
+         * The calling thread is blocked while the entry queue is full.
+         * @param entry Entry to be analyzed. Either an #Entry, a #FlatEntry or a batch of flat entries.
+         */
+        template <typename EntryType>
+            requires(std::is_same_v<EntryType, Entry<DataType>> or std::is_same_v<EntryType, FlatEntry> or
+                     std::is_same_v<EntryType, std::vector<FlatEntry>>)
+        void submit(EntryType entry)
+        {
+            {
+                auto lock = std::scoped_lock{ pending_mutex_ };
+                ++n_pending_;
+            }
+            entry_queue_.push(std::move(entry));
+        }
+
+        /**
+         * @brief Wait until all submitted entries are analyzed.
+         */
+        void wait()
+        {
+            auto lock = std::unique_lock{ pending_mutex_ };
+            pending_cv_.wait(lock, [this]() -> bool { return n_pending_ == 0; });
+        }
+
+        /**
+         * @brief Set the current values of the global parameters of all slaves (see Base::set_global_parameters()).
+         *
+         * #wait() must be called before this function.
+         * @param parameters Values indexed by the global parameter index, which must outlive the analysis.
+         */
+        void set_global_parameters(std::span<const DataType> parameters)
+        {
+            for (auto& slave : slaves_)
+            {
+                slave.set_global_parameters(parameters);
+            }
+        }
+
+        /**
+         * @brief Add the global factor matrices and rhs vectors of all slaves to the globals.
+         *
+         * #wait() must be called before this function.
+         * @param globals Globals where the values are added to.
+         */
+        void add_to_globals(typename EngineImp::Globals& globals)
+        {
+            for (auto& slave : slaves_)
+            {
+                slave.add_to_globals(globals);
+            }
+        }
+
+        /**
+         * @brief Add the entry statistics of all slaves to the result.
+         *
+         * #wait() must be called before this function.
+         * @param result Result where the values are added to.
+         */
+        void add_to_result(Result<DataType>& result)
+        {
+            for (auto& slave : slaves_)
+            {
+                slave.add_to_result(result);
+            }
+        }
+
+        /**
+         * @brief Add the entry statistics of all slaves to a log.
+         *
+         * #wait() must be called before this function.
+         * @param log Log where the values are added to.
+         */
+        void add_to_log(typename EngineImp::Log& log) const
+        {
+            for (const auto& slave : slaves_)
+            {
+                slave.add_to_log(log);
+            }
+        }
+
+        /**
+         * @brief Getter of the slave engines.
+         */
+        [[nodiscard]] auto get_slaves() const -> const auto& { return slaves_; }
+
+        /**
+         * @brief Number of flat entries waiting in the pool to be acquired again.
+         */
+        [[nodiscard]] auto get_n_recycled_flat_entries() const -> std::size_t
+        {
+            auto lock = std::scoped_lock{ recycle_mutex_ };
+            return recycled_flat_entries_.size();
+        }
+
+      private:
+        constexpr static auto default_n_queued_entries_per_slave = std::size_t{ 4 };
+
+        //! Element type of the entry queue.
+        using Job = std::variant<Entry<DataType>, FlatEntry, std::vector<FlatEntry>>;
+
+        double alpha_ = 0.;
+        std::vector<EngineImp> slaves_;
+        common::BoundedQueue<Job> entry_queue_;
+        mutable std::mutex recycle_mutex_;
+        std::vector<Entry<DataType>> recycled_entries_;
+        std::vector<FlatEntry> recycled_flat_entries_;
+        std::vector<std::vector<FlatEntry>> recycled_flat_batches_;
+        std::mutex pending_mutex_;
+        std::condition_variable pending_cv_;
+        std::size_t n_pending_ = 0;
+        std::vector<std::jthread> workers_; //!< Slave threads. Must be destroyed before other members.
+
+        static auto get_n_slaves(const Config& config) -> std::size_t
+        {
+            if (config.n_slaves != 0)
+            {
+                return config.n_slaves;
+            }
+            return std::max(std::size_t{ std::thread::hardware_concurrency() }, std::size_t{ 1 });
+        }
+
+        static auto get_queue_capacity(const Config& config) -> std::size_t
+        {
+            if (config.max_n_queued_entries != 0)
+            {
+                return config.max_n_queued_entries;
+            }
+            return get_n_slaves(config) * default_n_queued_entries_per_slave;
+        }
+
+        template <typename EntryType>
+        auto acquire_from(std::vector<EntryType>& recycled) -> EntryType
+        {
+            auto lock = std::scoped_lock{ recycle_mutex_ };
+            if (recycled.empty())
+            {
+                return EntryType{};
+            }
+            auto entry = std::move(recycled.back());
+            recycled.pop_back();
+            return entry;
+        }
+
+        static auto is_empty(const Entry<DataType>& entry) -> bool { return not entry.n_locals.has_value(); }
+        static auto is_empty(const FlatEntry& entry) -> bool { return entry.empty(); }
+
+        void run(EngineImp& slave)
+        {
+            while (auto job = entry_queue_.pop())
+            {
+                std::visit(
+                    [this, &slave](auto& entry)
+                    {
+                        if constexpr (std::is_same_v<std::remove_cvref_t<decltype(entry)>, std::vector<FlatEntry>>)
+                        {
+                            analyze_batch(slave, entry);
+                        }
+                        else
+                        {
+                            if (not is_empty(entry))
+                            {
+                                slave.fill_data(entry);
+                                [[maybe_unused]] auto res = slave.analyze(alpha_);
+                            }
+                            entry.clear();
+                            auto lock = std::scoped_lock{ recycle_mutex_ };
+                            if constexpr (std::is_same_v<std::remove_cvref_t<decltype(entry)>, FlatEntry>)
+                            {
+                                recycled_flat_entries_.push_back(std::move(entry));
+                            }
+                            else
+                            {
+                                recycled_entries_.push_back(std::move(entry));
+                            }
+                        }
+                    },
+                    *job);
+                finish_one();
+            }
+        }
+
+        void analyze_batch(EngineImp& slave, std::vector<FlatEntry>& batch)
+        {
+            [[maybe_unused]] auto n_entries_success = slave.analyze(std::span{ std::as_const(batch) }, alpha_);
+            auto lock = std::scoped_lock{ recycle_mutex_ };
+            recycled_flat_batches_.push_back(std::move(batch));
+        }
+
+        void finish_one()
+        {
+            auto lock = std::scoped_lock{ pending_mutex_ };
+            --n_pending_;
+            if (n_pending_ == 0)
+            {
+                pending_cv_.notify_all();
+            }
+        }
+    };
+} // namespace centipede::core::engine
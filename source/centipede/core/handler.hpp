@@ -5,6 +5,7 @@
 #include "centipede/data/entry.hpp"
 #include "centipede/util/return_types.hpp"
 #include <cstddef>
+#include <utility>
 
 namespace centipede::core
 {
@@ -53,6 +54,14 @@ namespace centipede::core
 
         auto analyze_current_entry() -> EnumError<std::size_t> { return {}; };
 
+        /**
+         * @brief Add a linear equality constraint on the global parameters. See engine::Master::add_constraint().
+         */
+        [[nodiscard]] auto add_constraint(engine::Constraint<DataType> constraint) -> EnumError<>
+        {
+            return engine_.add_constraint(std::move(constraint));
+        }
+
         [[nodiscard]] auto get_current_state() const -> const auto& { return engine_.get_current_state(); }
 
       private:
@@ -0,0 +1,225 @@
+#pragma once
+
+#include "centipede/core/engines/engine_concept.hpp"
+#include "centipede/core/engines/engine_types.hpp"
+#include "centipede/core/engines/master_engine.hpp"
+#include "centipede/data/flat_entry.hpp"
+#include "centipede/reader/entry_cache.hpp"
+#include "centipede/reader/multi_file.hpp"
+#include "centipede/util/error_types.hpp"
+#include "centipede/util/label_map.hpp"
+#include "centipede/util/return_types.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <expected>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace centipede::core
+{
+    /**
+     * @brief Driver of an iterative alignment with cached entries.
+     *
+     * Each iteration accumulates and solves the global system of all entries with the current values of the global
+     * parameters, which are the sums of the corrections of all previous iterations (see
+     * engine::Master::set_global_parameters()). This converges for non-linear problems or when the outlier rejection
+     * depends on the parameters. The first iteration reads the binary files with reader::MultiFile and adds the
+     * parsed entries to a reader::EntryCache. The following iterations replay the cache, such that the files are only
+     * read and parsed once.
+     *
+     * The \f$\chi^2\f$ cut of the local fits can be loosened in the first iterations by the factors in
+     * Config::chi2_cut_factors, since the entries are fitted with parameters far from their final values. If the
+     * master uses a label map, the label map of the first iteration is used in the following ones, such that the
+     * parameter indices don't change. The constraints in Config::constraints are added to the master of each
+     * iteration and apply to the sums of the parameters (see engine::Master::add_constraint()).
+     *
+     * #### Example usage
+     *
+     * ```cpp
+     * auto driver = centipede::core::IterationDriver<double, { .has_multi_slaves = true }>{
+     *     { .master = { .n_globals = 100 }, .n_iterations = 3, .chi2_cut_factors = { 16., 4., 1. } }
+     * };
+     * auto run_err = driver.run({ .in_filenames = std::move(filenames) });
+     * const auto& parameters = driver.get_parameters();
+     * ```
+     */
+    template <typename DataType = double, engine::MasterOpt opt = {}>
+        requires engine::LocalFitConfigurableEngine<engine::Engine<opt.engine_type, DataType, opt.n_locals>, DataType>
+    class IterationDriver
+    {
+      public:
+        using MasterType = engine::Master<DataType, opt>;
+        using Result = typename MasterType::Result;
+        using IdxValuePair = typename Result::IdxValuePair;
+        using ConstraintType = engine::Constraint<DataType>;
+
+        /**
+         * @brief Configuration of the iterations.
+         */
+        struct Config
+        {
+            MasterType::Config master{};             //!< Configuration of the master of each iteration.
+            std::size_t n_iterations = 3;            //!< Number of iterations, including the one reading the files.
+            std::vector<double> chi2_cut_factors;    //!< Factors of the chi2 cut. The last one is used afterwards.
+            reader::EntryCache::Config cache{};      //!< Configuration of the entry cache.
+            std::vector<ConstraintType> constraints; //!< Constraints on the global parameters.
+        };
+
+        explicit IterationDriver(Config config)
+            : config_{ std::move(config) }
+        {
+        }
+
+        /**
+         * @brief Run all iterations.
+         *
+         * The parameters and results of previous runs are cleared.
+         * @param input Configuration of the reader of the binary files.
+         * @return Any error from reader::MultiFile, reader::EntryCache or the master, e.g. from
+         * engine::Master::solve(). The results of the iterations before the failing one are kept.
+         */
+        auto run(reader::MultiFile::Config input) -> EnumError<>
+        {
+            parameters_.clear();
+            results_.clear();
+            label_map_ = config_.master.label_map;
+            cache_.emplace(config_.cache);
+            for (auto iteration = std::size_t{}; iteration < std::max<std::size_t>(config_.n_iterations, 1);
+                 ++iteration)
+            {
+                if (auto res = run_iteration(iteration, input); not res)
+                {
+                    return res;
+                }
+            }
+            return {};
+        }
+
+        /**
+         * @brief Getter of the factor of the \f$\chi^2\f$ cut in an iteration.
+         */
+        [[nodiscard]] auto get_chi2_cut_factor(std::size_t iteration) const -> double
+        {
+            const auto& factors = config_.chi2_cut_factors;
+            return factors.empty() ? 1. : factors[std::min(iteration, factors.size() - 1)];
+        }
+
+        /**
+         * @brief Getter of the global parameters, i.e. the sums of the corrections of all iterations.
+         *
+         * The pairs of global labels and values are sorted by the labels.
+         */
+        [[nodiscard]] auto get_parameters() const -> const std::vector<IdxValuePair>& { return parameters_; }
+
+        /**
+         * @brief Getter of the results of the iterations, whose parameters are the corrections of each iteration.
+         */
+        [[nodiscard]] auto get_results() const -> const std::vector<Result>& { return results_; }
+
+        [[nodiscard]] auto get_cache() const -> const auto& { return cache_; }
+
+      private:
+        Config config_;
+        std::optional<reader::EntryCache> cache_;
+        std::vector<IdxValuePair> parameters_; //!< Sums of the corrections, sorted by the labels.
+        std::vector<Result> results_;          //!< Result of each iteration.
+        common::LabelMap label_map_;           //!< Label map of the first iteration.
+
+        auto run_iteration(std::size_t iteration, const reader::MultiFile::Config& input) -> EnumError<>
+        {
+            auto master_config = config_.master;
+            master_config.chi2_cut_factor = get_chi2_cut_factor(iteration);
+            master_config.label_map = label_map_;
+            auto master = MasterType{ std::move(master_config) };
+            if (not parameters_.empty())
+            {
+                if (auto res = master.set_global_parameters(parameters_); not res)
+                {
+                    return res;
+                }
+            }
+            for (const auto& constraint : config_.constraints)
+            {
+                if (auto res = master.add_constraint(constraint); not res)
+                {
+                    return res;
+                }
+            }
+
+            if (iteration == 0)
+            {
+                if (auto res = read_input(master, input); not res)
+                {
+                    return res;
+                }
+            }
+            else if (auto res = cache_->for_each_batch([&master](std::span<const FlatEntry> entries) -> EnumError<>
+                                                       { return master.analyze(entries); });
+                     not res)
+            {
+                return res;
+            }
+
+            auto solve_res = master.solve();
+            results_.push_back(master.get_result());
+            if (not solve_res)
+            {
+                return solve_res;
+            }
+            add_corrections(master.get_result().parameters);
+            if constexpr (opt.has_label_map)
+            {
+                if (iteration == 0)
+                {
+                    label_map_ = master.get_label_map();
+                }
+            }
+            return {};
+        }
+
+        /**
+         * @brief Analyze the entries of the binary files and add them to the cache.
+         */
+        auto read_input(MasterType& master, const reader::MultiFile::Config& config) -> EnumError<>
+        {
+            auto input = reader::MultiFile{ config };
+            if (auto res = input.start(); not res)
+            {
+                return res;
+            }
+            while (auto batch = input.next_batch())
+            {
+                const auto entries = batch->get_entries();
+                if (auto res = master.analyze(entries); not res)
+                {
+                    return res;
+                }
+                if (auto res = cache_->add(entries); not res)
+                {
+                    return res;
+                }
+                input.recycle(std::move(batch.value()));
+            }
+            if (not input.is_ok())
+            {
+                return std::unexpected{ input.get_status() };
+            }
+            return cache_->finish();
+        }
+
+        void add_corrections(std::span<const IdxValuePair> corrections)
+        {
+            for (const auto& [label, correction] : corrections)
+            {
+                auto iter = std::ranges::lower_bound(parameters_, label, {}, &IdxValuePair::first);
+                if (iter == parameters_.end() or iter->first != label)
+                {
+                    iter = parameters_.insert(iter, IdxValuePair{ label, DataType{} });
+                }
+                iter->second += correction;
+            }
+        }
+    };
+} // namespace centipede::core
@@ -185,6 +185,18 @@ namespace centipede
         std::vector<DataType> sigmas;        //!< Sigmas from all entrypoints.
         std::vector<Deriv> local_derivs;     //!< Local derivatives.
         std::vector<Deriv> global_derivs;    //!< Global derivatives.
+
+        /**
+         * @brief Remove all entrypoints while keeping the allocated memory.
+         */
+        void clear()
+        {
+            n_locals.reset();
+            measurements.clear();
+            sigmas.clear();
+            local_derivs.clear();
+            global_derivs.clear();
+        }
     };
 
 }; // namespace centipede
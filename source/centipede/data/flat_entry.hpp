@@ -0,0 +1,281 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace centipede
+{
+    /**
+     * @class FlatEntry
+     * @brief Flat representation of all entrypoints in an entry.
+     *
+     * All values of an entry are stored in a structure of arrays: measurements and sigmas of each entrypoint,
+     * together with the labels and values of the local and global derivatives of all entrypoints. The derivatives of
+     * the entrypoint `i` are located in the range `[offsets[i], offsets[i + 1])` of the corresponding label and value
+     * arrays. Labels use **0-based indexing**.
+     *
+     * Clearing the entry keeps the allocated memory. Therefore, filling entries of similar sizes repeatedly doesn't
+     * allocate any memory after the first few entries.
+     *
+     * The entry can be iterated over, yielding a #PointView for each entrypoint, which provides the same getters as
+     * #EntryPoint.
+     */
+    class FlatEntry
+    {
+      public:
+        /**
+         * @brief Read-only view of an entrypoint in a #FlatEntry.
+         */
+        class PointView
+        {
+          public:
+            PointView(const FlatEntry* entry, std::size_t point_idx)
+                : entry_{ entry }
+                , point_idx_{ point_idx }
+            {
+            }
+
+            [[nodiscard]] auto get_measurement() const -> float { return entry_->measurements_[point_idx_]; }
+            [[nodiscard]] auto get_sigma() const -> float { return entry_->sigmas_[point_idx_]; }
+
+            /**
+             * @brief Getter of the local derivative values.
+             */
+            [[nodiscard]] auto get_locals() const -> std::span<const float> { return get_local_values(); }
+
+            /**
+             * @brief Getter of the global derivatives as a range of label-value pairs.
+             */
+            [[nodiscard]] auto get_globals() const
+            {
+                return std::views::zip_transform([](uint32_t label, float value) -> std::pair<uint32_t, float>
+                                                 { return { label, value }; },
+                                                 get_global_labels(),
+                                                 get_global_values());
+            }
+
+            [[nodiscard]] auto get_local_labels() const -> std::span<const uint32_t>
+            {
+                return local_range(entry_->local_labels_);
+            }
+            [[nodiscard]] auto get_local_values() const -> std::span<const float>
+            {
+                return local_range(entry_->local_values_);
+            }
+            [[nodiscard]] auto get_global_labels() const -> std::span<const uint32_t>
+            {
+                return global_range(entry_->global_labels_);
+            }
+            [[nodiscard]] auto get_global_values() const -> std::span<const float>
+            {
+                return global_range(entry_->global_values_);
+            }
+
+          private:
+            const FlatEntry* entry_ = nullptr;
+            std::size_t point_idx_ = 0;
+
+            template <typename T>
+            [[nodiscard]] auto local_range(const std::vector<T>& data) const -> std::span<const T>
+            {
+                const auto begin = entry_->local_offsets_[point_idx_];
+                return std::span{ data }.subspan(begin, entry_->local_offsets_[point_idx_ + 1] - begin);
+            }
+
+            template <typename T>
+            [[nodiscard]] auto global_range(const std::vector<T>& data) const -> std::span<const T>
+            {
+                const auto begin = entry_->global_offsets_[point_idx_];
+                return std::span{ data }.subspan(begin, entry_->global_offsets_[point_idx_ + 1] - begin);
+            }
+        };
+
+        /**
+         * @brief Forward iterator over the entrypoints of a #FlatEntry.
+         */
+        class Iterator
+        {
+          public:
+            using iterator_category = std::forward_iterator_tag; //!< Iterator category type.
+            using difference_type = std::ptrdiff_t;              //!< Difference type.
+            using value_type = PointView;                        //!< Dereferenced value type.
+
+            Iterator() = default;
+            Iterator(const FlatEntry* entry, std::size_t point_idx)
+                : entry_{ entry }
+                , point_idx_{ point_idx }
+            {
+            }
+
+            auto operator*() const -> PointView { return PointView{ entry_, point_idx_ }; }
+
+            auto operator++() -> Iterator&
+            {
+                ++point_idx_;
+                return *this;
+            }
+
+            auto operator++(int) -> Iterator
+            {
+                auto tmp = *this;
+                ++point_idx_;
+                return tmp;
+            }
+
+            auto operator==(const Iterator& other) const -> bool { return point_idx_ == other.point_idx_; }
+
+          private:
+            const FlatEntry* entry_ = nullptr;
+            std::size_t point_idx_ = 0;
+        };
+
+        /**
+         * @brief Default constructor. The entry is empty.
+         */
+        FlatEntry() = default;
+
+        /**
+         * @brief Remove all entrypoints while keeping the allocated memory.
+         */
+        void clear()
+        {
+            measurements_.clear();
+            sigmas_.clear();
+            local_offsets_.assign(1, 0);
+            local_labels_.clear();
+            local_values_.clear();
+            global_offsets_.assign(1, 0);
+            global_labels_.clear();
+            global_values_.clear();
+            n_locals_ = 0;
+        }
+
+        /**
+         * @brief Start a new entrypoint.
+         *
+         * Derivatives added afterwards belong to this entrypoint.
+         * @param measurement Measurement value.
+         * @param sigma Sigma value.
+         */
+        void add_point(float measurement, float sigma = 0.F)
+        {
+            measurements_.push_back(measurement);
+            sigmas_.push_back(sigma);
+            local_offsets_.push_back(local_offsets_.back());
+            global_offsets_.push_back(global_offsets_.back());
+        }
+
+        /**
+         * @brief Set the sigma value of the last entrypoint.
+         */
+        void set_sigma(float sigma)
+        {
+            assert(not sigmas_.empty());
+            sigmas_.back() = sigma;
+        }
+
+        /**
+         * @brief Add a local derivative to the last entrypoint.
+         * @param label Local parameter index (0-based indexing).
+         * @param value Local derivative value.
+         */
+        void add_local(uint32_t label, float value)
+        {
+            assert(not measurements_.empty());
+            local_labels_.push_back(label);
+            local_values_.push_back(value);
+            ++local_offsets_.back();
+            n_locals_ = std::max(n_locals_, label + 1);
+        }
+
+        /**
+         * @brief Add a global derivative to the last entrypoint.
+         * @param label Global parameter index (0-based indexing).
+         * @param value Global derivative value.
+         */
+        void add_global(uint32_t label, float value)
+        {
+            assert(not measurements_.empty());
+            global_labels_.push_back(label);
+            global_values_.push_back(value);
+            ++global_offsets_.back();
+        }
+
+        /**
+         * @brief Remove the global derivatives whose labels fulfill a predicate.
+         *
+         * The order of the remaining global derivatives is preserved.
+         * @param pred Predicate taking the global label.
+         */
+        void remove_globals_if(std::predicate<uint32_t> auto pred)
+        {
+            auto n_kept = uint32_t{};
+            auto begin = uint32_t{};
+            for (auto& end : global_offsets_ | std::views::drop(1))
+            {
+                for (auto idx = begin; idx < end; ++idx)
+                {
+                    if (not pred(global_labels_[idx]))
+                    {
+                        global_labels_[n_kept] = global_labels_[idx];
+                        global_values_[n_kept] = global_values_[idx];
+                        ++n_kept;
+                    }
+                }
+                begin = std::exchange(end, n_kept);
+            }
+            global_labels_.resize(n_kept);
+            global_values_.resize(n_kept);
+        }
+
+        [[nodiscard]] auto size() const -> std::size_t { return measurements_.size(); }
+        [[nodiscard]] auto empty() const -> bool { return measurements_.empty(); }
+
+        /**
+         * @brief Getter of the number of local parameters, i.e. the largest local parameter index plus 1.
+         *
+         * Zero derivatives are not stored in binary files (see writer::Binary::add_entrypoint()). If the derivatives
+         * of the last local parameters are zero in all entrypoints, an entry read from a file has therefore fewer
+         * local parameters than the entrypoints it was written from. The local fit of the entrypoints would fail with
+         * a rank deficit in this case, while the flat entry is fitted without the missing parameters. If
+         * MasterOpt::n_locals is set, the engine uses that number instead.
+         */
+        [[nodiscard]] auto get_n_locals() const -> std::size_t { return n_locals_; }
+        [[nodiscard]] auto operator[](std::size_t point_idx) const -> PointView
+        {
+            assert(point_idx < size());
+            return PointView{ this, point_idx };
+        }
+        [[nodiscard]] auto begin() const -> Iterator { return Iterator{ this, 0 }; }
+        [[nodiscard]] auto end() const -> Iterator { return Iterator{ this, size() }; }
+
+        [[nodiscard]] auto get_measurements() const -> std::span<const float> { return measurements_; }
+        [[nodiscard]] auto get_sigmas() const -> std::span<const float> { return sigmas_; }
+        [[nodiscard]] auto get_local_offsets() const -> std::span<const uint32_t> { return local_offsets_; }
+        [[nodiscard]] auto get_local_labels() const -> std::span<const uint32_t> { return local_labels_; }
+        [[nodiscard]] auto get_local_values() const -> std::span<const float> { return local_values_; }
+        [[nodiscard]] auto get_global_offsets() const -> std::span<const uint32_t> { return global_offsets_; }
+        [[nodiscard]] auto get_global_labels() const -> std::span<const uint32_t> { return global_labels_; }
+        [[nodiscard]] auto get_global_labels() -> std::span<uint32_t> { return global_labels_; }
+        [[nodiscard]] auto get_global_values() const -> std::span<const float> { return global_values_; }
+
+      private:
+        std::vector<float> measurements_;           //!< Measurements of all entrypoints.
+        std::vector<float> sigmas_;                 //!< Sigmas of all entrypoints.
+        std::vector<uint32_t> local_offsets_{ 0 };  //!< Begin of the local derivatives of each entrypoint.
+        std::vector<uint32_t> local_labels_;        //!< Local parameter indices.
+        std::vector<float> local_values_;           //!< Local derivative values.
+        std::vector<uint32_t> global_offsets_{ 0 }; //!< Begin of the global derivatives of each entrypoint.
+        std::vector<uint32_t> global_labels_;       //!< Global parameter indices.
+        std::vector<float> global_values_;          //!< Global derivative values.
+        uint32_t n_locals_ = 0;                     //!< Number of local parameters.
+    };
+} // namespace centipede
@@ -1,8 +1,11 @@
 #include "binary.hpp"
 #include "centipede/data/entry.hpp"
+#include "centipede/util/block_compression.hpp"
+#include "centipede/util/entry_index.hpp"
 #include "centipede/util/error_types.hpp"
 #include "centipede/util/return_types.hpp"
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -12,14 +15,13 @@
 #include <functional>
 #include <ios>
 #include <iterator>
-#include <optional>
 #include <ranges>
+#include <span>
 #include <type_traits>
 #include <vector>
 
 namespace centipede::reader
 {
-    namespace srs = std::ranges;
     namespace svs = std::views;
     namespace
     {
@@ -54,143 +56,268 @@ namespace centipede::reader
             return read_size;
         }
 
-        template <typename IterCursor, typename IterEnd>
-        struct ChunkPointer
+        enum class ParseStage : uint8_t
         {
-            IterCursor iter;
-            IterEnd end;
-            EntryPoint<>* entrypoint;
+            begin,
+            locals,
+            globals,
         };
 
-        auto chunk_check_size_one(auto chunk_ptr)
+        /**
+         * @brief Parse a raw entry into entrypoints in a single linear scan.
+         *
+         * The layout is the same as in parse_flat_entry(). As zero derivatives are not written to the file, the local
+         * derivatives of each entrypoint are padded with zeros up to the largest local label.
+         */
+        auto parse_entry_points(const Binary::RawEntryView& input, Binary::BufferType& output) -> EnumError<std::size_t>
         {
-            assert(chunk_ptr.entrypoint != nullptr);
-            return (srs::size(*(chunk_ptr.iter)) == 1U) ? std::optional{ chunk_ptr } : std::nullopt;
+            if (input.labels.empty() or input.labels.front() != 0U)
+            {
+                return std::unexpected{ ErrorCode::reader_file_fail_to_read };
+            }
+            auto stage = ParseStage::begin;
+            auto current_n_points = std::size_t{};
+            for (const auto [label, value] : svs::zip(input.labels, input.values) | svs::drop(1))
+            {
+                if (label == 0U)
+                {
+                    if (stage == ParseStage::locals)
+                    {
+                        output[current_n_points - 1].set_sigma(value);
+                        stage = ParseStage::globals;
+                    }
+                    else
+                    {
+                        if (current_n_points == output.size())
+                        {
+                            return std::unexpected{ ErrorCode::reader_file_fail_to_read };
+                        }
+                        output[current_n_points].set_measurement(value);
+                        ++current_n_points;
+                        stage = ParseStage::locals;
+                    }
+                }
+                else if (stage == ParseStage::locals)
+                {
+                    auto& entrypoint = output[current_n_points - 1];
+                    while (entrypoint.get_locals().size() + 1U < label)
+                    {
+                        entrypoint.add_local(0.F);
+                    }
+                    if (entrypoint.get_locals().size() + 1U != label)
+                    {
+                        return std::unexpected{ ErrorCode::reader_file_fail_to_read };
+                    }
+                    entrypoint.add_local(value);
+                }
+                else if (stage == ParseStage::globals)
+                {
+                    output[current_n_points - 1].add_global(label - 1U, value);
+                }
+                else
+                {
+                    return std::unexpected{ ErrorCode::reader_file_fail_to_read };
+                }
+            }
+            if (stage != ParseStage::globals)
+            {
+                return std::unexpected{ ErrorCode::reader_file_fail_to_read };
+            }
+            return current_n_points;
         }
 
-        auto chunk_not_end_and_increment(auto chunk_ptr)
+        /**
+         * @brief Parse a raw entry into a flat entry in a single linear scan.
+         *
+         * Each label 0 toggles between a measurement and a sigma value. Non-zero labels following a measurement are
+         * local derivatives and those following a sigma are global derivatives.
+         */
+        auto parse_flat_entry(const Binary::RawEntryView& input, FlatEntry& output) -> EnumError<std::size_t>
         {
-            assert(chunk_ptr.entrypoint != nullptr);
-            return (++(chunk_ptr.iter) != chunk_ptr.end) ? std::optional{ chunk_ptr } : std::nullopt;
+            output.clear();
+            if (input.labels.empty() or input.labels.front() != 0U)
+            {
+                return std::unexpected{ ErrorCode::reader_file_fail_to_read };
+            }
+            auto stage = ParseStage::begin;
+            for (const auto [label, value] : svs::zip(input.labels, input.values) | svs::drop(1))
+            {
+                if (label == 0U)
+                {
+                    if (stage == ParseStage::locals)
+                    {
+                        output.set_sigma(value);
+                        stage = ParseStage::globals;
+                    }
+                    else
+                    {
+                        output.add_point(value);
+                        stage = ParseStage::locals;
+                    }
+                }
+                else if (stage == ParseStage::locals)
+                {
+                    output.add_local(label - 1U, value);
+                }
+                else if (stage == ParseStage::globals)
+                {
+                    output.add_global(label - 1U, value);
+                }
+                else
+                {
+                    return std::unexpected{ ErrorCode::reader_file_fail_to_read };
+                }
+            }
+            if (stage != ParseStage::globals)
+            {
+                return std::unexpected{ ErrorCode::reader_file_fail_to_read };
+            }
+            return output.size();
         }
+    } // namespace
 
-        auto chunk_handle_measurement(auto chunk_ptr)
+    auto Binary::init() -> EnumError<>
+    {
+        if (config_.in_filename.empty())
         {
-            assert(chunk_ptr.entrypoint != nullptr);
-            (chunk_ptr.entrypoint)->set_measurement(std::get<1>(*(*(chunk_ptr.iter)).begin()));
-            return chunk_ptr;
+            return std::unexpected{ ErrorCode::reader_invalid_filename };
         }
-
-        auto chunk_handle_globals(auto chunk_ptr)
+        entry_buffer_.resize(config_.max_bufferpoint_size);
+        if (config_.use_memory_map)
         {
-            assert(chunk_ptr.entrypoint != nullptr);
-            for (const auto& global : *(chunk_ptr.iter))
+            if (auto result = mapped_file_.open(config_.in_filename); !result)
             {
-                chunk_ptr.entrypoint->add_global(std::get<0>(global), std::get<1>(global));
+                return std::unexpected{ result.error() };
             }
-            return chunk_ptr;
+            mapped_offset_ = 0Z;
         }
+        else
+        {
+            raw_entry_buffer_.first.reserve(config_.max_bufferpoint_size);
+            raw_entry_buffer_.second.reserve(config_.max_bufferpoint_size);
+            input_file_.open(config_.in_filename, std::ios::binary | std::ios::in);
+            if (!input_file_.is_open())
+            {
+                return std::unexpected{ ErrorCode::reader_file_fail_to_open };
+            }
+        }
+        if (auto result = read_header(); !result)
+        {
+            return std::unexpected{ result.error() };
+        }
+        n_entries_ = 0Z;
+        end_of_file_ = false;
+        n_remaining_entries_.reset();
+        return {};
+    }
 
-        auto chunk_handle_sigma(auto chunk_ptr)
+    auto Binary::init_range(std::size_t entry_begin, std::size_t entry_end) -> EnumError<>
+    {
+        if (auto result = init(); !result)
+        {
+            return std::unexpected{ result.error() };
+        }
+        auto index = common::EntryIndex{};
+        if (auto result = index.read(common::EntryIndex::get_filename(config_.in_filename)); !result)
         {
-            assert(chunk_ptr.entrypoint != nullptr);
-            chunk_ptr.entrypoint->set_sigma(std::get<1>(*(*(chunk_ptr.iter)).begin()));
-            return chunk_ptr;
+            return std::unexpected{ result.error() };
+        }
+        if (entry_begin > entry_end)
+        {
+            return std::unexpected{ ErrorCode::reader_invalid_index };
         }
+        entry_end = std::min(entry_end, static_cast<std::size_t>(index.get_n_entries()));
+        entry_begin = std::min(entry_begin, entry_end);
 
-        auto chunk_handle_locals(auto chunk_ptr)
+        auto entry_idx = std::size_t{};
+        if (const auto point = index.find(entry_begin); point.has_value())
+        {
+            if (auto result = seek(static_cast<std::size_t>(point->offset)); !result)
+            {
+                return std::unexpected{ result.error() };
+            }
+            entry_idx = static_cast<std::size_t>(point->entry_idx);
+        }
+        for (; entry_idx < entry_begin; ++entry_idx)
         {
-            assert(chunk_ptr.entrypoint != nullptr);
-            for (const auto& local : *(chunk_ptr.iter) | svs::values)
+            if (auto n_pairs = read_raw_entry(); not n_pairs or n_pairs.value() == 0U)
             {
-                chunk_ptr.entrypoint->add_local(local);
+                return std::unexpected{ ErrorCode::reader_invalid_index };
             }
-            return chunk_ptr;
         }
+        n_remaining_entries_ = entry_end - entry_begin;
+        return {};
+    }
 
-        auto chunk_end_after_increment(auto chunk_ptr)
+    auto Binary::seek(std::size_t offset) -> EnumError<>
+    {
+        if (config_.use_memory_map)
+        {
+            if (offset > mapped_file_.get_data().size())
+            {
+                return std::unexpected{ ErrorCode::reader_invalid_index };
+            }
+            mapped_offset_ = offset;
+        }
+        else
         {
-            assert(chunk_ptr.entrypoint != nullptr);
-            return (++(chunk_ptr.iter) == chunk_ptr.end) ? std::optional{ chunk_ptr } : std::nullopt;
+            input_file_.clear();
+            input_file_.seekg(static_cast<std::streamoff>(offset));
         }
+        block_buffer_.clear();
+        block_offset_ = 0Z;
+        return {};
+    }
 
-        auto parse_entry_points(const Binary::RawBufferType& input, Binary::BufferType& output)
-            -> EnumError<std::size_t>
+    auto Binary::read_header() -> EnumError<>
+    {
+        namespace cf = common::compressed_file;
+        auto header = std::array<uint32_t, cf::HEADER_SIZE / sizeof(uint32_t)>{};
+        is_compressed_ = false;
+        block_buffer_.clear();
+        block_offset_ = 0Z;
+        if (config_.use_memory_map)
         {
-            if (input.first.at(0) != 0U)
+            const auto data = mapped_file_.get_data();
+            if (data.size() < sizeof(header[0]))
             {
-                return std::unexpected{ ErrorCode::reader_file_fail_to_read };
+                return {};
             }
-            constexpr auto chunk_size{ 4 };
-            auto current_n_points = std::size_t{};
-            auto zipped = svs::zip(input.first, input.second) | svs::drop(1) |
-                          svs::chunk_by([](const auto& current, const auto& next) -> auto
-                                        { return std::get<0>(current) != 0U and std::get<0>(next) != 0U; });
-            if (zipped.begin() == zipped.end())
+            std::memcpy(header.data(), data.data(), sizeof(header[0]));
+            if (header[0] != cf::MAGIC)
+            {
+                return {};
+            }
+            if (data.size() < cf::HEADER_SIZE)
             {
                 return std::unexpected{ ErrorCode::reader_file_fail_to_read };
             }
-            // TODO: Use chunk_view after libc++ supports it.
-            auto chunks =
-                svs::zip(svs::iota(0), zipped) |
-                svs::chunk_by([](const auto& current, const auto& next) -> auto
-                              { return std::get<0>(current) / chunk_size == std::get<0>(next) / chunk_size; }) |
-                svs::transform([](auto&& chunk) -> auto { return chunk | svs::values; });
-
-            auto is_ok = srs::all_of(svs::zip_transform(
-                                         [&current_n_points](auto&& chunk, auto&& entrypoint) -> bool
-                                         {
-                                             auto chunk_ptr = ChunkPointer{
-                                                 .iter = chunk.begin(),
-                                                 .end = chunk.end(),
-                                                 .entrypoint = &entrypoint,
-                                             };
-                                             using ChunkPtrType = decltype(chunk_ptr);
-                                             return chunk_check_size_one(chunk_ptr)
-                                                 .transform(chunk_handle_measurement<ChunkPtrType>)
-                                                 .and_then(chunk_not_end_and_increment<ChunkPtrType>)
-                                                 .transform(chunk_handle_globals<ChunkPtrType>)
-                                                 .and_then(chunk_not_end_and_increment<ChunkPtrType>)
-                                                 .and_then(chunk_check_size_one<ChunkPtrType>)
-                                                 .transform(chunk_handle_sigma<ChunkPtrType>)
-                                                 .and_then(chunk_not_end_and_increment<ChunkPtrType>)
-                                                 .transform(chunk_handle_locals<ChunkPtrType>)
-                                                 .and_then(chunk_end_after_increment<ChunkPtrType>)
-                                                 .transform(
-                                                     [&current_n_points](auto)
-                                                     {
-                                                         ++current_n_points;
-                                                         return true;
-                                                     })
-                                                 .has_value();
-                                         },
-                                         chunks,
-                                         output),
-                                     std::identity{});
-            if (not is_ok)
+            std::memcpy(header.data(), data.data(), cf::HEADER_SIZE);
+            mapped_offset_ = cf::HEADER_SIZE;
+        }
+        else
+        {
+            if (auto result = read_from_file(input_file_, header[0]); !result or header[0] != cf::MAGIC)
+            {
+                // Not a compressed file. Rewind to read the records from the beginning.
+                input_file_.clear();
+                input_file_.seekg(0);
+                return {};
+            }
+            if (not read_from_file(input_file_, header[1]) or not read_from_file(input_file_, header[2]))
             {
                 return std::unexpected{ ErrorCode::reader_file_fail_to_read };
             }
-            return current_n_points;
         }
-    } // namespace
-
-    auto Binary::init() -> EnumError<>
-    {
-        if (config_.in_filename.empty())
+        if (header[1] != cf::VERSION or header[2] != static_cast<uint32_t>(common::Compression::zstd))
         {
-            return std::unexpected{ ErrorCode::reader_invalid_filename };
+            return std::unexpected{ ErrorCode::reader_file_fail_to_decompress };
         }
-        entry_buffer_.resize(config_.max_bufferpoint_size);
-        raw_entry_buffer_.first.reserve(config_.max_bufferpoint_size);
-        raw_entry_buffer_.second.reserve(config_.max_bufferpoint_size);
-        input_file_.open(config_.in_filename, std::ios::binary | std::ios::in);
-        if (!input_file_.is_open())
+        is_compressed_ = true;
+        if (not decompressor_.has_value())
         {
-            return std::unexpected{ ErrorCode::reader_file_fail_to_open };
+            decompressor_.emplace();
         }
-        n_entries_ = 0Z;
-        end_of_file_ = false;
         return {};
     }
 
@@ -201,25 +328,16 @@ namespace centipede::reader
             return std::unexpected{ ErrorCode::reader_uninitialized };
         }
         reset();
-        auto read_size = uint32_t{};
-        if (auto result = read_from_file(input_file_, read_size); !result)
+        auto n_pairs = read_raw_entry();
+        if (not n_pairs or n_pairs.value() == 0U)
         {
-            if (input_file_.eof() and input_file_.gcount() == 0)
-            {
-                end_of_file_ = true;
-                return 0U;
-            }
-            return std::unexpected{ result.error() };
+            return n_pairs;
         }
-        if (auto result = read_entry_to_buffer(read_size); !result)
-        {
-            return std::unexpected{ result.error() };
-        }
-        if (read_size > config_.max_bufferpoint_size)
+        if (const auto read_size = 2U * n_pairs.value(); read_size > entry_buffer_.size())
         {
             entry_buffer_.resize(read_size);
         }
-        auto size = parse_entry_points(raw_entry_buffer_, entry_buffer_);
+        auto size = parse_entry_points(raw_entry_view_, entry_buffer_);
         if (not size)
         {
             return std::unexpected{ size.error() };
@@ -229,14 +347,80 @@ namespace centipede::reader
         return size.value();
     }
 
+    auto Binary::read_one_raw_entry() -> EnumError<std::size_t>
+    {
+        if (entry_buffer_.empty())
+        {
+            return std::unexpected{ ErrorCode::reader_uninitialized };
+        }
+        size_ = 0U;
+        auto n_pairs = read_raw_entry();
+        if (n_pairs and n_pairs.value() != 0U)
+        {
+            ++n_entries_;
+        }
+        return n_pairs;
+    }
+
+    auto Binary::read_one_flat_entry() -> EnumError<std::size_t>
+    {
+        if (entry_buffer_.empty())
+        {
+            return std::unexpected{ ErrorCode::reader_uninitialized };
+        }
+        size_ = 0U;
+        flat_entry_.clear();
+        auto n_pairs = read_raw_entry();
+        if (not n_pairs or n_pairs.value() == 0U)
+        {
+            return n_pairs;
+        }
+        auto size = parse_flat_entry(raw_entry_view_, flat_entry_);
+        if (not size)
+        {
+            return std::unexpected{ size.error() };
+        }
+        ++n_entries_;
+        return size.value();
+    }
+
+    auto Binary::read_flat_entries(std::span<FlatEntry> entries) -> EnumError<std::size_t>
+    {
+        if (entry_buffer_.empty())
+        {
+            return std::unexpected{ ErrorCode::reader_uninitialized };
+        }
+        size_ = 0U;
+        flat_entry_.clear();
+        auto n_filled = std::size_t{};
+        for (auto& entry : entries)
+        {
+            entry.clear();
+            auto n_pairs = read_raw_entry();
+            if (not n_pairs)
+            {
+                return std::unexpected{ n_pairs.error() };
+            }
+            if (n_pairs.value() == 0U)
+            {
+                break;
+            }
+            if (auto size = parse_flat_entry(raw_entry_view_, entry); not size)
+            {
+                return std::unexpected{ size.error() };
+            }
+            ++n_entries_;
+            ++n_filled;
+        }
+        return n_filled;
+    }
+
     void Binary::reset()
     {
         for (auto& entrypoint : entry_buffer_)
         {
             entrypoint.reset();
         }
-        raw_entry_buffer_.first.clear();
-        raw_entry_buffer_.second.clear();
         size_ = 0U;
     }
 
@@ -254,4 +438,164 @@ namespace centipede::reader
         }
         return {};
     }
+
+    auto Binary::read_raw_entry() -> EnumError<std::size_t>
+    {
+        raw_entry_buffer_.first.clear();
+        raw_entry_buffer_.second.clear();
+        raw_entry_view_ = RawEntryView{};
+        if (n_remaining_entries_ == 0U)
+        {
+            end_of_file_ = true;
+            return 0U;
+        }
+        auto n_pairs = std::invoke(
+            [this]() -> EnumError<std::size_t>
+            {
+                if (is_compressed_)
+                {
+                    return read_compressed_raw_entry();
+                }
+                return config_.use_memory_map ? read_raw_entry_from(mapped_file_.get_data(), mapped_offset_)
+                                              : read_stream_raw_entry();
+            });
+        if (n_remaining_entries_.has_value() and n_pairs and n_pairs.value() != 0U)
+        {
+            --(*n_remaining_entries_);
+        }
+        return n_pairs;
+    }
+
+    auto Binary::read_stream_raw_entry() -> EnumError<std::size_t>
+    {
+        auto read_size = uint32_t{};
+        if (auto result = read_from_file(input_file_, read_size); !result)
+        {
+            if (input_file_.eof() and input_file_.gcount() == 0)
+            {
+                end_of_file_ = true;
+                return 0U;
+            }
+            return std::unexpected{ result.error() };
+        }
+        if (read_size < 2U)
+        {
+            return std::unexpected{ ErrorCode::reader_file_fail_to_read };
+        }
+        if (auto result = read_entry_to_buffer(read_size); !result)
+        {
+            return std::unexpected{ result.error() };
+        }
+        raw_entry_view_ = RawEntryView{ .labels = raw_entry_buffer_.first, .values = raw_entry_buffer_.second };
+        return raw_entry_buffer_.first.size();
+    }
+
+    auto Binary::read_compressed_raw_entry() -> EnumError<std::size_t>
+    {
+        while (block_offset_ == block_buffer_.size())
+        {
+            auto has_block = load_next_block();
+            if (not has_block)
+            {
+                return std::unexpected{ has_block.error() };
+            }
+            if (not has_block.value())
+            {
+                end_of_file_ = true;
+                return 0U;
+            }
+        }
+        return read_raw_entry_from(block_buffer_, block_offset_);
+    }
+
+    auto Binary::load_next_block() -> EnumError<bool>
+    {
+        auto block_header = std::array<uint32_t, 2>{};
+        auto compressed = std::span<const std::byte>{};
+        if (config_.use_memory_map)
+        {
+            const auto data = mapped_file_.get_data();
+            if (mapped_offset_ == data.size())
+            {
+                return false;
+            }
+            if (data.size() - mapped_offset_ < common::compressed_file::BLOCK_HEADER_SIZE)
+            {
+                return std::unexpected{ ErrorCode::reader_file_fail_to_read };
+            }
+            std::memcpy(block_header.data(), data.subspan(mapped_offset_).data(), sizeof(block_header));
+            mapped_offset_ += sizeof(block_header);
+            if (data.size() - mapped_offset_ < block_header[0])
+            {
+                return std::unexpected{ ErrorCode::reader_file_fail_to_read };
+            }
+            compressed = data.subspan(mapped_offset_, block_header[0]);
+            mapped_offset_ += block_header[0];
+        }
+        else
+        {
+            if (auto result = read_from_file(input_file_, block_header[0]); !result)
+            {
+                if (input_file_.eof() and input_file_.gcount() == 0)
+                {
+                    return false;
+                }
+                return std::unexpected{ result.error() };
+            }
+            if (auto result = read_from_file(input_file_, block_header[1]); !result)
+            {
+                return std::unexpected{ result.error() };
+            }
+            compressed_block_.resize(block_header[0]);
+            // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
+            input_file_.read(reinterpret_cast<char*>(compressed_block_.data()),
+                             static_cast<std::streamsize>(compressed_block_.size()));
+            // NOLINTEND (cppcoreguidelines-pro-type-reinterpret-cast)
+            if (input_file_.gcount() != static_cast<std::streamsize>(compressed_block_.size()))
+            {
+                return std::unexpected{ ErrorCode::reader_file_fail_to_read };
+            }
+            compressed = compressed_block_;
+        }
+        if (auto result = decompressor_->decompress(compressed, block_header[1], block_buffer_); !result)
+        {
+            return std::unexpected{ result.error() };
+        }
+        block_offset_ = 0Z;
+        return true;
+    }
+
+    auto Binary::read_raw_entry_from(std::span<const std::byte> data, std::size_t& offset) -> EnumError<std::size_t>
+    {
+        if (offset == data.size())
+        {
+            end_of_file_ = true;
+            return 0U;
+        }
+        auto read_size = uint32_t{};
+        if (data.size() - offset < sizeof(read_size))
+        {
+            return std::unexpected{ ErrorCode::reader_file_fail_to_read };
+        }
+        std::memcpy(&read_size, data.subspan(offset).data(), sizeof(read_size));
+        const auto n_pairs = std::size_t{ read_size / 2U };
+        const auto n_bytes = n_pairs * (sizeof(float) + sizeof(uint32_t));
+        const auto record = data.subspan(offset + sizeof(read_size));
+        if (n_pairs == 0U or record.size() < n_bytes)
+        {
+            return std::unexpected{ ErrorCode::reader_file_fail_to_read };
+        }
+
+        // Each record consists of 32 bit words only. Thus, all arrays are properly aligned in the page-aligned mapping
+        // or the heap-allocated block buffer, as long as the data begins at a multiple of 4 bytes.
+        // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
+        raw_entry_view_ = RawEntryView{
+            .labels = std::span{ reinterpret_cast<const uint32_t*>(record.subspan(n_pairs * sizeof(float)).data()),
+                                 n_pairs },
+            .values = std::span{ reinterpret_cast<const float*>(record.data()), n_pairs },
+        };
+        // NOLINTEND (cppcoreguidelines-pro-type-reinterpret-cast)
+        offset += sizeof(read_size) + n_bytes;
+        return n_pairs;
+    }
 } // namespace centipede::reader
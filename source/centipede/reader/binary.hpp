@@ -1,14 +1,18 @@
 #pragma once
 
 #include "centipede/data/entry.hpp"
+#include "centipede/data/flat_entry.hpp"
+#include "centipede/util/block_compression.hpp"
 #include "centipede/util/common_definitions.hpp"
 #include "centipede/util/error_types.hpp"
+#include "centipede/util/mapped_file.hpp"
 #include "centipede/util/return_types.hpp"
 #include <cstddef>
 #include <cstdint>
 #include <expected>
 #include <fstream>
 #include <iterator>
+#include <optional>
 #include <span>
 #include <string>
 #include <utility>
@@ -37,6 +41,25 @@ namespace centipede::reader
      * #centipede::reader::Binary::read_one_entry() and
      * #centipede::reader::Binary::get_current_entry() is also supported.
      *
+     * If Config::use_memory_map is true, the whole file is mapped into memory instead of being read via a file
+     * stream. The raw label and value arrays of each entry are then accessible via
+     * #centipede::reader::Binary::get_current_raw_entry() as spans pointing directly into the mapped file, without
+     * any copy. Use #centipede::reader::Binary::read_one_raw_entry() to skip the parsing into entrypoints.
+     *
+     * For the best performance, entries can be parsed into a #centipede::FlatEntry via
+     * #centipede::reader::Binary::read_one_flat_entry() instead, which is done in a single linear scan without any
+     * memory allocation once the buffers are warmed up.
+     *
+     * Files written with compression (see #centipede::writer::Binary::Config::compression) are detected
+     * automatically during #centipede::reader::Binary::init(). Their blocks are decompressed one after another into an
+     * internal buffer, from which the entries are read in the same way as from a memory mapped file. Both the stream
+     * and the memory map modes are supported.
+     *
+     * If the file was written with an index (see #centipede::writer::Binary::Config::index_stride), a range of entries
+     * can be read via #centipede::reader::Binary::init_range(). The reader then jumps to the closest indexed position
+     * before the range and stops after the last entry of the range. Multiple readers can thus consume disjoint ranges
+     * of the same file in parallel threads.
+     *
      * Configuration of the class is done via Binary::Config.
      *
      * #### Example usage
@@ -88,7 +111,20 @@ namespace centipede::reader
         {
             std::string in_filename;                                     //!< Input binary filename.
             uint32_t max_bufferpoint_size = common::DEFAULT_BUFFER_SIZE; //!< maximum bufferpoint for an entry.
+            bool use_memory_map = false;                                 //!< Map the file instead of using a stream.
+        };
+
+        /**
+         * @brief Views to the raw label and value arrays of an entry.
+         *
+         * Both arrays have the same size. The first label-value pair is always (0, 0).
+         */
+        struct RawEntryView
+        {
+            std::span<const uint32_t> labels; //!< Labels of the entry.
+            std::span<const float> values;    //!< Values of the entry.
         };
+
         using RawBufferType = std::pair<std::vector<uint32_t>, std::vector<float>>; //!< Type of #raw_entry_buffer_
         using BufferType = std::vector<EntryPoint<>>;                               //!< Type of #entry_buffer_
 
@@ -115,18 +151,52 @@ namespace centipede::reader
          * The initialization function must be called before calling the #read_one_entry() method. When calling this
          * function, #raw_entry_buffer_ and #entry_buffer_ get resized and a file is opened with the specified name in
          * #Config.
-         * @return Returns ErrorCode::reader_file_fail_to_open if the file cannot be opened with the name specified by
-         * Config::in_filename.
+         * @return
+         * - ErrorCode::reader_file_fail_to_open if the file cannot be opened with the name specified by
+         *   Config::in_filename.
+         * - ErrorCode::reader_file_fail_to_decompress if the file is compressed with an unsupported container version
+         *   or compression algorithm.
          * @see Config
          */
         [[nodiscard]] auto init() -> EnumError<>;
 
+        /**
+         * @brief Initialization for reading a range of entries.
+         *
+         * Same as #init() but only the entries in the range `[entry_begin, entry_end)` are read afterwards. The
+         * position of the first entry is looked up in the index file (see common::EntryIndex::get_filename()). The
+         * range is clamped to the total number of entries in the file.
+         *
+         * #### Example usage
+         *
+         * ```cpp
+         * auto index = centipede::common::EntryIndex{};
+         * auto index_err = index.read(centipede::common::EntryIndex::get_filename("output.bin"));
+         * const auto n_per_thread = (index.get_n_entries() + n_threads - 1) / n_threads;
+         * // In each thread:
+         * auto reader = centipede::reader::Binary{ centipede::reader::Binary::Config{ .in_filename = "output.bin" } };
+         * auto init_err = reader.init_range(thread_idx * n_per_thread, (thread_idx + 1) * n_per_thread);
+         * ```
+         *
+         * @param entry_begin Index of the first entry to read (0-based indexing).
+         * @param entry_end Index after the last entry to read.
+         * @return
+         * - Any error from #init().
+         * - ErrorCode::reader_invalid_index if the index file is missing or corrupted, `entry_begin` is larger than
+         *   `entry_end` or the entries before `entry_begin` cannot be skipped.
+         */
+        [[nodiscard]] auto init_range(std::size_t entry_begin, std::size_t entry_end) -> EnumError<>;
+
         /**
          * @brief Manually close the input file handler.
          *
          * This function will be called automatically when the destructor is called.
          */
-        void close() { input_file_.close(); }
+        void close()
+        {
+            input_file_.close();
+            mapped_file_.close();
+        }
 
         /**
          * @brief Reads one entry from file into the internal buffers.
@@ -135,6 +205,8 @@ namespace centipede::reader
          * 1. if #init() is not called once after instanciating, returns an error
          * 2. Reads one entry to #raw_entry_buffer_, returns if read operation fails.
          * 3. Parses entry and stores individual entrypoints in #entry_buffer_, returns if file format is corrupted.
+         *     The record layout is the same as in #read_one_flat_entry(). Local derivatives are placed at the
+         *     positions of their labels and the missing (zero) ones in between are filled with zeros.
          * 4. Increases #n_entries_ for one entry is read and sets #size_ corresponding to the number of 32 Bit values
          *     (global and local derivs, sigmas and measurements) contained in current entry.
          * 5. returns #size_
@@ -147,6 +219,64 @@ namespace centipede::reader
          */
         [[maybe_unused]] auto read_one_entry() -> EnumError<std::size_t>;
 
+        /**
+         * @brief Reads one entry without parsing it into entrypoints.
+         *
+         * The raw label and value arrays of the entry are accessible via #get_current_raw_entry() afterwards. In the
+         * memory map mode, no data is copied. #get_current_entry() returns an empty span after this call.
+         *
+         * @return
+         * - ErrorCode::reader_uninitialized if #init() is not called before reading
+         * - ErrorCode::reader_file_fail_to_read if the file stream is broken or the entry is truncated.
+         * - ErrorCode::reader_file_fail_to_decompress if a compressed block is corrupted.
+         * - Number of label-value pairs in the entry on success. 0 if the end of file is reached.
+         */
+        [[maybe_unused]] auto read_one_raw_entry() -> EnumError<std::size_t>;
+
+        /**
+         * @brief Reads one entry from file and parses it into a #FlatEntry.
+         *
+         * The record is expected in the layout written by #centipede::writer::Binary: For each entrypoint, the
+         * measurement (label 0) is followed by the local derivatives, the sigma (label 0) and the global derivatives.
+         * The labels of the derivatives are converted to 0-based indices. The parsed entry is accessible via
+         * #get_current_flat_entry() and #get_current_entry() returns an empty span after this call.
+         *
+         * @return
+         * - ErrorCode::reader_uninitialized if #init() is not called before reading
+         * - ErrorCode::reader_file_fail_to_read if the file stream is broken or file format is corrupted.
+         * - Number of entrypoints on success. 0 if the end of file is reached.
+         */
+        [[maybe_unused]] auto read_one_flat_entry() -> EnumError<std::size_t>;
+
+        /**
+         * @brief Reads a batch of entries from file and parses them into #FlatEntry objects.
+         *
+         * The entries are parsed in the same way as #read_one_flat_entry(). The flat entries are overwritten in place,
+         * such that their memory is reused by subsequent batches. The batch can be analyzed with
+         * #centipede::core::engine::Master::analyze(std::span<const FlatEntry>).
+         *
+         * @param entries Flat entries to be filled. At most `entries.size()` entries are read.
+         * @return
+         * - ErrorCode::reader_uninitialized if #init() is not called before reading
+         * - ErrorCode::reader_file_fail_to_read if the file stream is broken or file format is corrupted.
+         * - Number of entries filled on success. Less than `entries.size()` if the end of file is reached.
+         */
+        [[maybe_unused]] auto read_flat_entries(std::span<FlatEntry> entries) -> EnumError<std::size_t>;
+
+        /**
+         * @brief Getter of the entry parsed by #read_one_flat_entry().
+         */
+        [[nodiscard]] auto get_current_flat_entry() const -> const FlatEntry& { return flat_entry_; }
+
+        /**
+         * @brief Getter of the raw label and value arrays of the current entry.
+         *
+         * In the memory map mode, the spans point directly into the mapped file and stay valid until #close() is
+         * called. Otherwise, or if the file is compressed, they point to an internal buffer and are only valid until
+         * the next read.
+         */
+        [[nodiscard]] auto get_current_raw_entry() const -> RawEntryView { return raw_entry_view_; }
+
         /**
          * @brief Getter of #entry_buffer_.
          *
@@ -322,12 +452,30 @@ namespace centipede::reader
         RawBufferType raw_entry_buffer_; //!< A buffer to store raw data coming from file stream.
         Config config_;                  //!< Member variable for the configuration.
         std::ifstream input_file_;       //!< Input file handler
+        common::MappedFile mapped_file_; //!< Memory mapping of the input file in the memory map mode.
+        std::size_t mapped_offset_{};    //!< Byte offset of the next entry (or block) in the mapped file.
+        RawEntryView raw_entry_view_{};  //!< Views to the raw data of the current entry.
+        FlatEntry flat_entry_;           //!< Current entry parsed by #read_one_flat_entry().
         std::size_t size_{};             //!< Number of Entrypoints in the current entry
         std::size_t n_entries_{};        //!< Total number of entries read by this instance
         bool end_of_file_{ false };      //!< Indicates if end of file is reached. Gets updated on read.
         ErrorCode status_{ ErrorCode::invalid };
 
+        bool is_compressed_{ false };                           //!< Whether the file is block-compressed.
+        std::optional<common::BlockDecompressor> decompressor_; //!< Decompressor of the compressed blocks.
+        std::vector<std::byte> compressed_block_;               //!< Compressed block read from the file stream.
+        std::vector<std::byte> block_buffer_;                   //!< Current decompressed block.
+        std::size_t block_offset_{};                            //!< Byte offset of the next entry in the block.
+        std::optional<std::size_t> n_remaining_entries_;        //!< Number of entries left in the range.
+
         void reset();
         auto read_entry_to_buffer(uint32_t read_size) -> EnumError<>;
+        auto read_raw_entry() -> EnumError<std::size_t>;
+        auto read_stream_raw_entry() -> EnumError<std::size_t>;
+        auto read_compressed_raw_entry() -> EnumError<std::size_t>;
+        auto read_raw_entry_from(std::span<const std::byte> data, std::size_t& offset) -> EnumError<std::size_t>;
+        auto read_header() -> EnumError<>;
+        auto load_next_block() -> EnumError<bool>;
+        auto seek(std::size_t offset) -> EnumError<>;
     };
 } // namespace centipede::reader
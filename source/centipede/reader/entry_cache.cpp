@@ -0,0 +1,222 @@
+#include "entry_cache.hpp"
+#include "centipede/data/flat_entry.hpp"
+#include "centipede/util/error_types.hpp"
+#include "centipede/util/return_types.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <filesystem>
+#include <ios>
+#include <span>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+namespace centipede::reader
+{
+    namespace
+    {
+        // A record consists of the numbers of entrypoints, local and global derivatives, followed by the measurements,
+        // sigmas, the ends of the local derivatives of each entrypoint, the local labels and values, the ends of the
+        // global derivatives of each entrypoint and the global labels and values. All fields have 4 bytes, such that
+        // the arrays of a record are aligned.
+        constexpr auto n_record_sizes = 3U;
+
+        template <typename T>
+            requires(std::is_trivially_copyable_v<T> and sizeof(T) == sizeof(uint32_t))
+        void append_bytes(std::vector<std::byte>& buffer, std::span<const T> data)
+        {
+            const auto bytes = std::as_bytes(data);
+            buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+        }
+
+        /**
+         * @brief Take the next array with `size` elements of type `T` from the record bytes.
+         * @return False if the bytes are too short.
+         */
+        template <typename T>
+        auto take_array(std::span<const std::byte>& data, std::size_t size, std::span<const T>& array) -> bool
+        {
+            if (size > data.size() / sizeof(T))
+            {
+                return false;
+            }
+            // NOLINTNEXTLINE (cppcoreguidelines-pro-type-reinterpret-cast)
+            array = std::span{ reinterpret_cast<const T*>(data.data()), size };
+            data = data.subspan(size * sizeof(T));
+            return true;
+        }
+    } // namespace
+
+    EntryCache::EntryCache(Config config)
+        : config_{ std::move(config) }
+    {
+    }
+
+    EntryCache::~EntryCache()
+    {
+        if (is_spilled())
+        {
+            mapped_file_.close();
+            spill_file_.close();
+            auto error = std::error_code{};
+            std::filesystem::remove(config_.spill_filename, error);
+        }
+    }
+
+    auto EntryCache::add(const FlatEntry& entry) -> EnumError<>
+    {
+        if (is_finished_)
+        {
+            return std::unexpected{ ErrorCode::writer_uninitialized };
+        }
+        if (entry.empty())
+        {
+            return {};
+        }
+        write_record(entry);
+        ++n_entries_;
+        if (is_spilled() and buffer_.size() >= config_.spill_buffer_size)
+        {
+            return flush_buffer();
+        }
+        return {};
+    }
+
+    auto EntryCache::add(std::span<const FlatEntry> entries) -> EnumError<>
+    {
+        for (const auto& entry : entries)
+        {
+            if (auto res = add(entry); not res)
+            {
+                return res;
+            }
+        }
+        return {};
+    }
+
+    auto EntryCache::finish() -> EnumError<>
+    {
+        if (is_finished_)
+        {
+            return {};
+        }
+        if (is_spilled())
+        {
+            if (auto res = flush_buffer(); not res)
+            {
+                return res;
+            }
+            spill_file_.close();
+            // An empty cache may not have created the file.
+            if (n_bytes_ != 0)
+            {
+                if (auto res = mapped_file_.open(config_.spill_filename); not res)
+                {
+                    return res;
+                }
+            }
+            buffer_ = {};
+        }
+        is_finished_ = true;
+        return {};
+    }
+
+    auto EntryCache::get_records() const -> std::span<const std::byte>
+    {
+        return is_spilled() ? mapped_file_.get_data() : std::span<const std::byte>{ buffer_ };
+    }
+
+    auto EntryCache::flush_buffer() -> EnumError<>
+    {
+        if (buffer_.empty())
+        {
+            return {};
+        }
+        if (not spill_file_.is_open())
+        {
+            spill_file_.open(config_.spill_filename, std::ios::binary | std::ios::out | std::ios::trunc);
+            if (not spill_file_.is_open())
+            {
+                return std::unexpected{ ErrorCode::writer_file_fail_to_open };
+            }
+        }
+        // NOLINTNEXTLINE (cppcoreguidelines-pro-type-reinterpret-cast)
+        spill_file_.write(reinterpret_cast<const char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()));
+        if (not spill_file_.good())
+        {
+            return std::unexpected{ ErrorCode::writer_file_fail_to_open };
+        }
+        buffer_.clear();
+        return {};
+    }
+
+    void EntryCache::write_record(const FlatEntry& entry)
+    {
+        const auto old_size = buffer_.size();
+        const auto sizes = std::array{ static_cast<uint32_t>(entry.size()),
+                                       static_cast<uint32_t>(entry.get_local_labels().size()),
+                                       static_cast<uint32_t>(entry.get_global_labels().size()) };
+        append_bytes(buffer_, std::span<const uint32_t>{ sizes });
+        append_bytes(buffer_, entry.get_measurements());
+        append_bytes(buffer_, entry.get_sigmas());
+        append_bytes(buffer_, entry.get_local_offsets().subspan(1));
+        append_bytes(buffer_, entry.get_local_labels());
+        append_bytes(buffer_, entry.get_local_values());
+        append_bytes(buffer_, entry.get_global_offsets().subspan(1));
+        append_bytes(buffer_, entry.get_global_labels());
+        append_bytes(buffer_, entry.get_global_values());
+        n_bytes_ += buffer_.size() - old_size;
+    }
+
+    auto EntryCache::read_record(std::span<const std::byte>& records, FlatEntry& entry) -> bool
+    {
+        auto sizes = std::span<const uint32_t>{};
+        auto measurements = std::span<const float>{};
+        auto sigmas = std::span<const float>{};
+        auto local_ends = std::span<const uint32_t>{};
+        auto local_labels = std::span<const uint32_t>{};
+        auto local_values = std::span<const float>{};
+        auto global_ends = std::span<const uint32_t>{};
+        auto global_labels = std::span<const uint32_t>{};
+        auto global_values = std::span<const float>{};
+        if (not take_array(records, n_record_sizes, sizes))
+        {
+            return false;
+        }
+        const auto n_points = std::size_t{ sizes[0] };
+        const auto n_local_derivs = std::size_t{ sizes[1] };
+        const auto n_global_derivs = std::size_t{ sizes[2] };
+        if (not take_array(records, n_points, measurements) or not take_array(records, n_points, sigmas) or
+            not take_array(records, n_points, local_ends) or not take_array(records, n_local_derivs, local_labels) or
+            not take_array(records, n_local_derivs, local_values) or not take_array(records, n_points, global_ends) or
+            not take_array(records, n_global_derivs, global_labels) or
+            not take_array(records, n_global_derivs, global_values))
+        {
+            return false;
+        }
+
+        entry.clear();
+        auto local_idx = std::size_t{};
+        auto global_idx = std::size_t{};
+        for (auto point_idx = std::size_t{}; point_idx < n_points; ++point_idx)
+        {
+            if (local_ends[point_idx] > n_local_derivs or global_ends[point_idx] > n_global_derivs)
+            {
+                return false;
+            }
+            entry.add_point(measurements[point_idx], sigmas[point_idx]);
+            for (; local_idx < local_ends[point_idx]; ++local_idx)
+            {
+                entry.add_local(local_labels[local_idx], local_values[local_idx]);
+            }
+            for (; global_idx < global_ends[point_idx]; ++global_idx)
+            {
+                entry.add_global(global_labels[global_idx], global_values[global_idx]);
+            }
+        }
+        return true;
+    }
+} // namespace centipede::reader
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "centipede/data/flat_entry.hpp"
+#include "centipede/util/error_types.hpp"
+#include "centipede/util/mapped_file.hpp"
+#include "centipede/util/return_types.hpp"
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <fstream>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace centipede::reader
+{
+    /**
+     * @class EntryCache
+     * @brief Cache of parsed flat entries, replayed in later passes over the same data.
+     *
+     * Iterative alignments analyze the same entries in every iteration (see core::IterationDriver). The entries are
+     * added to the cache in the first pass, such that later passes don't read and parse the original binary files
+     * again. Each entry is stored as a compact record of its flat arrays, either in memory or in a spill file if the
+     * entries don't fit into memory. The records of the spill file are buffered while they're added and the file is
+     * mapped into memory by #finish(). The spill file is removed when the cache is destroyed.
+     *
+     * #### Example usage
+     *
+     * ```cpp
+     * auto cache = centipede::reader::EntryCache{ { .spill_filename = "entries.cache" } };
+     * while (auto batch = input.next_batch())
+     * {
+     *     auto add_err = cache.add(batch->get_entries());
+     *     input.recycle(std::move(batch.value()));
+     * }
+     * auto finish_err = cache.finish();
+     * auto replay_err = cache.for_each_batch([&master](std::span<const centipede::FlatEntry> entries)
+     *                                        { return master.analyze(entries); });
+     * ```
+     */
+    class EntryCache
+    {
+      public:
+        /**
+         * @brief Configuration of the cache.
+         */
+        struct Config
+        {
+            std::string spill_filename{};                //!< File of the records. Empty to keep them in memory.
+            std::size_t batch_size = 256;                //!< Maximal number of entries in a replayed batch.
+            std::size_t spill_buffer_size = 1UL << 20UL; //!< Bytes buffered before they're written to the file.
+        };
+
+        explicit EntryCache(Config config);
+
+        /**
+         * @brief Destructor. The spill file is removed.
+         */
+        ~EntryCache();
+
+        EntryCache(const EntryCache&) = delete;
+        EntryCache(EntryCache&&) = delete;
+        auto operator=(const EntryCache&) -> EntryCache& = delete;
+        auto operator=(EntryCache&&) -> EntryCache& = delete;
+
+        /**
+         * @brief Add an entry to the cache. Empty entries are ignored.
+         * @return #centipede::ErrorCode::writer_file_fail_to_open if the spill file cannot be written.
+         * #centipede::ErrorCode::writer_uninitialized if #finish() has been called already.
+         */
+        [[nodiscard]] auto add(const FlatEntry& entry) -> EnumError<>;
+
+        /**
+         * @brief Add a batch of entries to the cache. See #add(const FlatEntry&).
+         */
+        [[nodiscard]] auto add(std::span<const FlatEntry> entries) -> EnumError<>;
+
+        /**
+         * @brief Finish adding entries, such that the cache can be replayed.
+         *
+         * With a spill file, the buffered records are written and the file is mapped into memory.
+         * @return #centipede::ErrorCode::writer_file_fail_to_open if the spill file cannot be written.
+         * Any error from common::MappedFile::open().
+         */
+        [[nodiscard]] auto finish() -> EnumError<>;
+
+        /**
+         * @brief Replay all cached entries in batches.
+         *
+         * The entries of a batch are only valid during the call of the function, since the memory of the batch is
+         * reused for the next one.
+         * @param func Function taking the entries of a batch as `std::span<const FlatEntry>` and returning an
+         * `EnumError<>`. The replay stops at the first error, which is returned.
+         * @return #centipede::ErrorCode::reader_uninitialized if #finish() hasn't been called.
+         * #centipede::ErrorCode::reader_file_fail_to_read if a record is truncated.
+         */
+        template <typename Func>
+            requires std::same_as<std::invoke_result_t<Func&, std::span<const FlatEntry>>, EnumError<>>
+        auto for_each_batch(Func&& func) -> EnumError<>
+        {
+            if (not is_finished_)
+            {
+                return std::unexpected{ ErrorCode::reader_uninitialized };
+            }
+            auto records = get_records();
+            batch_.resize(std::max<std::size_t>(config_.batch_size, 1));
+            while (not records.empty())
+            {
+                auto n_entries = std::size_t{};
+                while (n_entries < batch_.size() and not records.empty())
+                {
+                    if (not read_record(records, batch_[n_entries]))
+                    {
+                        return std::unexpected{ ErrorCode::reader_file_fail_to_read };
+                    }
+                    ++n_entries;
+                }
+                if (auto res = func(std::span<const FlatEntry>{ batch_ }.first(n_entries)); not res)
+                {
+                    return res;
+                }
+            }
+            return {};
+        }
+
+        [[nodiscard]] auto get_n_entries() const -> uint64_t { return n_entries_; }
+        [[nodiscard]] auto get_n_bytes() const -> uint64_t { return n_bytes_; }
+        [[nodiscard]] auto is_finished() const -> bool { return is_finished_; }
+
+      private:
+        Config config_;
+        std::vector<std::byte> buffer_; //!< All records in memory, or the records not yet written to the file.
+        std::ofstream spill_file_;
+        common::MappedFile mapped_file_;
+        std::vector<FlatEntry> batch_; //!< Replayed entries, whose memory is reused.
+        uint64_t n_entries_ = 0;
+        uint64_t n_bytes_ = 0; //!< Total size of the records.
+        bool is_finished_ = false;
+
+        [[nodiscard]] auto is_spilled() const -> bool { return not config_.spill_filename.empty(); }
+        [[nodiscard]] auto get_records() const -> std::span<const std::byte>;
+        [[nodiscard]] auto flush_buffer() -> EnumError<>;
+        void write_record(const FlatEntry& entry);
+
+        /**
+         * @brief Read the next record and remove it from the records.
+         * @return False if the record is truncated.
+         */
+        static auto read_record(std::span<const std::byte>& records, FlatEntry& entry) -> bool;
+    };
+} // namespace centipede::reader
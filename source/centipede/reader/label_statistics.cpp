@@ -0,0 +1,155 @@
+#include "label_statistics.hpp"
+#include "centipede/reader/binary.hpp"
+#include "centipede/util/entry_index.hpp"
+#include "centipede/util/error_types.hpp"
+#include "centipede/util/label_map.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace centipede::reader
+{
+    namespace
+    {
+        struct PartialStatistics
+        {
+            LabelStatistics::Counts counts;
+            uint64_t n_entries = 0;
+        };
+
+        /**
+         * @brief Count the global labels of a raw entry.
+         *
+         * As in the parsing of the entry, each label 0 toggles between a measurement and a sigma value. The non-zero
+         * labels following a sigma are global labels (1-based indexing).
+         */
+        void count_global_labels(const Binary::RawEntryView& entry, LabelStatistics::Counts& counts)
+        {
+            auto is_next_zero_sigma = false;
+            auto is_global = false;
+            for (const auto label : entry.labels | std::views::drop(1))
+            {
+                if (label == 0U)
+                {
+                    is_global = is_next_zero_sigma;
+                    is_next_zero_sigma = not is_next_zero_sigma;
+                }
+                else if (is_global)
+                {
+                    ++counts[label - 1U];
+                }
+            }
+        }
+
+        /**
+         * @brief Scan a file or a range `[entry_begin, entry_end)` of its entries.
+         */
+        auto scan_entries(Binary::Config config, std::optional<std::pair<std::size_t, std::size_t>> entry_range)
+            -> EnumError<PartialStatistics>
+        {
+            auto reader = Binary{ std::move(config) };
+            auto init_res = entry_range.has_value() ? reader.init_range(entry_range->first, entry_range->second)
+                                                    : reader.init();
+            if (not init_res)
+            {
+                return std::unexpected{ init_res.error() };
+            }
+            auto statistics = PartialStatistics{};
+            while (true)
+            {
+                auto n_pairs = reader.read_one_raw_entry();
+                if (not n_pairs)
+                {
+                    return std::unexpected{ n_pairs.error() };
+                }
+                if (n_pairs.value() == 0U)
+                {
+                    break;
+                }
+                count_global_labels(reader.get_current_raw_entry(), statistics.counts);
+            }
+            statistics.n_entries = reader.get_n_entries();
+            return statistics;
+        }
+    } // namespace
+
+    auto LabelStatistics::scan(const std::string& filename, const Config& config) -> EnumError<>
+    {
+        const auto reader_config = Binary::Config{ .in_filename = filename, .use_memory_map = config.use_memory_map };
+        const auto n_threads =
+            (config.n_threads == 0) ? std::max(std::size_t{ std::thread::hardware_concurrency() }, std::size_t{ 1 })
+                                    : config.n_threads;
+
+        auto index = common::EntryIndex{};
+        auto results = std::vector<EnumError<PartialStatistics>>{};
+        if (n_threads > 1 and index.read(common::EntryIndex::get_filename(filename)).has_value())
+        {
+            const auto n_entries = static_cast<std::size_t>(index.get_n_entries());
+            const auto n_entries_per_thread = (n_entries + n_threads - 1) / n_threads;
+            results.resize(n_threads);
+            {
+                auto workers = std::vector<std::jthread>{};
+                workers.reserve(n_threads);
+                for (const auto thread_idx : std::views::iota(std::size_t{}, n_threads))
+                {
+                    workers.emplace_back(
+                        [&, thread_idx]()
+                        {
+                            const auto entry_begin = thread_idx * n_entries_per_thread;
+                            results[thread_idx] = scan_entries(
+                                reader_config, std::pair{ entry_begin, entry_begin + n_entries_per_thread });
+                        });
+                }
+            }
+        }
+        else
+        {
+            results.push_back(scan_entries(reader_config, std::nullopt));
+        }
+
+        for (auto& result : results)
+        {
+            if (not result)
+            {
+                return std::unexpected{ result.error() };
+            }
+        }
+        for (auto& result : results)
+        {
+            for (const auto [label, count] : result->counts)
+            {
+                counts_[label] += count;
+            }
+            n_entries_ += result->n_entries;
+        }
+        return {};
+    }
+
+    auto LabelStatistics::make_label_map(uint64_t min_count) const -> common::LabelMap
+    {
+        auto label_map = common::LabelMap{};
+        label_map.reserve(counts_.size());
+        for (const auto [label, count] : counts_)
+        {
+            if (count >= min_count)
+            {
+                label_map.insert(label);
+            }
+        }
+        label_map.sort();
+        return label_map;
+    }
+
+    auto LabelStatistics::get_count(uint32_t label) const -> uint64_t
+    {
+        const auto iter = counts_.find(label);
+        return (iter == counts_.end()) ? 0 : iter->second;
+    }
+} // namespace centipede::reader
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "centipede/util/label_map.hpp"
+#include "centipede/util/return_types.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace centipede::reader
+{
+    /**
+     * @class LabelStatistics
+     * @brief Number of measurements of each global label in binary files.
+     *
+     * The statistics are collected in a pre-pass over the data, which only scans the raw label arrays of the entries
+     * (see Binary::read_one_raw_entry()) without parsing them. Only the used labels are stored, such that the memory
+     * doesn't depend on the largest label. If the file has an index (see writer::Binary::Config::index_stride), the
+     * file is split into entry ranges which are scanned in parallel threads.
+     *
+     * Global parameters with too few measurements are poorly constrained and make the global system (nearly)
+     * singular. #make_label_map() creates a label map only containing the labels with enough measurements, which can
+     * be given to the master engine (see core::engine::Master::Config::label_map and
+     * core::engine::Master::Config::is_label_map_fixed) to skip the derivatives of all other labels.
+     *
+     * #### Example usage
+     *
+     * ```cpp
+     * auto statistics = centipede::reader::LabelStatistics{};
+     * auto scan_err = statistics.scan("output.bin", { .n_threads = 0 });
+     * auto label_map = statistics.make_label_map(10);
+     * ```
+     */
+    class LabelStatistics
+    {
+      public:
+        /**
+         * @brief Configuration of the scan.
+         */
+        struct Config
+        {
+            std::size_t n_threads = 1;  //!< Number of threads. 0 to use all hardware threads.
+            bool use_memory_map = true; //!< Map the file instead of using a stream. See Binary::Config.
+        };
+
+        using Counts = std::unordered_map<uint32_t, uint64_t>; //!< Number of measurements of each global label.
+
+        /**
+         * @brief Count the global labels of all entries in a binary file.
+         *
+         * The counts are added to the counts of previous scans, such that multiple files can be scanned. If the file
+         * has no index, it's scanned in a single thread.
+         * @return Any error from Binary::init() or Binary::read_one_raw_entry().
+         */
+        [[nodiscard]] auto scan(const std::string& filename, const Config& config = {}) -> EnumError<>;
+
+        /**
+         * @brief Create a label map of the labels with at least `min_count` measurements.
+         *
+         * The dense indices of the map follow the ascending order of the labels.
+         */
+        [[nodiscard]] auto make_label_map(uint64_t min_count) const -> common::LabelMap;
+
+        /**
+         * @brief Getter of the number of measurements of a global label.
+         */
+        [[nodiscard]] auto get_count(uint32_t label) const -> uint64_t;
+
+        [[nodiscard]] auto get_counts() const -> const Counts& { return counts_; }
+        [[nodiscard]] auto get_n_entries() const -> uint64_t { return n_entries_; }
+
+        void clear()
+        {
+            counts_.clear();
+            n_entries_ = 0;
+        }
+
+      private:
+        Counts counts_;
+        uint64_t n_entries_ = 0; //!< Total number of entries scanned.
+    };
+} // namespace centipede::reader
@@ -0,0 +1,234 @@
+#include "multi_file.hpp"
+#include "centipede/reader/binary.hpp"
+#include "centipede/util/error_types.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace centipede::reader
+{
+    namespace
+    {
+        constexpr auto default_n_queued_batches_per_thread = std::size_t{ 2 };
+
+        auto get_n_threads(const MultiFile::Config& config) -> std::size_t
+        {
+            const auto n_threads = (config.n_threads == 0) ? std::size_t{ std::thread::hardware_concurrency() }
+                                                           : config.n_threads;
+            return std::clamp(n_threads, std::size_t{ 1 }, std::max(config.in_filenames.size(), std::size_t{ 1 }));
+        }
+
+        auto get_queue_capacity(const MultiFile::Config& config) -> std::size_t
+        {
+            if (config.max_n_queued_batches != 0)
+            {
+                return config.max_n_queued_batches;
+            }
+            return get_n_threads(config) * default_n_queued_batches_per_thread;
+        }
+
+        /**
+         * @brief Match a name against a pattern with the wildcards `*` (any sequence) and `?` (any character).
+         */
+        auto match_wildcard(std::string_view name, std::string_view pattern) -> bool
+        {
+            auto name_idx = std::size_t{};
+            auto pattern_idx = std::size_t{};
+            auto star_idx = std::string_view::npos;
+            auto star_name_idx = std::size_t{};
+            while (name_idx < name.size())
+            {
+                if (pattern_idx < pattern.size() and
+                    (pattern[pattern_idx] == '?' or pattern[pattern_idx] == name[name_idx]))
+                {
+                    ++name_idx;
+                    ++pattern_idx;
+                }
+                else if (pattern_idx < pattern.size() and pattern[pattern_idx] == '*')
+                {
+                    star_idx = pattern_idx++;
+                    star_name_idx = name_idx;
+                }
+                else if (star_idx != std::string_view::npos)
+                {
+                    pattern_idx = star_idx + 1;
+                    name_idx = ++star_name_idx;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+            return std::ranges::all_of(pattern.substr(pattern_idx), [](char letter) { return letter == '*'; });
+        }
+    } // namespace
+
+    MultiFile::MultiFile(Config config)
+        : config_{ std::move(config) }
+        , batch_queue_{ get_queue_capacity(config_) }
+    {
+    }
+
+    MultiFile::~MultiFile()
+    {
+        batch_queue_.close();
+        workers_.clear();
+    }
+
+    auto MultiFile::start() -> EnumError<>
+    {
+        if (config_.in_filenames.empty())
+        {
+            return std::unexpected{ ErrorCode::reader_invalid_filename };
+        }
+        const auto n_threads = get_n_threads(config_);
+        n_running_threads_ = n_threads;
+        workers_.reserve(n_threads);
+        for (std::size_t idx = 0; idx < n_threads; ++idx)
+        {
+            workers_.emplace_back([this]() { run(); });
+        }
+        return {};
+    }
+
+    auto MultiFile::next_batch() -> std::optional<Batch> { return batch_queue_.pop(); }
+
+    void MultiFile::recycle(Batch batch)
+    {
+        batch.n_entries = 0;
+        auto lock = std::scoped_lock{ recycle_mutex_ };
+        recycled_batches_.push_back(std::move(batch));
+    }
+
+    auto MultiFile::find_files(const std::string& pattern) -> EnumError<std::vector<std::string>>
+    {
+        namespace fs = std::filesystem;
+        const auto pattern_path = fs::path{ pattern };
+        const auto directory = pattern_path.has_parent_path() ? pattern_path.parent_path() : fs::path{ "." };
+        const auto filename_pattern = pattern_path.filename().string();
+
+        auto error = std::error_code{};
+        auto iter = fs::directory_iterator{ directory, error };
+        if (error)
+        {
+            return std::unexpected{ ErrorCode::reader_file_fail_to_open };
+        }
+        auto filenames = std::vector<std::string>{};
+        for (; iter != fs::directory_iterator{}; iter.increment(error))
+        {
+            if (error)
+            {
+                return std::unexpected{ ErrorCode::reader_file_fail_to_open };
+            }
+            if (iter->is_regular_file(error) and match_wildcard(iter->path().filename().string(), filename_pattern))
+            {
+                filenames.push_back((pattern_path.has_parent_path() ? iter->path() : iter->path().filename()).string());
+            }
+        }
+        std::ranges::sort(filenames);
+        return filenames;
+    }
+
+    auto MultiFile::select_shard(std::span<const std::string> filenames, std::size_t shard_idx, std::size_t n_shards)
+        -> EnumError<std::vector<std::string>>
+    {
+        if (shard_idx >= n_shards)
+        {
+            return std::unexpected{ ErrorCode::reader_invalid_filename };
+        }
+        auto shard_filenames = std::vector<std::string>{};
+        for (auto file_idx = shard_idx; file_idx < filenames.size(); file_idx += n_shards)
+        {
+            shard_filenames.push_back(filenames[file_idx]);
+        }
+        return shard_filenames;
+    }
+
+    auto MultiFile::get_status() const -> ErrorCode
+    {
+        auto lock = std::scoped_lock{ status_mutex_ };
+        return status_;
+    }
+
+    auto MultiFile::read_file(const std::string& filename) -> EnumError<>
+    {
+        auto reader = Binary{ Binary::Config{ .in_filename = filename, .use_memory_map = config_.use_memory_map } };
+        if (auto result = reader.init(); not result)
+        {
+            return result;
+        }
+        while (not has_error())
+        {
+            auto batch = acquire_batch();
+            auto n_entries = reader.read_flat_entries(batch.entries);
+            if (not n_entries)
+            {
+                return std::unexpected{ n_entries.error() };
+            }
+            batch.n_entries = n_entries.value();
+            if (batch.n_entries == 0)
+            {
+                recycle(std::move(batch));
+                break;
+            }
+            n_entries_ += batch.n_entries;
+            const auto is_last_batch = batch.n_entries < batch.entries.size();
+            if (not batch_queue_.push(std::move(batch)) or is_last_batch)
+            {
+                break;
+            }
+        }
+        return {};
+    }
+
+    auto MultiFile::acquire_batch() -> Batch
+    {
+        auto batch = Batch{};
+        {
+            auto lock = std::scoped_lock{ recycle_mutex_ };
+            if (not recycled_batches_.empty())
+            {
+                batch = std::move(recycled_batches_.back());
+                recycled_batches_.pop_back();
+            }
+        }
+        batch.entries.resize(std::max(config_.batch_size, std::size_t{ 1 }));
+        return batch;
+    }
+
+    void MultiFile::set_error(ErrorCode error)
+    {
+        auto lock = std::scoped_lock{ status_mutex_ };
+        if (status_ == ErrorCode::success)
+        {
+            status_ = error;
+        }
+    }
+
+    void MultiFile::run()
+    {
+        for (auto file_idx = next_file_idx_++; file_idx < config_.in_filenames.size() and not has_error();
+             file_idx = next_file_idx_++)
+        {
+            if (auto result = read_file(config_.in_filenames[file_idx]); not result)
+            {
+                set_error(result.error());
+            }
+        }
+        // The last reader thread closes the queue, such that the consumer stops after the queued batches.
+        if (--n_running_threads_ == 0)
+        {
+            batch_queue_.close();
+        }
+    }
+} // namespace centipede::reader
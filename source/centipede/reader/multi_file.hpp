@@ -0,0 +1,173 @@
+#pragma once
+
+#include "centipede/data/flat_entry.hpp"
+#include "centipede/util/bounded_queue.hpp"
+#include "centipede/util/error_types.hpp"
+#include "centipede/util/return_types.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace centipede::reader
+{
+    /**
+     * @class MultiFile
+     * @brief Reader front-end reading many binary files concurrently.
+     *
+     * Each reader thread takes the next unread file from the file list and reads its entries into batches of flat
+     * entries (see Binary::read_flat_entries()), which are pushed to a bounded queue. The queue capacity sets how
+     * many batches are prefetched while the consumer is busy. The consumer pops the batches via #next_batch() and
+     * gives them back via #recycle() after the analysis, such that the memory of the flat entries is reused.
+     *
+     * Together with a master engine with multiple slaves, reading the files, the local fits and the global updates
+     * then overlap in different threads.
+     *
+     * If reading a file fails, the reader threads stop and #next_batch() returns `std::nullopt` after the queued
+     * batches are consumed. The error is available via #get_status().
+     *
+     * #### Example usage
+     *
+     * ```cpp
+     * auto filenames = centipede::reader::MultiFile::find_files("data/mille_*.bin");
+     * auto input = centipede::reader::MultiFile{ { .in_filenames = std::move(filenames.value()) } };
+     * auto start_err = input.start();
+     * while (auto batch = input.next_batch())
+     * {
+     *     auto analyze_err = master.analyze(batch->get_entries());
+     *     input.recycle(std::move(batch.value()));
+     * }
+     * if (not input.is_ok())
+     * {
+     *     std::println(stderr, "Error: {}", input.get_status());
+     * }
+     * ```
+     */
+    class MultiFile
+    {
+      public:
+        /**
+         * @brief Configuration of the multi-file reader.
+         */
+        struct Config
+        {
+            std::vector<std::string> in_filenames; //!< Input binary filenames.
+            std::size_t n_threads = 0;             //!< Number of reader threads. 0 to use all hardware threads.
+            std::size_t batch_size = 256;          //!< Maximal number of entries in a batch.
+            std::size_t max_n_queued_batches = 0;  //!< Capacity of the batch queue. 0 to use 2 batches per thread.
+            bool use_memory_map = true;            //!< Map the files instead of using streams. See Binary::Config.
+        };
+
+        /**
+         * @brief Batch of flat entries read from the same file.
+         */
+        struct Batch
+        {
+            std::vector<FlatEntry> entries; //!< Flat entries. Only the first #n_entries are valid.
+            std::size_t n_entries = 0;      //!< Number of valid entries.
+
+            [[nodiscard]] auto get_entries() const -> std::span<const FlatEntry>
+            {
+                return std::span{ entries }.first(n_entries);
+            }
+        };
+
+        /**
+         * @brief Constructor.
+         *
+         * The reader threads are only started by #start().
+         */
+        explicit MultiFile(Config config);
+
+        /**
+         * @brief Destructor.
+         *
+         * The batch queue is closed and the destructor waits until all reader threads are finished.
+         */
+        ~MultiFile();
+
+        MultiFile(const MultiFile&) = delete;
+        MultiFile(MultiFile&&) = delete;
+        auto operator=(const MultiFile&) -> MultiFile& = delete;
+        auto operator=(MultiFile&&) -> MultiFile& = delete;
+
+        /**
+         * @brief Start the reader threads.
+         * @return ErrorCode::reader_invalid_filename if the file list is empty.
+         */
+        [[nodiscard]] auto start() -> EnumError<>;
+
+        /**
+         * @brief Pop the next batch of entries.
+         *
+         * The calling thread is blocked until a batch is available. The batches of different files arrive in any
+         * order.
+         * @return The next batch or `std::nullopt` if all files are read or an error occurred.
+         */
+        [[nodiscard]] auto next_batch() -> std::optional<Batch>;
+
+        /**
+         * @brief Give a batch back to the reader for reusing its memory.
+         */
+        void recycle(Batch batch);
+
+        /**
+         * @brief Find the files matching a pattern.
+         *
+         * The wildcards `*` and `?` are supported in the filename, but not in the directory part of the pattern.
+         * @return Sorted list of the matching files. ErrorCode::reader_file_fail_to_open if the directory cannot be
+         * opened.
+         */
+        [[nodiscard]] static auto find_files(const std::string& pattern) -> EnumError<std::vector<std::string>>;
+
+        /**
+         * @brief Select the files of one shard, when the files are distributed over several processes.
+         *
+         * The files are assigned to the shards in a round-robin fashion, such that each file belongs to exactly one
+         * shard and the shard sizes differ by at most one file.
+         * @param filenames List of all files.
+         * @param shard_idx Index of the shard, smaller than `n_shards`.
+         * @param n_shards Total number of shards.
+         * @return Files of the shard. ErrorCode::reader_invalid_filename if `shard_idx` is out of range.
+         */
+        [[nodiscard]] static auto select_shard(std::span<const std::string> filenames,
+                                               std::size_t shard_idx,
+                                               std::size_t n_shards) -> EnumError<std::vector<std::string>>;
+
+        /**
+         * @brief Getter of the error status. ErrorCode::success if no error occurred.
+         */
+        [[nodiscard]] auto get_status() const -> ErrorCode;
+        [[nodiscard]] auto is_ok() const -> bool { return get_status() == ErrorCode::success; }
+
+        /**
+         * @brief Getter of the total number of entries read by all threads so far.
+         */
+        [[nodiscard]] auto get_n_entries() const -> uint64_t { return n_entries_.load(); }
+
+        [[nodiscard]] auto get_config() const -> const Config& { return config_; }
+
+      private:
+        Config config_;
+        common::BoundedQueue<Batch> batch_queue_;
+        std::atomic<std::size_t> next_file_idx_{ 0 };     //!< Index of the next file to be read.
+        std::atomic<std::size_t> n_running_threads_{ 0 }; //!< Number of reader threads still running.
+        std::atomic<uint64_t> n_entries_{ 0 };
+        mutable std::mutex status_mutex_;
+        ErrorCode status_ = ErrorCode::success;
+        std::mutex recycle_mutex_;
+        std::vector<Batch> recycled_batches_;
+        std::vector<std::jthread> workers_; //!< Reader threads. Must be destroyed before other members.
+
+        auto read_file(const std::string& filename) -> EnumError<>;
+        auto acquire_batch() -> Batch;
+        void set_error(ErrorCode error);
+        [[nodiscard]] auto has_error() const -> bool { return get_status() != ErrorCode::success; }
+        void run();
+    };
+} // namespace centipede::reader
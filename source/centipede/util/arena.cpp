@@ -0,0 +1,62 @@
+#include "arena.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <new>
+
+namespace centipede::common
+{
+    namespace
+    {
+        constexpr auto align_up(std::size_t n_bytes) -> std::size_t
+        {
+            return (n_bytes + Arena::ALIGNMENT - 1) / Arena::ALIGNMENT * Arena::ALIGNMENT;
+        }
+    } // namespace
+
+    Arena::Arena(std::size_t capacity)
+        : block_{ make_block(align_up(capacity)) }
+        , capacity_{ align_up(capacity) }
+    {
+    }
+
+    void Arena::reset()
+    {
+        if (not overflow_blocks_.empty())
+        {
+            const auto new_capacity = std::max(offset_ + overflow_size_, 2 * capacity_);
+            block_ = make_block(new_capacity);
+            capacity_ = new_capacity;
+            overflow_blocks_.clear();
+        }
+        offset_ = 0;
+        overflow_size_ = 0;
+    }
+
+    auto Arena::allocate_bytes(std::size_t n_bytes) -> std::byte*
+    {
+        const auto aligned_size = align_up(n_bytes);
+        if (aligned_size == 0)
+        {
+            return nullptr;
+        }
+        if (offset_ + aligned_size <= capacity_)
+        {
+            auto* ptr = block_.get() + offset_;
+            offset_ += aligned_size;
+            return ptr;
+        }
+        overflow_blocks_.push_back(make_block(aligned_size));
+        overflow_size_ += aligned_size;
+        ++n_overflows_;
+        return overflow_blocks_.back().get();
+    }
+
+    auto Arena::make_block(std::size_t n_bytes) -> Block
+    {
+        if (n_bytes == 0)
+        {
+            return Block{};
+        }
+        return Block{ static_cast<std::byte*>(::operator new(n_bytes, std::align_val_t{ ALIGNMENT })) };
+    }
+} // namespace centipede::common
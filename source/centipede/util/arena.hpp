@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace centipede::common
+{
+    /**
+     * @brief Monotonic arena for scratch memory.
+     *
+     * Memory is taken from a single block by bumping an offset and is released all at once with #reset(). If the
+     * block is too small, the request is served from an overflow block, which stays valid until the next #reset().
+     * The reset then replaces all blocks with a single block large enough for the peak usage since the last reset.
+     * Therefore, once the arena has seen the largest request pattern, no memory is allocated anymore.
+     *
+     * The arena is not thread-safe and is intended to be owned by a single thread.
+     */
+    class Arena
+    {
+      public:
+        constexpr static auto ALIGNMENT = std::size_t{ 64 }; //!< Alignment of each allocation in bytes.
+
+        /**
+         * @brief Constructor.
+         * @param capacity Initial capacity in bytes.
+         */
+        explicit Arena(std::size_t capacity = 0);
+
+        Arena(const Arena&) = delete;
+        auto operator=(const Arena&) -> Arena& = delete;
+        Arena(Arena&&) noexcept = default;
+        auto operator=(Arena&&) noexcept -> Arena& = default;
+        ~Arena() = default;
+
+        /**
+         * @brief Allocate an array from the arena.
+         *
+         * The elements are not initialized. The memory is valid until the next #reset().
+         * @tparam T Element type. Must be trivially destructible since no destructor is called.
+         * @param size Number of elements.
+         */
+        template <typename T>
+            requires std::is_trivially_destructible_v<T>
+        [[nodiscard]] auto allocate(std::size_t size) -> std::span<T>
+        {
+            static_assert(alignof(T) <= ALIGNMENT);
+            return { static_cast<T*>(static_cast<void*>(allocate_bytes(size * sizeof(T)))), size };
+        }
+
+        /**
+         * @brief Release all allocations.
+         *
+         * If overflow blocks were needed since the last reset, the main block is enlarged to the peak usage.
+         */
+        void reset();
+
+        /**
+         * @brief Capacity of the main block in bytes.
+         */
+        [[nodiscard]] auto get_capacity() const -> std::size_t { return capacity_; }
+
+        /**
+         * @brief Number of bytes allocated since the last reset, including the overflow blocks.
+         */
+        [[nodiscard]] auto get_size() const -> std::size_t { return offset_ + overflow_size_; }
+
+        /**
+         * @brief Number of allocations served from overflow blocks since the construction.
+         *
+         * Overflow blocks are allocated on the heap. The number stays constant once the arena is warmed up.
+         */
+        [[nodiscard]] auto get_n_overflows() const -> std::size_t { return n_overflows_; }
+
+      private:
+        struct AlignedDeleter
+        {
+            void operator()(std::byte* ptr) const { ::operator delete(ptr, std::align_val_t{ ALIGNMENT }); }
+        };
+        using Block = std::unique_ptr<std::byte, AlignedDeleter>;
+
+        Block block_;
+        std::size_t capacity_ = 0;
+        std::size_t offset_ = 0;
+        std::vector<Block> overflow_blocks_;
+        std::size_t overflow_size_ = 0;
+        std::size_t n_overflows_ = 0;
+
+        auto allocate_bytes(std::size_t n_bytes) -> std::byte*;
+        static auto make_block(std::size_t n_bytes) -> Block;
+    };
+} // namespace centipede::common
@@ -0,0 +1,78 @@
+#include "block_compression.hpp"
+#include "centipede/util/error_types.hpp"
+#include "centipede/util/return_types.hpp"
+#include <cstddef>
+#include <expected>
+#include <memory>
+#include <span>
+#include <vector>
+#include <zstd.h>
+
+namespace centipede::common
+{
+    struct BlockCompressor::Context
+    {
+        std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> handle{ ZSTD_createCCtx(), &ZSTD_freeCCtx };
+    };
+
+    struct BlockDecompressor::Context
+    {
+        std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> handle{ ZSTD_createDCtx(), &ZSTD_freeDCtx };
+    };
+
+    BlockCompressor::BlockCompressor(int level)
+        : context_{ std::make_unique<Context>() }
+        , level_{ level }
+    {
+    }
+
+    BlockCompressor::~BlockCompressor() = default;
+    BlockCompressor::BlockCompressor(BlockCompressor&&) noexcept = default;
+    auto BlockCompressor::operator=(BlockCompressor&&) noexcept -> BlockCompressor& = default;
+
+    auto BlockCompressor::compress(std::span<const std::byte> input, std::vector<std::byte>& output) -> EnumError<>
+    {
+        if (context_ == nullptr or context_->handle == nullptr)
+        {
+            return std::unexpected{ ErrorCode::writer_file_fail_to_compress };
+        }
+        output.resize(ZSTD_compressBound(input.size()));
+        const auto compressed_size = ZSTD_compressCCtx(
+            context_->handle.get(), output.data(), output.size(), input.data(), input.size(), level_);
+        if (ZSTD_isError(compressed_size) != 0U)
+        {
+            output.clear();
+            return std::unexpected{ ErrorCode::writer_file_fail_to_compress };
+        }
+        output.resize(compressed_size);
+        return {};
+    }
+
+    BlockDecompressor::BlockDecompressor()
+        : context_{ std::make_unique<Context>() }
+    {
+    }
+
+    BlockDecompressor::~BlockDecompressor() = default;
+    BlockDecompressor::BlockDecompressor(BlockDecompressor&&) noexcept = default;
+    auto BlockDecompressor::operator=(BlockDecompressor&&) noexcept -> BlockDecompressor& = default;
+
+    auto BlockDecompressor::decompress(std::span<const std::byte> input,
+                                       std::size_t output_size,
+                                       std::vector<std::byte>& output) -> EnumError<>
+    {
+        if (context_ == nullptr or context_->handle == nullptr)
+        {
+            return std::unexpected{ ErrorCode::reader_file_fail_to_decompress };
+        }
+        output.resize(output_size);
+        const auto decompressed_size =
+            ZSTD_decompressDCtx(context_->handle.get(), output.data(), output.size(), input.data(), input.size());
+        if (ZSTD_isError(decompressed_size) != 0U or decompressed_size != output_size)
+        {
+            output.clear();
+            return std::unexpected{ ErrorCode::reader_file_fail_to_decompress };
+        }
+        return {};
+    }
+} // namespace centipede::common
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "centipede/util/return_types.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace centipede::common
+{
+    /**
+     * @brief Compression algorithm of binary files.
+     */
+    enum class Compression : uint8_t
+    {
+        none, //!< Records are written without any container.
+        zstd, //!< Records are grouped into zstd compressed blocks.
+    };
+
+    /**
+     * @brief Layout of the block-compressed container.
+     *
+     * A compressed file starts with a header of three 32 bit words: #MAGIC, #VERSION and the #Compression type. The
+     * header is followed by blocks, each of which consists of the compressed size and the uncompressed size (both 32
+     * bit words) and the compressed bytes. A block always contains complete records, i.e. the uncompressed content of
+     * all blocks is identical to an uncompressed file.
+     */
+    namespace compressed_file
+    {
+        constexpr auto MAGIC = uint32_t{ 0x5A4E4543 };                //!< Bytes "CENZ" in little endian.
+        constexpr auto VERSION = uint32_t{ 1 };                       //!< Version of the container layout.
+        constexpr auto HEADER_SIZE = 3 * sizeof(uint32_t);            //!< Size of the file header in bytes.
+        constexpr auto BLOCK_HEADER_SIZE = 2 * sizeof(uint32_t);      //!< Size of the block header in bytes.
+        constexpr auto DEFAULT_BLOCK_SIZE = std::size_t{ 1U << 20U }; //!< Default uncompressed block size in bytes.
+        constexpr auto DEFAULT_LEVEL = 3;                             //!< Default compression level.
+    } // namespace compressed_file
+
+    /**
+     * @brief Compressor of data blocks.
+     *
+     * The compression context is kept between calls to avoid reallocating it for each block.
+     */
+    class BlockCompressor
+    {
+      public:
+        /**
+         * @brief Constructor.
+         * @param level Compression level.
+         */
+        explicit BlockCompressor(int level = compressed_file::DEFAULT_LEVEL);
+        ~BlockCompressor();
+
+        BlockCompressor(const BlockCompressor&) = delete;
+        auto operator=(const BlockCompressor&) -> BlockCompressor& = delete;
+        BlockCompressor(BlockCompressor&&) noexcept;
+        auto operator=(BlockCompressor&&) noexcept -> BlockCompressor&;
+
+        /**
+         * @brief Compress a block.
+         * @param input Uncompressed bytes.
+         * @param output Buffer to store the compressed bytes. It's resized to the compressed size.
+         * @return ErrorCode::writer_file_fail_to_compress if the compression fails.
+         */
+        [[nodiscard]] auto compress(std::span<const std::byte> input, std::vector<std::byte>& output) -> EnumError<>;
+
+      private:
+        struct Context;
+        std::unique_ptr<Context> context_;
+        int level_ = compressed_file::DEFAULT_LEVEL;
+    };
+
+    /**
+     * @brief Decompressor of data blocks.
+     *
+     * The decompression context is kept between calls to avoid reallocating it for each block.
+     */
+    class BlockDecompressor
+    {
+      public:
+        BlockDecompressor();
+        ~BlockDecompressor();
+
+        BlockDecompressor(const BlockDecompressor&) = delete;
+        auto operator=(const BlockDecompressor&) -> BlockDecompressor& = delete;
+        BlockDecompressor(BlockDecompressor&&) noexcept;
+        auto operator=(BlockDecompressor&&) noexcept -> BlockDecompressor&;
+
+        /**
+         * @brief Decompress a block.
+         * @param input Compressed bytes.
+         * @param output_size Expected size of the uncompressed block.
+         * @param output Buffer to store the uncompressed bytes. It's resized to `output_size`.
+         * @return ErrorCode::reader_file_fail_to_decompress if the input is corrupted or the uncompressed size differs
+         * from `output_size`.
+         */
+        [[nodiscard]] auto decompress(std::span<const std::byte> input,
+                                      std::size_t output_size,
+                                      std::vector<std::byte>& output) -> EnumError<>;
+
+      private:
+        struct Context;
+        std::unique_ptr<Context> context_;
+    };
+} // namespace centipede::common
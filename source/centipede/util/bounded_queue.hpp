@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace centipede::common
+{
+    /**
+     * @brief Thread-safe FIFO queue with a fixed capacity.
+     *
+     * Elements are stored in a ring buffer which is allocated once during the construction. Producers calling #push()
+     * are blocked while the queue is full and consumers calling #pop() are blocked while the queue is empty. Once
+     * #close() is called, no new elements are accepted and #pop() returns `std::nullopt` after all remaining elements
+     * have been consumed.
+     *
+     * @tparam T Type of the queue elements. Must be default constructible and movable.
+     */
+    template <typename T>
+    class BoundedQueue
+    {
+      public:
+        /**
+         * @brief Constructor.
+         * @param capacity Maximal number of elements in the queue. A capacity of 0 is treated as 1.
+         */
+        explicit BoundedQueue(std::size_t capacity)
+            : ring_(std::max(capacity, std::size_t{ 1 }))
+        {
+        }
+
+        /**
+         * @brief Push a new element to the end of the queue.
+         *
+         * The calling thread is blocked while the queue is full.
+         * @param value Element to be pushed.
+         * @return False if the queue has been closed and the element is discarded.
+         */
+        auto push(T value) -> bool
+        {
+            auto lock = std::unique_lock{ mutex_ };
+            not_full_.wait(lock, [this]() -> bool { return is_closed_ or size_ < ring_.size(); });
+            if (is_closed_)
+            {
+                return false;
+            }
+            ring_[(head_ + size_) % ring_.size()] = std::move(value);
+            ++size_;
+            lock.unlock();
+            not_empty_.notify_one();
+            return true;
+        }
+
+        /**
+         * @brief Pop the first element of the queue.
+         *
+         * The calling thread is blocked while the queue is empty and not closed.
+         * @return The first element or `std::nullopt` if the queue is closed and empty.
+         */
+        auto pop() -> std::optional<T>
+        {
+            auto lock = std::unique_lock{ mutex_ };
+            not_empty_.wait(lock, [this]() -> bool { return is_closed_ or size_ > 0; });
+            if (size_ == 0)
+            {
+                return std::nullopt;
+            }
+            auto value = std::optional<T>{ std::move(ring_[head_]) };
+            head_ = (head_ + 1) % ring_.size();
+            --size_;
+            lock.unlock();
+            not_full_.notify_one();
+            return value;
+        }
+
+        /**
+         * @brief Close the queue.
+         *
+         * All blocked producers and consumers are woken up. Elements already in the queue can still be popped.
+         */
+        void close()
+        {
+            {
+                auto lock = std::scoped_lock{ mutex_ };
+                is_closed_ = true;
+            }
+            not_full_.notify_all();
+            not_empty_.notify_all();
+        }
+
+        /**
+         * @brief Getter of the current number of elements in the queue.
+         */
+        [[nodiscard]] auto size() const -> std::size_t
+        {
+            auto lock = std::scoped_lock{ mutex_ };
+            return size_;
+        }
+
+        /**
+         * @brief Getter of the capacity of the queue.
+         */
+        [[nodiscard]] auto capacity() const -> std::size_t { return ring_.size(); }
+
+      private:
+        mutable std::mutex mutex_;
+        std::condition_variable not_full_;
+        std::condition_variable not_empty_;
+        std::vector<T> ring_; //!< Ring buffer storing the elements.
+        std::size_t head_ = 0;
+        std::size_t size_ = 0;
+        bool is_closed_ = false;
+    };
+} // namespace centipede::common
@@ -0,0 +1,98 @@
+#include "entry_index.hpp"
+#include "centipede/util/error_types.hpp"
+#include "centipede/util/return_types.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <fstream>
+#include <ios>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <string>
+#include <type_traits>
+
+namespace centipede::common
+{
+    namespace
+    {
+        template <typename T, std::size_t Extent>
+            requires(std::is_trivially_copyable_v<T>)
+        void write_value(std::ofstream& output_file, std::span<const T, Extent> data)
+        {
+            // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
+            output_file.write(reinterpret_cast<const char*>(data.data()),
+                              static_cast<std::streamsize>(data.size_bytes()));
+            // NOLINTEND (cppcoreguidelines-pro-type-reinterpret-cast)
+        }
+
+        template <typename T, std::size_t Extent>
+            requires(std::is_trivially_copyable_v<T>)
+        auto read_value(std::ifstream& input_file, std::span<T, Extent> data) -> bool
+        {
+            // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
+            input_file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size_bytes()));
+            // NOLINTEND (cppcoreguidelines-pro-type-reinterpret-cast)
+            return input_file.gcount() == static_cast<std::streamsize>(data.size_bytes());
+        }
+    } // namespace
+
+    void EntryIndex::add_point(uint64_t entry_idx, uint64_t offset)
+    {
+        assert(points_.empty() or points_.back().entry_idx < entry_idx);
+        points_.push_back(Point{ .entry_idx = entry_idx, .offset = offset });
+    }
+
+    auto EntryIndex::find(uint64_t entry_idx) const -> std::optional<Point>
+    {
+        auto iter = std::ranges::upper_bound(points_, entry_idx, {}, &Point::entry_idx);
+        if (iter == points_.begin())
+        {
+            return std::nullopt;
+        }
+        return *std::prev(iter);
+    }
+
+    auto EntryIndex::write(const std::string& filename) const -> EnumError<>
+    {
+        auto output_file = std::ofstream{ filename, std::ios::binary | std::ios::out | std::ios::trunc };
+        if (!output_file.is_open())
+        {
+            return std::unexpected{ ErrorCode::writer_file_fail_to_open };
+        }
+        const auto header = std::array{ MAGIC, VERSION };
+        const auto sizes = std::array{ n_entries_, uint64_t{ points_.size() } };
+        write_value(output_file, std::span{ header });
+        write_value(output_file, std::span{ sizes });
+        write_value(output_file, std::span{ points_ });
+        if (!output_file.good())
+        {
+            return std::unexpected{ ErrorCode::writer_file_fail_to_open };
+        }
+        return {};
+    }
+
+    auto EntryIndex::read(const std::string& filename) -> EnumError<>
+    {
+        clear();
+        auto input_file = std::ifstream{ filename, std::ios::binary | std::ios::in };
+        auto header = std::array<uint32_t, 2>{};
+        auto sizes = std::array<uint64_t, 2>{};
+        if (not input_file.is_open() or not read_value(input_file, std::span{ header }) or header[0] != MAGIC or
+            header[1] != VERSION or not read_value(input_file, std::span{ sizes }))
+        {
+            return std::unexpected{ ErrorCode::reader_invalid_index };
+        }
+        points_.resize(sizes[1]);
+        if (not read_value(input_file, std::span{ points_ }))
+        {
+            clear();
+            return std::unexpected{ ErrorCode::reader_invalid_index };
+        }
+        n_entries_ = sizes[0];
+        return {};
+    }
+} // namespace centipede::common
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "centipede/util/return_types.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace centipede::common
+{
+    /**
+     * @brief Index of the entry positions in a binary file.
+     *
+     * The index stores the byte offsets of a subset of the entries in a binary file, which allows the readers to jump
+     * close to any entry without scanning the file from the beginning. For an uncompressed file, each offset points to
+     * the record of the entry. For a compressed file, it points to the block which starts with the entry.
+     *
+     * The index is stored in a side file (see #get_filename()) with the layout: `MAGIC`, `VERSION` (both 32 bit words),
+     * the total number of entries and the number of points (both 64 bit words), followed by the entry index and the
+     * byte offset of each point (both 64 bit words).
+     */
+    class EntryIndex
+    {
+      public:
+        constexpr static auto MAGIC = uint32_t{ 0x494E4543 }; //!< Bytes "CENI" in little endian.
+        constexpr static auto VERSION = uint32_t{ 1 };        //!< Version of the index layout.
+
+        /**
+         * @brief Position of an entry in the binary file.
+         */
+        struct Point
+        {
+            uint64_t entry_idx = 0; //!< Index of the entry (0-based indexing).
+            uint64_t offset = 0;    //!< Byte offset in the binary file.
+        };
+
+        /**
+         * @brief Name of the index file belonging to a binary file.
+         */
+        [[nodiscard]] static auto get_filename(const std::string& data_filename) -> std::string
+        {
+            return data_filename + ".idx";
+        }
+
+        /**
+         * @brief Add a point to the index. Points must be added in the ascending order of the entry index.
+         */
+        void add_point(uint64_t entry_idx, uint64_t offset);
+
+        /**
+         * @brief Set the total number of entries in the binary file.
+         */
+        void set_n_entries(uint64_t n_entries) { n_entries_ = n_entries; }
+
+        /**
+         * @brief Remove all points.
+         */
+        void clear()
+        {
+            points_.clear();
+            n_entries_ = 0;
+        }
+
+        /**
+         * @brief Find the closest point at or before an entry.
+         * @param entry_idx Index of the entry.
+         * @return The last point whose entry index isn't larger than `entry_idx`. `std::nullopt` if no such point
+         * exists.
+         */
+        [[nodiscard]] auto find(uint64_t entry_idx) const -> std::optional<Point>;
+
+        /**
+         * @brief Write the index to a file.
+         * @return ErrorCode::writer_file_fail_to_open if the file cannot be written.
+         */
+        [[nodiscard]] auto write(const std::string& filename) const -> EnumError<>;
+
+        /**
+         * @brief Read the index from a file.
+         * @return ErrorCode::reader_invalid_index if the file cannot be opened or is corrupted.
+         */
+        [[nodiscard]] auto read(const std::string& filename) -> EnumError<>;
+
+        [[nodiscard]] auto get_n_entries() const -> uint64_t { return n_entries_; }
+        [[nodiscard]] auto get_points() const -> std::span<const Point> { return points_; }
+
+      private:
+        uint64_t n_entries_ = 0;
+        std::vector<Point> points_;
+    };
+} // namespace centipede::common
@@ -14,12 +14,14 @@ namespace centipede
         invalid,                    //!< Error due to no evaluation!
         success,                    //!< No error. All good!
         handler_incomp_n_locals,    //!< Incompatible number of local variables from the current entrypoint.
+        handler_too_many_globals,   //!< More distinct global labels than global parameters.
         writer_neg_or_zero_sigma,   //!< Zero or negative sigma occurs. See @ref writer::Binary.
         writer_buffer_overflow,     //!< Buffer size is too small for a new entry occurs. See @ref writer::Binary.
         writer_entrypoint_rejected, //!< Entrypoint is rejected due to absence of non-zero derivs. See @ref
                                     //!< writer::Binary.
         writer_file_fail_to_open,   //!< File failed to be open.
         writer_uninitialized,       //!< Write is not initialized.
+        writer_file_fail_to_compress, //!< Data failed to be compressed.
         analysis_local_fit_rank_deficit,
         analysis_local_fit_low_stat,
         analysis_local_fit_rejected,
@@ -28,11 +30,15 @@ namespace centipede
         analysis_global_negative_definite,
         analysis_factor_matrix_zero, //!< Global factor matrix is zero matrix.
         analysis_rhs_vector_zero,    //!< Global right-hand-side vector is zero vector.
+        analysis_solver_not_converged, //!< Iterative solver of the global system didn't converge.
         reader_file_fail_to_open,    //!< Input file failed to be open.
         reader_file_fail_to_read,    //!< Input file failed to read
         reader_uninitialized,        //!< Reader is not initialized.
         reader_buffer_overflow,      //!< Buffer size is too small for a new entry occurs. See @ref reader::Binary.
         reader_invalid_filename,     //!< Filename is invalid or empty
+        reader_file_fail_to_decompress, //!< Compressed input file is corrupted.
+        reader_invalid_index,           //!< Index file is missing or corrupted, or the entry range is invalid.
+        reader_invalid_checkpoint,      //!< Checkpoint file is corrupted or doesn't match the global system.
     };
 
 } // namespace centipede
@@ -59,6 +65,8 @@ struct std::formatter<centipede::ErrorCode>
             case handler_incomp_n_locals:
                 return std::format_to(ctx.out(),
                                       "Handler: Incompatible number of local variables from the current entrypoint.");
+            case handler_too_many_globals:
+                return std::format_to(ctx.out(), "Handler: More distinct global labels than global parameters.");
             case writer_neg_or_zero_sigma:
                 return std::format_to(ctx.out(), "Writer: Sigma value in the entry point is 0.F or negative!");
             case writer_buffer_overflow:
@@ -70,6 +78,8 @@ struct std::formatter<centipede::ErrorCode>
                 return std::format_to(ctx.out(), "Writer: Failed to open the file.");
             case writer_uninitialized:
                 return std::format_to(ctx.out(), "Writer: Must be initialized beforehand!");
+            case writer_file_fail_to_compress:
+                return std::format_to(ctx.out(), "Writer: Failed to compress the data.");
             case analysis_local_fit_rank_deficit:
                 return std::format_to(ctx.out(), "Rank deficit occurred during the local fitting.");
             case analysis_local_fit_low_stat:
@@ -87,6 +97,8 @@ struct std::formatter<centipede::ErrorCode>
                 return std::format_to(ctx.out(), "Global factor matrix is zero matrix.");
             case analysis_rhs_vector_zero:
                 return std::format_to(ctx.out(), "Global right-hand-side vector is zero vector.");
+            case analysis_solver_not_converged:
+                return std::format_to(ctx.out(), "Iterative solver of the global system didn't converge.");
             case reader_file_fail_to_open:
                 return std::format_to(ctx.out(), "Reader: Failed to open the file.");
             case reader_uninitialized:
@@ -97,6 +109,13 @@ struct std::formatter<centipede::ErrorCode>
                 return std::format_to(ctx.out(), "Reader: Cannot read the file. Buffer size will be exceeded!");
             case reader_invalid_filename:
                 return std::format_to(ctx.out(), "Reader: Filename is either empty or invalid!");
+            case reader_file_fail_to_decompress:
+                return std::format_to(ctx.out(), "Reader: Failed to decompress the file.");
+            case reader_invalid_index:
+                return std::format_to(ctx.out(), "Reader: Index file is invalid or entry range is out of bounds!");
+            case reader_invalid_checkpoint:
+                return std::format_to(ctx.out(),
+                                      "Reader: Checkpoint file is invalid or doesn't match the global system!");
             case invalid:
                 return std::format_to(ctx.out(), "Error due to no evaluation!");
             default:
@@ -0,0 +1,66 @@
+#include "label_map.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+namespace centipede::common
+{
+    auto LabelMap::insert(uint32_t label) -> uint32_t
+    {
+        const auto [iter, is_inserted] = indices_.try_emplace(label, static_cast<uint32_t>(labels_.size()));
+        if (is_inserted)
+        {
+            labels_.push_back(label);
+        }
+        return iter->second;
+    }
+
+    void LabelMap::insert(std::span<const uint32_t> labels)
+    {
+        for (const auto label : labels)
+        {
+            insert(label);
+        }
+    }
+
+    auto LabelMap::find(uint32_t label) const -> std::optional<uint32_t>
+    {
+        if (const auto iter = indices_.find(label); iter != indices_.end())
+        {
+            return iter->second;
+        }
+        return std::nullopt;
+    }
+
+    void LabelMap::sort()
+    {
+        std::ranges::sort(labels_);
+        for (auto index = uint32_t{}; index < labels_.size(); ++index)
+        {
+            indices_[labels_[index]] = index;
+        }
+    }
+
+    void LabelMap::truncate(std::size_t size)
+    {
+        while (labels_.size() > size)
+        {
+            indices_.erase(labels_.back());
+            labels_.pop_back();
+        }
+    }
+
+    void LabelMap::reserve(std::size_t size)
+    {
+        indices_.reserve(size);
+        labels_.reserve(size);
+    }
+
+    void LabelMap::clear()
+    {
+        indices_.clear();
+        labels_.clear();
+    }
+} // namespace centipede::common
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace centipede::common
+{
+    /**
+     * @brief Mapping from sparse global labels to dense parameter indices.
+     *
+     * Global labels are arbitrary 32 bit IDs (e.g. detector IDs), of which only a small fraction may be used. The map
+     * assigns each used label a dense index in the order the labels are inserted, such that the global system only
+     * needs as many parameters as there are used labels. The labels can either be discovered incrementally during the
+     * analysis, or in a pre-pass over the data followed by #sort(), which makes the indices follow the label order.
+     */
+    class LabelMap
+    {
+      public:
+        /**
+         * @brief Insert a label if it's not in the map yet.
+         * @return Dense index of the label.
+         */
+        auto insert(uint32_t label) -> uint32_t;
+
+        /**
+         * @brief Insert all labels, e.g. the global labels of an entry in a pre-pass.
+         */
+        void insert(std::span<const uint32_t> labels);
+
+        /**
+         * @brief Find the dense index of a label.
+         * @return `std::nullopt` if the label is not in the map.
+         */
+        [[nodiscard]] auto find(uint32_t label) const -> std::optional<uint32_t>;
+
+        /**
+         * @brief Reassign the dense indices in the ascending order of the labels.
+         *
+         * Indices handed out before are invalidated. This is meant to be called after a pre-pass.
+         */
+        void sort();
+
+        /**
+         * @brief Remove the most recently inserted labels, such that only `size` labels remain.
+         */
+        void truncate(std::size_t size);
+
+        void reserve(std::size_t size);
+        void clear();
+
+        /**
+         * @brief Getter of the label of a dense index.
+         */
+        [[nodiscard]] auto get_label(std::size_t index) const -> uint32_t { return labels_[index]; }
+
+        /**
+         * @brief Getter of all labels ordered by their dense indices.
+         */
+        [[nodiscard]] auto get_labels() const -> std::span<const uint32_t> { return labels_; }
+
+        [[nodiscard]] auto size() const -> std::size_t { return labels_.size(); }
+        [[nodiscard]] auto empty() const -> bool { return labels_.empty(); }
+
+      private:
+        std::unordered_map<uint32_t, uint32_t> indices_; //!< Dense index of each label.
+        std::vector<uint32_t> labels_;                   //!< Label of each dense index.
+    };
+} // namespace centipede::common
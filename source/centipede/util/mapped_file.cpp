@@ -0,0 +1,82 @@
+#include "mapped_file.hpp"
+#include "centipede/util/error_types.hpp"
+#include "centipede/util/return_types.hpp"
+#include <cstddef>
+#include <expected>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace centipede::common
+{
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : data_{ std::exchange(other.data_, nullptr) }
+        , size_{ std::exchange(other.size_, 0) }
+        , is_open_{ std::exchange(other.is_open_, false) }
+    {
+    }
+
+    auto MappedFile::operator=(MappedFile&& other) noexcept -> MappedFile&
+    {
+        if (this != &other)
+        {
+            close();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            is_open_ = std::exchange(other.is_open_, false);
+        }
+        return *this;
+    }
+
+    auto MappedFile::open(const std::string& filename) -> EnumError<>
+    {
+        close();
+        // NOLINTNEXTLINE (cppcoreguidelines-pro-type-vararg)
+        const auto file_descriptor = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file_descriptor < 0)
+        {
+            return std::unexpected{ ErrorCode::reader_file_fail_to_open };
+        }
+
+        struct stat file_stat{};
+        if (::fstat(file_descriptor, &file_stat) != 0)
+        {
+            ::close(file_descriptor);
+            return std::unexpected{ ErrorCode::reader_file_fail_to_open };
+        }
+
+        const auto file_size = static_cast<std::size_t>(file_stat.st_size);
+        if (file_size != 0)
+        {
+            auto* address = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+            if (address == MAP_FAILED)
+            {
+                ::close(file_descriptor);
+                return std::unexpected{ ErrorCode::reader_file_fail_to_open };
+            }
+            // Entries are mostly consumed front to back. Failure of the hint is harmless.
+            ::madvise(address, file_size, MADV_SEQUENTIAL);
+            data_ = static_cast<const std::byte*>(address);
+        }
+        // The mapping stays valid after the file descriptor is closed.
+        ::close(file_descriptor);
+        size_ = file_size;
+        is_open_ = true;
+        return {};
+    }
+
+    void MappedFile::close()
+    {
+        if (data_ != nullptr)
+        {
+            // NOLINTNEXTLINE (cppcoreguidelines-pro-type-const-cast)
+            ::munmap(const_cast<std::byte*>(data_), size_);
+        }
+        data_ = nullptr;
+        size_ = 0;
+        is_open_ = false;
+    }
+} // namespace centipede::common
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "centipede/util/return_types.hpp"
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace centipede::common
+{
+    /**
+     * @brief Read-only memory mapping of a file.
+     *
+     * The whole file is mapped into the address space of the process when #open() is called and unmapped when
+     * #close() is called or the object is destroyed. The object is movable but not copyable.
+     */
+    class MappedFile
+    {
+      public:
+        /**
+         * @brief Default constructor. No file is mapped.
+         */
+        MappedFile() = default;
+
+        /**
+         * @brief Destructor. The mapping is released if it exists.
+         */
+        ~MappedFile() { close(); }
+
+        MappedFile(const MappedFile&) = delete;
+        auto operator=(const MappedFile&) -> MappedFile& = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        auto operator=(MappedFile&& other) noexcept -> MappedFile&;
+
+        /**
+         * @brief Map a file into memory.
+         *
+         * A previously mapped file is released first. An empty file results in an empty mapping.
+         * @param filename Name of the file.
+         * @return ErrorCode::reader_file_fail_to_open if the file cannot be opened or mapped.
+         */
+        [[nodiscard]] auto open(const std::string& filename) -> EnumError<>;
+
+        /**
+         * @brief Release the memory mapping.
+         */
+        void close();
+
+        /**
+         * @brief Getter of the mapped bytes.
+         */
+        [[nodiscard]] auto get_data() const -> std::span<const std::byte> { return { data_, size_ }; }
+
+        /**
+         * @brief Check whether a file is currently mapped.
+         */
+        [[nodiscard]] auto is_open() const -> bool { return is_open_; }
+
+      private:
+        const std::byte* data_ = nullptr;
+        std::size_t size_ = 0;
+        bool is_open_ = false;
+    };
+} // namespace centipede::common
@@ -1,40 +1,325 @@
 #include "binary.hpp"
+#include "centipede/util/block_compression.hpp"
+#include "centipede/util/entry_index.hpp"
+#include "centipede/util/bounded_queue.hpp"
 #include "centipede/util/error_types.hpp"
 #include "centipede/util/return_types.hpp"
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <expected>
+#include <filesystem>
 #include <fstream>
 #include <ios>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace centipede::writer
 {
     namespace
     {
-        template <typename T>
-        inline auto write_to_file(std::ofstream& output_file, const T& data)
+        inline void write_bytes(std::ofstream& output, std::span<const std::byte> bytes)
         {
-            const auto write_size = sizeof(T);
             // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
-            output_file.write(reinterpret_cast<const char*>(&data), static_cast<std::streamsize>(write_size));
+            output.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
             // NOLINTEND (cppcoreguidelines-pro-type-reinterpret-cast)
-            return write_size;
         }
 
-        template <typename T>
-        inline auto write_to_file(std::ofstream& output_file, const std::vector<T>& data)
+        inline void write_bytes(std::vector<std::byte>& output, std::span<const std::byte> bytes)
         {
-            const auto write_size = sizeof(T) * data.size();
-            // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
-            output_file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(write_size));
-            // NOLINTEND (cppcoreguidelines-pro-type-reinterpret-cast)
-            return write_size;
+            output.insert(output.end(), bytes.begin(), bytes.end());
+        }
+
+        template <typename Output, typename T>
+        inline auto write_to_file(Output& output, const T& data)
+        {
+            write_bytes(output, std::as_bytes(std::span{ &data, 1 }));
+            return sizeof(T);
+        }
+
+        template <typename Output, typename T>
+        inline auto write_to_file(Output& output, const std::vector<T>& data)
+        {
+            write_bytes(output, std::as_bytes(std::span{ data }));
+            return sizeof(T) * data.size();
+        }
+
+        template <typename Output>
+        auto write_buffer(Output& output, const Binary::BufferType& buffer) -> std::size_t
+        {
+            assert(buffer.first.size() == buffer.second.size());
+            const auto data_size = static_cast<uint32_t>((buffer.first.size()) + (buffer.second.size()));
+            auto total_written_size = std::size_t{ 0 };
+            total_written_size += write_to_file(output, data_size);
+            total_written_size += write_to_file(output, buffer.second);
+            total_written_size += write_to_file(output, buffer.first);
+            return total_written_size;
         }
     } // namespace
 
+    /**
+     * @brief Output file, optionally with the block-compressed container.
+     *
+     * Without compression, records are written to the file directly. Otherwise, they are appended to a block buffer,
+     * which is compressed and written once it exceeds the configured block size. Thus, a block always contains
+     * complete records. If an index stride is configured, the offsets of the entries (or blocks) are collected and
+     * written to the index file on #close().
+     */
+    class Binary::OutputFile
+    {
+      public:
+        OutputFile() = default;
+        ~OutputFile() { [[maybe_unused]] auto result = close(); }
+
+        OutputFile(const OutputFile&) = delete;
+        OutputFile(OutputFile&&) = delete;
+        auto operator=(const OutputFile&) -> OutputFile& = delete;
+        auto operator=(OutputFile&&) -> OutputFile& = delete;
+
+        /**
+         * @brief Open the file and write the container header in the compression mode.
+         */
+        auto open(const Config& config) -> EnumError<>
+        {
+            file_.open(config.out_filename, std::ios::binary | std::ios::out | std::ios::trunc);
+            if (!file_.is_open())
+            {
+                return std::unexpected{ ErrorCode::writer_file_fail_to_open };
+            }
+            index_filename_ = common::EntryIndex::get_filename(config.out_filename);
+            index_stride_ = config.index_stride;
+            if (index_stride_ == 0)
+            {
+                // An index left from a previous file with the same name must not be used for the new file.
+                auto error = std::error_code{};
+                std::filesystem::remove(index_filename_, error);
+            }
+            if (config.compression == common::Compression::none)
+            {
+                return {};
+            }
+            compressor_.emplace(config.compression_level);
+            block_size_ = config.compression_block_size;
+            raw_block_.reserve(block_size_ + ((std::size_t{ config.max_bufferpoint_size } + 1) * 2 * sizeof(float)));
+            file_offset_ += write_to_file(file_, common::compressed_file::MAGIC);
+            file_offset_ += write_to_file(file_, common::compressed_file::VERSION);
+            file_offset_ += write_to_file(file_, static_cast<uint32_t>(config.compression));
+            return {};
+        }
+
+        /**
+         * @brief Write a record.
+         * @return Uncompressed size of the record in bytes.
+         */
+        auto write(const BufferType& buffer) -> EnumError<std::size_t>
+        {
+            // In the compression mode, only the beginning of a block can be indexed.
+            if (index_stride_ != 0 and n_entries_ >= next_indexed_entry_ and
+                (not compressor_.has_value() or raw_block_.empty()))
+            {
+                index_.add_point(n_entries_, file_offset_);
+                next_indexed_entry_ = n_entries_ + index_stride_;
+            }
+            ++n_entries_;
+            if (not compressor_.has_value())
+            {
+                const auto written_size = write_buffer(file_, buffer);
+                file_offset_ += written_size;
+                return written_size;
+            }
+            const auto written_size = write_buffer(raw_block_, buffer);
+            if (raw_block_.size() >= block_size_)
+            {
+                if (auto result = flush_block(); !result)
+                {
+                    return std::unexpected{ result.error() };
+                }
+            }
+            return written_size;
+        }
+
+        /**
+         * @brief Write the last incomplete block and the index file, and close the file.
+         * @return The first error from writing the last block or the index file. The file is closed in any case.
+         */
+        auto close() -> EnumError<>
+        {
+            if (not file_.is_open())
+            {
+                return {};
+            }
+            auto result = EnumError<>{};
+            if (compressor_.has_value())
+            {
+                result = flush_block();
+            }
+            file_.close();
+            if (index_stride_ != 0)
+            {
+                index_.set_n_entries(n_entries_);
+                if (auto index_result = index_.write(index_filename_); result and not index_result)
+                {
+                    result = std::unexpected{ index_result.error() };
+                }
+            }
+            return result;
+        }
+
+      private:
+        std::ofstream file_;
+        std::optional<common::BlockCompressor> compressor_;
+        std::size_t block_size_ = 0;
+        std::vector<std::byte> raw_block_;
+        std::vector<std::byte> compressed_block_;
+        std::size_t file_offset_ = 0; //!< Number of bytes written to the file.
+        std::size_t n_entries_ = 0;   //!< Number of entries written.
+        std::size_t index_stride_ = 0;
+        std::size_t next_indexed_entry_ = 0;
+        common::EntryIndex index_;
+        std::string index_filename_;
+
+        auto flush_block() -> EnumError<>
+        {
+            if (raw_block_.empty())
+            {
+                return {};
+            }
+            auto result = compressor_->compress(raw_block_, compressed_block_);
+            if (result)
+            {
+                file_offset_ += write_to_file(file_, static_cast<uint32_t>(compressed_block_.size()));
+                file_offset_ += write_to_file(file_, static_cast<uint32_t>(raw_block_.size()));
+                file_offset_ += write_to_file(file_, compressed_block_);
+            }
+            raw_block_.clear();
+            return result;
+        }
+    };
+
+    /**
+     * @brief Background thread writing the filled data buffers to the output file.
+     *
+     * Filled buffers are passed via a bounded queue to the thread, which writes them to the file and returns the
+     * emptied buffers to a second queue, from which they are taken again by the writer. The first error from the
+     * background writing is kept and reported by #get_error() and #close().
+     */
+    class Binary::AsyncFlusher
+    {
+      public:
+        AsyncFlusher(std::unique_ptr<OutputFile> output_file, std::size_t n_buffers, std::size_t buffer_capacity)
+            : output_file_{ std::move(output_file) }
+            , filled_buffers_{ n_buffers }
+            , empty_buffers_{ n_buffers }
+        {
+            for (std::size_t idx = 0; idx < empty_buffers_.capacity(); ++idx)
+            {
+                auto buffer = BufferType{};
+                buffer.first.reserve(buffer_capacity);
+                buffer.second.reserve(buffer_capacity);
+                empty_buffers_.push(std::move(buffer));
+            }
+            thread_ = std::jthread{ [this]() { run(); } };
+        }
+
+        ~AsyncFlusher() { [[maybe_unused]] auto result = close(); }
+
+        AsyncFlusher(const AsyncFlusher&) = delete;
+        AsyncFlusher(AsyncFlusher&&) = delete;
+        auto operator=(const AsyncFlusher&) -> AsyncFlusher& = delete;
+        auto operator=(AsyncFlusher&&) -> AsyncFlusher& = delete;
+
+        /**
+         * @brief Take an empty buffer. The calling thread is blocked while all buffers are waiting to be written.
+         */
+        auto acquire_buffer() -> BufferType { return std::move(empty_buffers_.pop().value()); }
+
+        /**
+         * @brief Pass a filled buffer to the background thread.
+         */
+        void submit(BufferType buffer) { filled_buffers_.push(std::move(buffer)); }
+
+        /**
+         * @brief Get the first error occurred in the background thread so far.
+         */
+        auto get_error() const -> EnumError<>
+        {
+            if (const auto error = error_.load(); error != ErrorCode::success)
+            {
+                return std::unexpected{ error };
+            }
+            return {};
+        }
+
+        /**
+         * @brief Write all pending buffers, stop the background thread and close the file.
+         * @return The first error from the background thread or from closing the file.
+         */
+        auto close() -> EnumError<>
+        {
+            filled_buffers_.close();
+            if (thread_.joinable())
+            {
+                thread_.join();
+            }
+            auto result = output_file_->close();
+            if (auto error = get_error(); not error)
+            {
+                return error;
+            }
+            return result;
+        }
+
+      private:
+        std::unique_ptr<OutputFile> output_file_;
+        common::BoundedQueue<BufferType> filled_buffers_;
+        common::BoundedQueue<BufferType> empty_buffers_;
+        std::atomic<ErrorCode> error_{ ErrorCode::success };
+        std::jthread thread_;
+
+        void run()
+        {
+            while (auto buffer = filled_buffers_.pop())
+            {
+                if (auto result = output_file_->write(*buffer); not result)
+                {
+                    auto expected = ErrorCode::success;
+                    error_.compare_exchange_strong(expected, result.error());
+                }
+                buffer->first.clear();
+                buffer->second.clear();
+                empty_buffers_.push(std::move(*buffer));
+            }
+        }
+    };
+
+    Binary::~Binary() = default;
+    Binary::Binary(Binary&&) noexcept = default;
+    auto Binary::operator=(Binary&&) noexcept -> Binary& = default;
+
+    auto Binary::close() -> EnumError<>
+    {
+        auto result = EnumError<>{};
+        if (async_flusher_ != nullptr)
+        {
+            result = async_flusher_->close();
+            async_flusher_.reset();
+        }
+        if (output_file_ != nullptr)
+        {
+            result = output_file_->close();
+            output_file_.reset();
+        }
+        return result;
+    }
+
     auto Binary::fill_entrypoint_to_buffer(BufferPoint buffer_point, bool has_check_value) -> bool
     {
         if ((not has_check_value) or buffer_point.second != 0)
@@ -51,10 +336,17 @@ namespace centipede::writer
         data_buffer_.first.reserve(config_.max_bufferpoint_size);
         data_buffer_.second.reserve(config_.max_bufferpoint_size);
         reset();
-        output_file_.open(config_.out_filename, std::ios::binary | std::ios::out | std::ios::trunc);
-        if (!output_file_.is_open())
+        [[maybe_unused]] auto close_result = close();
+        output_file_ = std::make_unique<OutputFile>();
+        if (auto result = output_file_->open(config_); !result)
         {
-            return std::unexpected{ ErrorCode::writer_file_fail_to_open };
+            output_file_.reset();
+            return std::unexpected{ result.error() };
+        }
+        if (config_.is_async)
+        {
+            async_flusher_ = std::make_unique<AsyncFlusher>(
+                std::move(output_file_), config_.n_async_buffers, config_.max_bufferpoint_size);
         }
         return {};
     }
@@ -75,15 +367,27 @@ namespace centipede::writer
         return written_size;
     }
 
-    auto Binary::write_to_binary() -> std::size_t
+    auto Binary::write_to_binary() -> EnumError<std::size_t>
     {
         assert(data_buffer_.first.size() == data_buffer_.second.size());
-        const auto data_size = static_cast<uint32_t>((data_buffer_.first.size()) + (data_buffer_.second.size()));
-        auto total_written_size = std::size_t{ 0 };
-        total_written_size += write_to_file(output_file_, data_size);
-        total_written_size += write_to_file(output_file_, data_buffer_.second);
-        total_written_size += write_to_file(output_file_, data_buffer_.first);
-        return total_written_size;
+        if (async_flusher_ == nullptr)
+        {
+            if (output_file_ == nullptr)
+            {
+                return std::unexpected{ ErrorCode::writer_uninitialized };
+            }
+            return output_file_->write(data_buffer_);
+        }
+        if (auto error = async_flusher_->get_error(); not error)
+        {
+            return std::unexpected{ error.error() };
+        }
+        const auto written_size = sizeof(uint32_t) + (data_buffer_.first.size() * sizeof(uint32_t)) +
+                                  (data_buffer_.second.size() * sizeof(float));
+        auto buffer = async_flusher_->acquire_buffer();
+        std::swap(buffer, data_buffer_);
+        async_flusher_->submit(std::move(buffer));
+        return written_size;
     }
 
     void Binary::resize_data_buffer(std::size_t size)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "centipede/data/entry.hpp"
+#include "centipede/util/block_compression.hpp"
 #include "centipede/util/common_definitions.hpp"
 #include "centipede/util/error_types.hpp"
 #include "centipede/util/return_types.hpp"
@@ -9,7 +10,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <expected>
-#include <fstream>
+#include <memory>
 #include <ranges>
 #include <string>
 #include <utility>
@@ -28,6 +29,22 @@ namespace centipede::writer
      * #centipede::writer::Binary::write_current_entry(). All entrypoints added before this call are grouped into the
      * same entry.
      *
+     * If Config::is_async is true, the data is written to the file in a background thread. Calling
+     * #write_current_entry() then only swaps the filled data buffer with an empty buffer from a pool of pre-reserved
+     * buffers and passes the filled buffer to the background thread. The calling thread is only blocked if all buffers
+     * are waiting to be written. All pending buffers are written before #close() returns.
+     *
+     * If Config::compression is not common::Compression::none, the records are collected into blocks of
+     * Config::compression_block_size bytes, which are compressed before being written to the file (see
+     * common::compressed_file for the layout). Records are never split between blocks and their content is identical
+     * to the uncompressed output. #centipede::reader::Binary detects compressed files automatically. In the async
+     * mode, the compression is done in the background thread as well.
+     *
+     * If Config::index_stride is not 0, the byte offset of every Config::index_stride-th entry (or of the block
+     * starting with the first such entry in the compression mode) is recorded. The offsets are written to the index
+     * file (see common::EntryIndex) when the writer is closed. With the index, #centipede::reader::Binary::init_range()
+     * can jump to any entry, such that multiple readers can consume disjoint ranges of the same file in parallel.
+     *
      * Configuration of the class is done via the Binary::Config struct.
      *
      * #### Example usage
@@ -80,6 +97,13 @@ namespace centipede::writer
         {
             std::string out_filename = "output.bin";                     //!< Output binary filename.
             uint32_t max_bufferpoint_size = common::DEFAULT_BUFFER_SIZE; //!< maximum bufferpoint for an entry.
+            bool is_async = false;                                       //!< Write the file in a background thread.
+            std::size_t n_async_buffers = 2; //!< Number of data buffers in the async mode (2 for double buffering).
+            common::Compression compression = common::Compression::none; //!< Compression of the output file.
+            std::size_t compression_block_size = common::compressed_file::DEFAULT_BLOCK_SIZE; //!< Uncompressed size
+                                                                                               //!< of a block in bytes.
+            int compression_level = common::compressed_file::DEFAULT_LEVEL; //!< Compression level.
+            std::size_t index_stride = 0; //!< Index the position of every n-th entry (0 to disable the index file).
         };
 
         using BufferType = std::pair<std::vector<uint32_t>, std::vector<float>>; //!< Type of the #data_buffer_.
@@ -102,6 +126,16 @@ namespace centipede::writer
         {
         }
 
+        /**
+         * @brief Destructor. In the async mode, all pending data is written before the destruction.
+         */
+        ~Binary();
+
+        Binary(const Binary&) = delete;
+        auto operator=(const Binary&) -> Binary& = delete;
+        Binary(Binary&&) noexcept;
+        auto operator=(Binary&&) noexcept -> Binary&;
+
         /**
          * @brief Initialization.
          *
@@ -137,18 +171,29 @@ namespace centipede::writer
          * @brief Streaming an entry data to the output file.
          *
          * Streaming the entry data to the output file and call the reset() function to clear the internal buffer.
-         * After the function is called, the writer is waiting for a new entry to be added.
+         * After the function is called, the writer is waiting for a new entry to be added. In the async mode, the data
+         * is handed over to the background thread and written later.
          *
-         * @return Number of bytes written to the binary file.
+         * @return
+         * - Number of uncompressed bytes written (or to be written) to the binary file.
+         * - ErrorCode::writer_file_fail_to_compress if the compression of a full block fails. In the async mode, the
+         *   error from the background thread is returned by the next call after the failure.
          */
         auto write_current_entry() -> EnumError<std::size_t>;
 
         /**
          * @brief Manually close the output file handler.
          *
-         * This function will be called automatically when the destructor is called.
+         * This function will be called automatically when the destructor is called. In the async mode, it waits until
+         * all pending data is written. In the compression mode, the last incomplete block is written. The index file is
+         * written if Config::index_stride is not 0.
+         *
+         * @return
+         * - ErrorCode::writer_file_fail_to_compress if the compression of the last block (or of any block in the async
+         *   mode) fails.
+         * - ErrorCode::writer_file_fail_to_open if the index file cannot be written.
          */
-        void close() { output_file_.close(); };
+        auto close() -> EnumError<>;
 
         /**
          * @brief Getter of the configuration.
@@ -167,13 +212,17 @@ namespace centipede::writer
         constexpr auto get_buffer() const -> const BufferType& { return data_buffer_; }
 
       private:
+        class OutputFile;
+        class AsyncFlusher;
+
         bool has_entry_ = false;
-        Config config_;             //!< Member variable for the configuration.
-        BufferType data_buffer_;    //!< Data buffer to store entry_point
-        std::ofstream output_file_; //!< Output file handler
+        Config config_;                               //!< Member variable for the configuration.
+        BufferType data_buffer_;                      //!< Data buffer to store entry_point
+        std::unique_ptr<OutputFile> output_file_;     //!< Output file handler
+        std::unique_ptr<AsyncFlusher> async_flusher_; //!< Background writing thread in the async mode.
 
         auto check_buffer_size(std::size_t size_to_add) const -> bool;
-        auto write_to_binary() -> std::size_t;
+        auto write_to_binary() -> EnumError<std::size_t>;
         void reset();
         void resize_data_buffer(std::size_t size);
         auto fill_entrypoint_to_buffer(BufferPoint buffer_point, bool has_check_value = false) -> bool;
@@ -0,0 +1,300 @@
+#include "centipede/centipede.hpp"
+#include "centipede/core/engines/checkpoint.hpp"
+#include "centipede/reader/multi_file.hpp"
+#include "centipede/writer/binary.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio> // IWYU pragma: keep
+#include <cstdlib>
+#include <format>
+#include <optional>
+#include <print>
+#include <random>
+#include <ranges>
+#include <span>
+#include <spawn.h>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+// Accumulates the global system of the same data files in a single process and in several processes, whose partial
+// systems are merged by a tree reduction. Both must give the same parameters. The program calls itself with the
+// arguments `accumulate <shard index> <number of shards> <checkpoint filename>` to run the shard processes.
+
+constexpr auto N_FILES = 8U;
+constexpr auto N_PROCESSES = 3U;
+constexpr auto N_ENTRIES_PER_FILE = 300U;
+constexpr auto N_POINTS = 6U;
+constexpr auto N_LABELS = 12U;
+constexpr auto LABEL_STRIDE = 1000U;
+constexpr auto N_GLOBALS = 64U;
+constexpr auto SIGMA = 0.1F;
+constexpr auto TOLERANCE = 1e-6;
+
+namespace
+{
+    using Master = centipede::core::engine::Master<double, { .has_label_map = true }>;
+    using Checkpoint = centipede::core::engine::Checkpoint<double>;
+    using centipede::reader::MultiFile;
+
+    auto get_data_filenames() -> std::vector<std::string>
+    {
+        auto filenames = std::vector<std::string>{};
+        for (const auto file_idx : std::views::iota(0U, N_FILES))
+        {
+            filenames.push_back(std::format("distributed_{}.bin", file_idx));
+        }
+        return filenames;
+    }
+
+    // Straight tracks measured by points with two global offsets out of N_LABELS sparse labels. The first and the last
+    // points carry no global and serve as the reference of the tracks. Otherwise a common shift of all offsets is
+    // absorbed by the local parameters and the global system is singular.
+    auto write_data_files(std::span<const std::string> filenames) -> bool
+    {
+        auto rnd_engine = std::mt19937{ 1 };
+        auto rnd_label_dst = std::uniform_int_distribution<uint32_t>{ 1, N_LABELS };
+        auto rnd_float_dst = std::uniform_real_distribution<float>{ -1.F, 1.F };
+        auto rnd_noise_dst = std::normal_distribution<float>{ 0.F, SIGMA };
+        for (const auto& filename : filenames)
+        {
+            auto writer = centipede::writer::Binary{ centipede::writer::Binary::Config{ .out_filename = filename } };
+            if (auto init_err = writer.init(); not init_err.has_value())
+            {
+                std::println(stderr, "Error: {}", init_err.error());
+                return false;
+            }
+            for ([[maybe_unused]] const auto entry_idx : std::views::iota(0U, N_ENTRIES_PER_FILE))
+            {
+                const auto offset = rnd_float_dst(rnd_engine);
+                const auto slope = rnd_float_dst(rnd_engine);
+                for (const auto point_idx : std::views::iota(0U, N_POINTS))
+                {
+                    const auto position = static_cast<float>(point_idx);
+                    const auto label_0 = rnd_label_dst(rnd_engine);
+                    const auto label_1 = (label_0 % N_LABELS) + 1U;
+                    auto entry_point = centipede::EntryPoint<>{};
+                    entry_point.set_locals(1.F, position)
+                        .set_measurement(offset + (slope * position) + rnd_noise_dst(rnd_engine))
+                        .set_sigma(SIGMA);
+                    if (point_idx != 0 and point_idx != N_POINTS - 1)
+                    {
+                        entry_point.add_global(label_0 * LABEL_STRIDE, 1.F)
+                            .add_global(label_1 * LABEL_STRIDE, position / static_cast<float>(N_POINTS));
+                    }
+                    if (auto err = writer.add_entrypoint(entry_point); not err.has_value())
+                    {
+                        std::println(stderr, "Error: {}", err.error());
+                        return false;
+                    }
+                }
+                [[maybe_unused]] auto size = writer.write_current_entry();
+            }
+            writer.close();
+        }
+        return true;
+    }
+
+    auto accumulate(std::vector<std::string> filenames, Master& master) -> bool
+    {
+        auto input = MultiFile{ MultiFile::Config{ .in_filenames = std::move(filenames) } };
+        if (auto start_err = input.start(); not start_err.has_value())
+        {
+            std::println(stderr, "Error: {}", start_err.error());
+            return false;
+        }
+        auto is_ok = true;
+        while (auto batch = input.next_batch())
+        {
+            if (auto res = master.analyze(batch->get_entries()); not res.has_value())
+            {
+                std::println(stderr, "Error: {}", res.error());
+                is_ok = false;
+            }
+            input.recycle(std::move(batch.value()));
+        }
+        if (not input.is_ok())
+        {
+            std::println(stderr, "Error: {}", input.get_status());
+            return false;
+        }
+        return is_ok;
+    }
+
+    auto make_master() -> Master { return Master{ Master::Config{ .n_globals = N_GLOBALS, .alpha = 0. } }; }
+
+    auto parse_index(std::string_view arg) -> std::optional<std::size_t>
+    {
+        auto value = std::size_t{};
+        const auto [ptr, error] = std::from_chars(arg.data(), arg.data() + arg.size(), value);
+        if (error != std::errc{} or ptr != arg.data() + arg.size())
+        {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    // Entry of the shard processes.
+    auto run_shard(std::string_view shard_arg, std::string_view n_shards_arg, const std::string& out_filename) -> int
+    {
+        const auto shard_idx = parse_index(shard_arg);
+        const auto n_shards = parse_index(n_shards_arg);
+        if (not shard_idx.has_value() or not n_shards.has_value())
+        {
+            std::println(stderr, "Error: invalid shard {} of {}", shard_arg, n_shards_arg);
+            return EXIT_FAILURE;
+        }
+        auto shard_filenames = MultiFile::select_shard(get_data_filenames(), shard_idx.value(), n_shards.value());
+        if (not shard_filenames.has_value())
+        {
+            std::println(stderr, "Error: {}", shard_filenames.error());
+            return EXIT_FAILURE;
+        }
+
+        auto master = make_master();
+        if (not accumulate(std::move(shard_filenames.value()), master))
+        {
+            return EXIT_FAILURE;
+        }
+        if (auto res = master.write_checkpoint(out_filename); not res.has_value())
+        {
+            std::println(stderr, "Error: {}", res.error());
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    auto spawn_shard(std::size_t shard_idx, const std::string& out_filename) -> std::optional<pid_t>
+    {
+        auto args = std::vector<std::string>{
+            "/proc/self/exe", "accumulate", std::to_string(shard_idx), std::to_string(N_PROCESSES), out_filename
+        };
+        auto argv = std::vector<char*>{};
+        for (auto& arg : args)
+        {
+            argv.push_back(arg.data());
+        }
+        argv.push_back(nullptr);
+        auto pid = pid_t{};
+        if (posix_spawn(&pid, argv.front(), nullptr, nullptr, argv.data(), environ) != 0)
+        {
+            return std::nullopt;
+        }
+        return pid;
+    }
+
+    auto get_sorted_parameters(const Master& master)
+    {
+        auto parameters = master.get_result().parameters;
+        std::ranges::sort(parameters);
+        return parameters;
+    }
+} // namespace
+
+auto main(int argc, char** argv) -> int
+{
+    const auto args = std::span{ argv, static_cast<std::size_t>(argc) };
+    if (args.size() == 5 and std::string_view{ args[1] } == "accumulate")
+    {
+        return run_shard(args[2], args[3], args[4]);
+    }
+
+    const auto data_filenames = get_data_filenames();
+    if (not write_data_files(data_filenames))
+    {
+        return EXIT_FAILURE;
+    }
+
+    auto reference_master = make_master();
+    if (not accumulate(data_filenames, reference_master))
+    {
+        return EXIT_FAILURE;
+    }
+
+    auto part_filenames = std::vector<std::string>{};
+    auto pids = std::vector<pid_t>{};
+    for (const auto shard_idx : std::views::iota(std::size_t{ 0 }, std::size_t{ N_PROCESSES }))
+    {
+        part_filenames.push_back(std::format("distributed_part_{}.ckpt", shard_idx));
+        auto pid = spawn_shard(shard_idx, part_filenames.back());
+        if (not pid.has_value())
+        {
+            std::println(stderr, "Error: failed to spawn the process of shard {}", shard_idx);
+            return EXIT_FAILURE;
+        }
+        pids.push_back(pid.value());
+    }
+    auto is_shard_ok = true;
+    for (const auto pid : pids)
+    {
+        auto status = 0;
+        if (waitpid(pid, &status, 0) != pid or not WIFEXITED(status) or WEXITSTATUS(status) != EXIT_SUCCESS)
+        {
+            is_shard_ok = false;
+        }
+    }
+    if (not is_shard_ok)
+    {
+        std::println(stderr, "Error: a shard process failed");
+        return EXIT_FAILURE;
+    }
+
+    const auto checkpoint_filename = std::string{ "distributed.ckpt" };
+    if (auto res = Checkpoint::reduce(part_filenames, checkpoint_filename); not res.has_value())
+    {
+        std::println(stderr, "Error: {}", res.error());
+        return EXIT_FAILURE;
+    }
+    auto master = make_master();
+    if (auto res = master.add_checkpoint(checkpoint_filename); not res.has_value())
+    {
+        std::println(stderr, "Error: {}", res.error());
+        return EXIT_FAILURE;
+    }
+
+    auto reference_res = reference_master.solve();
+    auto res = master.solve();
+    if (not reference_res.has_value() or not res.has_value())
+    {
+        std::println(stderr, "Error: failed to solve the global system");
+        return EXIT_FAILURE;
+    }
+    if (master.get_result().n_entries != reference_master.get_result().n_entries)
+    {
+        std::println(stderr,
+                     "Error: {} entries accumulated by {} processes, but {} entries by a single process",
+                     master.get_result().n_entries,
+                     N_PROCESSES,
+                     reference_master.get_result().n_entries);
+        return EXIT_FAILURE;
+    }
+    const auto reference_parameters = get_sorted_parameters(reference_master);
+    const auto parameters = get_sorted_parameters(master);
+    if (parameters.size() != reference_parameters.size())
+    {
+        std::println(stderr, "Error: {} parameters, but {} expected", parameters.size(), reference_parameters.size());
+        return EXIT_FAILURE;
+    }
+    for (const auto& [par, reference_par] : std::views::zip(parameters, reference_parameters))
+    {
+        if (par.first != reference_par.first or
+            std::abs(par.second - reference_par.second) > TOLERANCE * (1. + std::abs(reference_par.second)))
+        {
+            std::println(stderr,
+                         "Error: parameter {} is {}, but {} expected",
+                         reference_par.first,
+                         par.second,
+                         reference_par.second);
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
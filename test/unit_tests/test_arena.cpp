@@ -0,0 +1,68 @@
+#include "centipede/util/arena.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <numeric>
+
+using centipede::common::Arena;
+
+namespace centipede::test
+{
+    namespace
+    {
+        auto is_aligned(const void* ptr) -> bool
+        {
+            return reinterpret_cast<std::uintptr_t>(ptr) % Arena::ALIGNMENT == 0; // NOLINT
+        }
+    } // namespace
+
+    TEST(arena, allocate)
+    {
+        auto arena = Arena{ 1024 };
+        EXPECT_EQ(arena.get_capacity(), 1024);
+
+        auto first = arena.allocate<double>(3);
+        auto second = arena.allocate<int>(5);
+        ASSERT_EQ(first.size(), 3);
+        ASSERT_EQ(second.size(), 5);
+        EXPECT_TRUE(is_aligned(first.data()));
+        EXPECT_TRUE(is_aligned(second.data()));
+        EXPECT_EQ(arena.get_size(), 2 * Arena::ALIGNMENT);
+
+        std::iota(first.begin(), first.end(), 0.);
+        std::iota(second.begin(), second.end(), 10);
+        EXPECT_EQ(first[2], 2.);
+        EXPECT_EQ(second[0], 10);
+
+        EXPECT_TRUE(arena.allocate<double>(0).empty());
+    }
+
+    TEST(arena, overflow_and_reset)
+    {
+        constexpr auto n_values = std::size_t{ 100 };
+        auto arena = Arena{};
+        EXPECT_EQ(arena.get_capacity(), 0);
+        EXPECT_EQ(arena.get_n_overflows(), 0);
+
+        auto first = arena.allocate<double>(n_values);
+        auto second = arena.allocate<double>(n_values);
+        std::iota(first.begin(), first.end(), 0.);
+        std::iota(second.begin(), second.end(), 0.);
+        EXPECT_EQ(first[n_values - 1], second[n_values - 1]);
+        const auto peak_size = arena.get_size();
+        EXPECT_GE(peak_size, 2 * n_values * sizeof(double));
+        EXPECT_EQ(arena.get_n_overflows(), 2);
+
+        arena.reset();
+        EXPECT_EQ(arena.get_size(), 0);
+        EXPECT_EQ(arena.get_capacity(), peak_size);
+
+        // The same allocations are served from the main block after the reset.
+        const auto* first_ptr = arena.allocate<double>(n_values).data();
+        const auto* second_ptr = arena.allocate<double>(n_values).data();
+        EXPECT_EQ(second_ptr - first_ptr, static_cast<std::ptrdiff_t>(peak_size / 2 / sizeof(double)));
+        EXPECT_EQ(arena.get_n_overflows(), 2);
+        arena.reset();
+        EXPECT_EQ(arena.get_capacity(), peak_size);
+    }
+} // namespace centipede::test
@@ -1,5 +1,7 @@
 #include "centipede/centipede.hpp"
 #include "centipede/reader/binary.hpp"
+#include "centipede/writer/binary.hpp"
+#include "centipede/util/entry_index.hpp"
 #include "centipede/util/error_types.hpp"
 #include <algorithm>
 #include <cstdint>
@@ -9,6 +11,7 @@
 #include <ios>
 #include <iterator>
 #include <ranges>
+#include <span>
 #include <string>
 #include <utility>
 #include <vector>
@@ -120,13 +123,13 @@ namespace centipede::test
         {
             output.first.push_back(uint32_t{ 0 });
             output.second.push_back(measurement);
-            std::ranges::copy(globals_data.first, std::back_inserter(output.first));
-            std::ranges::copy(globals_data.second, std::back_inserter(output.second));
+            std::ranges::copy(locals_data.first, std::back_inserter(output.first));
+            std::ranges::copy(locals_data.second, std::back_inserter(output.second));
 
             output.first.push_back(uint32_t{ 0 });
             output.second.push_back(sigma);
-            std::ranges::copy(locals_data.first, std::back_inserter(output.first));
-            std::ranges::copy(locals_data.second, std::back_inserter(output.second));
+            std::ranges::copy(globals_data.first, std::back_inserter(output.first));
+            std::ranges::copy(globals_data.second, std::back_inserter(output.second));
         }
 
         auto write_to_file(std::ofstream& file, const Binary::RawBufferType& buffer)
@@ -159,8 +162,9 @@ namespace centipede::test
             for (const auto& entrypoint : entry)
             {
                 EXPECT_EQ(valid_locals_data.second, entrypoint.get_locals());
-                auto expected_globals = std::views::zip_transform([](const auto& index, const auto& value) -> auto
-                                                                  { return std::pair{ index, value }; },
+                // Labels in the file are 1-based.
+                auto expected_globals = std::views::zip_transform([](const auto& label, const auto& value) -> auto
+                                                                  { return std::pair{ label - 1U, value }; },
                                                                   valid_globals_data.first,
                                                                   valid_globals_data.second) |
                                         std::ranges::to<std::vector>();
@@ -433,4 +437,439 @@ namespace centipede::test
         EXPECT_EQ(reader.get_status(), ErrorCode::reader_file_fail_to_read);
         reader.close();
     }
+
+    TEST(reader, memory_map_valid_entries)
+    {
+        // NOLINTBEGIN(readability-function-cognitive-complexity)
+        auto file_name = std::string{ "reader_memory_map_valid_entries.bin" };
+        auto file = std::ofstream{ file_name, std::ios::out | std::ios::binary | std::ios::trunc };
+        auto output_buffer = Binary::RawBufferType{ { uint32_t{ 0 } }, { 0.F } };
+        fill_buffer(output_buffer, valid_measurement, valid_locals_data, valid_sigma, valid_globals_data);
+        fill_buffer(output_buffer, valid_measurement, valid_locals_data, valid_sigma, valid_globals_data);
+        write_to_file(file, output_buffer);
+        write_to_file(file, output_buffer);
+        file.close();
+        auto reader = Binary{ Config{ .in_filename = file_name, .use_memory_map = true } };
+        auto init_err = reader.init();
+        ASSERT_TRUE(init_err);
+        for (const auto& entry : reader)
+        {
+            ASSERT_EQ(entry.size(), 2U);
+            for (const auto& entrypoint : entry)
+            {
+                EXPECT_EQ(valid_locals_data.second, entrypoint.get_locals());
+                EXPECT_EQ(entrypoint.get_globals().size(), valid_globals_data.first.size());
+                EXPECT_EQ(entrypoint.get_measurement(), valid_measurement);
+                EXPECT_EQ(entrypoint.get_sigma(), valid_sigma);
+            }
+        }
+        EXPECT_TRUE(reader.is_ok());
+        EXPECT_EQ(reader.get_n_entries(), 2U);
+        reader.close();
+        // NOLINTEND(readability-function-cognitive-complexity)
+    }
+
+    TEST(reader, memory_map_raw_entry)
+    {
+        auto file_name = std::string{ "reader_memory_map_raw_entry.bin" };
+        auto file = std::ofstream{ file_name, std::ios::out | std::ios::binary | std::ios::trunc };
+        auto output_buffer = Binary::RawBufferType{ { uint32_t{ 0 } }, { 0.F } };
+        fill_buffer(output_buffer, valid_measurement, valid_locals_data, valid_sigma, valid_globals_data);
+        write_to_file(file, output_buffer);
+        file.close();
+
+        for (const auto use_memory_map : { true, false })
+        {
+            auto reader = Binary{ Config{ .in_filename = file_name, .use_memory_map = use_memory_map } };
+            ASSERT_TRUE(reader.init());
+            auto read_res = reader.read_one_raw_entry();
+            ASSERT_TRUE(read_res);
+            EXPECT_EQ(read_res.value(), output_buffer.first.size());
+            const auto raw_entry = reader.get_current_raw_entry();
+            EXPECT_TRUE(std::ranges::equal(raw_entry.labels, output_buffer.first));
+            EXPECT_TRUE(std::ranges::equal(raw_entry.values, output_buffer.second));
+            EXPECT_TRUE(reader.get_current_entry().empty());
+            EXPECT_EQ(reader.get_n_entries(), 1U);
+
+            read_res = reader.read_one_raw_entry();
+            ASSERT_TRUE(read_res);
+            EXPECT_EQ(read_res.value(), 0U);
+            EXPECT_TRUE(reader.is_end_of_file());
+        }
+    }
+
+    TEST(reader, memory_map_truncated_entry)
+    {
+        auto file_name = std::string{ "reader_memory_map_truncated_entry.bin" };
+        auto file = std::ofstream{ file_name, std::ios::out | std::ios::binary | std::ios::trunc };
+        constexpr auto declared_entry_size = uint32_t{ 4 };
+        constexpr auto dummy_data = uint32_t{ 1 };
+        // NOLINTBEGIN (cppcoreguidelines-pro-type-reinterpret-cast)
+        file.write(reinterpret_cast<const char*>(&declared_entry_size), sizeof(declared_entry_size));
+        file.write(reinterpret_cast<const char*>(&dummy_data), sizeof(dummy_data));
+        // NOLINTEND (cppcoreguidelines-pro-type-reinterpret-cast)
+        file.close();
+        auto reader = Binary{ Config{ .in_filename = file_name, .use_memory_map = true } };
+        ASSERT_TRUE(reader.init());
+        auto read_err = reader.read_one_entry();
+        ASSERT_FALSE(read_err);
+        EXPECT_EQ(read_err.error(), ErrorCode::reader_file_fail_to_read);
+    }
+
+    TEST(reader, memory_map_nonexisting_file_error)
+    {
+        auto reader = Binary{ Config{ .in_filename = "nonexistent.bin", .use_memory_map = true } };
+        auto error = reader.init();
+        ASSERT_FALSE(error);
+        EXPECT_EQ(error.error(), ErrorCode::reader_file_fail_to_open);
+    }
+
+    TEST(reader, flat_entry_round_trip)
+    {
+        // NOLINTBEGIN(readability-function-cognitive-complexity, cppcoreguidelines-avoid-magic-numbers)
+        auto file_name = std::string{ "reader_flat_entry_round_trip.bin" };
+        auto entry_points = std::vector<EntryPoint<>>(3);
+        entry_points[0].set_locals(1.F, 0.F, 2.F).set_globals(std::pair{ 4, 1.F }, std::pair{ 7, 2.F });
+        entry_points[1].set_locals(3.F, 4.F, 5.F).set_globals(std::pair{ 0, 3.F });
+        entry_points[2].set_locals(6.F, 7.F, 8.F);
+        for (auto [idx, entry_point] : std::views::enumerate(entry_points))
+        {
+            entry_point.set_measurement(static_cast<float>(idx)).set_sigma(0.5F);
+        }
+
+        auto writer = writer::Binary{ writer::Binary::Config{ .out_filename = file_name } };
+        ASSERT_TRUE(writer.init());
+        for (const auto& entry_point : entry_points)
+        {
+            ASSERT_TRUE(writer.add_entrypoint(entry_point));
+        }
+        ASSERT_TRUE(writer.write_current_entry());
+        writer.close();
+
+        for (const auto use_memory_map : { true, false })
+        {
+            auto reader = Binary{ Config{ .in_filename = file_name, .use_memory_map = use_memory_map } };
+            ASSERT_TRUE(reader.init());
+            auto read_res = reader.read_one_flat_entry();
+            ASSERT_TRUE(read_res);
+            ASSERT_EQ(read_res.value(), entry_points.size());
+            const auto& flat_entry = reader.get_current_flat_entry();
+            for (const auto& [point, entry_point] : std::views::zip(flat_entry, entry_points))
+            {
+                EXPECT_EQ(point.get_measurement(), entry_point.get_measurement());
+                EXPECT_EQ(point.get_sigma(), entry_point.get_sigma());
+                const auto expected_locals =
+                    entry_point.get_locals() | std::views::filter([](float val) { return val != 0.F; }) |
+                    std::ranges::to<std::vector>();
+                EXPECT_TRUE(std::ranges::equal(point.get_locals(), expected_locals));
+                EXPECT_TRUE(std::ranges::equal(point.get_globals(), entry_point.get_globals()));
+            }
+            EXPECT_TRUE(std::ranges::equal(flat_entry[0].get_local_labels(), std::vector<uint32_t>{ 0, 2 }));
+            EXPECT_EQ(reader.get_n_entries(), 1U);
+
+            read_res = reader.read_one_flat_entry();
+            ASSERT_TRUE(read_res);
+            EXPECT_EQ(read_res.value(), 0U);
+            EXPECT_TRUE(reader.is_end_of_file());
+        }
+        // NOLINTEND(readability-function-cognitive-complexity, cppcoreguidelines-avoid-magic-numbers)
+    }
+
+    TEST(reader, entry_and_flat_entry_agree)
+    {
+        // NOLINTBEGIN(readability-function-cognitive-complexity, cppcoreguidelines-avoid-magic-numbers)
+        auto file_name = std::string{ "reader_entry_and_flat_entry_agree.bin" };
+        auto entry_points = std::vector<EntryPoint<>>(3);
+        entry_points[0].set_locals(1.F, 0.F, 2.F).set_globals(std::pair{ 4, 1.F }, std::pair{ 7, 2.F });
+        entry_points[1].set_locals(0.F, 3.F);
+        entry_points[2].set_locals(4.F).set_globals(std::pair{ 0, 3.F });
+        for (auto [idx, entry_point] : std::views::enumerate(entry_points))
+        {
+            entry_point.set_measurement(static_cast<float>(idx)).set_sigma(0.5F);
+        }
+
+        auto writer = writer::Binary{ writer::Binary::Config{ .out_filename = file_name } };
+        ASSERT_TRUE(writer.init());
+        for (const auto& entry_point : entry_points)
+        {
+            ASSERT_TRUE(writer.add_entrypoint(entry_point));
+        }
+        ASSERT_TRUE(writer.write_current_entry());
+        writer.close();
+
+        auto entry_reader = Binary{ Config{ .in_filename = file_name } };
+        ASSERT_TRUE(entry_reader.init());
+        auto entry_res = entry_reader.read_one_entry();
+        ASSERT_TRUE(entry_res);
+        ASSERT_EQ(entry_res.value(), entry_points.size());
+
+        auto flat_reader = Binary{ Config{ .in_filename = file_name } };
+        ASSERT_TRUE(flat_reader.init());
+        auto flat_res = flat_reader.read_one_flat_entry();
+        ASSERT_TRUE(flat_res);
+        ASSERT_EQ(flat_res.value(), entry_points.size());
+
+        for (const auto& [entry_point, point, written_point] :
+             std::views::zip(entry_reader.get_current_entry(), flat_reader.get_current_flat_entry(), entry_points))
+        {
+            EXPECT_EQ(entry_point.get_locals(), written_point.get_locals());
+            EXPECT_EQ(entry_point.get_globals(), written_point.get_globals());
+            EXPECT_EQ(entry_point.get_measurement(), point.get_measurement());
+            EXPECT_EQ(entry_point.get_sigma(), point.get_sigma());
+
+            auto non_zero_locals =
+                std::views::enumerate(entry_point.get_locals()) |
+                std::views::filter([](const auto& local) -> bool { return std::get<1>(local) != 0.F; });
+            EXPECT_TRUE(std::ranges::equal(non_zero_locals | std::views::keys, point.get_local_labels()));
+            EXPECT_TRUE(std::ranges::equal(non_zero_locals | std::views::values, point.get_local_values()));
+            EXPECT_TRUE(std::ranges::equal(entry_point.get_globals() | std::views::keys, point.get_global_labels()));
+            EXPECT_TRUE(
+                std::ranges::equal(entry_point.get_globals() | std::views::values, point.get_global_values()));
+        }
+        // NOLINTEND(readability-function-cognitive-complexity, cppcoreguidelines-avoid-magic-numbers)
+    }
+
+    TEST(reader, flat_entries_batch)
+    {
+        // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers)
+        constexpr auto n_entries = 5U;
+        constexpr auto batch_size = 2U;
+        auto file_name = std::string{ "reader_flat_entries_batch.bin" };
+        auto writer = writer::Binary{ writer::Binary::Config{ .out_filename = file_name } };
+        ASSERT_TRUE(writer.init());
+        for (const auto entry_idx : std::views::iota(0U, n_entries))
+        {
+            auto entry_point = EntryPoint<>{};
+            entry_point.set_locals(1.F, 2.F).set_globals(std::pair{ entry_idx, 3.F });
+            entry_point.set_measurement(static_cast<float>(entry_idx)).set_sigma(0.5F);
+            ASSERT_TRUE(writer.add_entrypoint(entry_point));
+            ASSERT_TRUE(writer.write_current_entry());
+        }
+        writer.close();
+
+        auto reader = Binary{ Config{ .in_filename = file_name } };
+        auto batch = std::vector<FlatEntry>(batch_size);
+        const auto uninit_err = reader.read_flat_entries(batch);
+        ASSERT_FALSE(uninit_err);
+        EXPECT_EQ(uninit_err.error(), ErrorCode::reader_uninitialized);
+        ASSERT_TRUE(reader.init());
+
+        auto n_read = 0U;
+        for (const auto expected_size : { 2U, 2U, 1U, 0U })
+        {
+            auto read_res = reader.read_flat_entries(batch);
+            ASSERT_TRUE(read_res);
+            ASSERT_EQ(read_res.value(), expected_size);
+            for (const auto& flat_entry : std::span{ batch }.first(read_res.value()))
+            {
+                ASSERT_EQ(flat_entry.size(), 1U);
+                EXPECT_EQ(flat_entry[0].get_measurement(), static_cast<float>(n_read));
+                EXPECT_TRUE(std::ranges::equal(flat_entry[0].get_global_labels(), std::vector<uint32_t>{ n_read }));
+                ++n_read;
+            }
+        }
+        EXPECT_EQ(n_read, n_entries);
+        EXPECT_EQ(reader.get_n_entries(), n_entries);
+        EXPECT_TRUE(reader.is_end_of_file());
+        // NOLINTEND(cppcoreguidelines-avoid-magic-numbers)
+    }
+
+    TEST(reader, flat_entry_missing_sigma)
+    {
+        auto file_name = std::string{ "reader_flat_entry_missing_sigma.bin" };
+        auto file = std::ofstream{ file_name, std::ios::out | std::ios::binary | std::ios::trunc };
+        auto output_buffer = Binary::RawBufferType{ { 0, 0, 1, 2 }, { 0.F, 1.F, 2.F, 3.F } };
+        write_to_file(file, output_buffer);
+        file.close();
+        auto reader = Binary{ Config{ .in_filename = file_name } };
+        ASSERT_TRUE(reader.init());
+        auto read_err = reader.read_one_flat_entry();
+        ASSERT_FALSE(read_err);
+        EXPECT_EQ(read_err.error(), ErrorCode::reader_file_fail_to_read);
+        EXPECT_EQ(reader.get_n_entries(), 0U);
+    }
+
+    namespace
+    {
+        auto read_all_raw_entries(Binary& reader) -> std::vector<Binary::RawBufferType>
+        {
+            auto entries = std::vector<Binary::RawBufferType>{};
+            while (true)
+            {
+                auto read_res = reader.read_one_raw_entry();
+                if (not read_res or read_res.value() == 0U)
+                {
+                    break;
+                }
+                const auto raw_entry = reader.get_current_raw_entry();
+                entries.emplace_back(std::vector<uint32_t>(raw_entry.labels.begin(), raw_entry.labels.end()),
+                                     std::vector<float>(raw_entry.values.begin(), raw_entry.values.end()));
+            }
+            return entries;
+        }
+    } // namespace
+
+    TEST(reader, compressed_round_trip)
+    {
+        // NOLINTBEGIN(readability-function-cognitive-complexity, cppcoreguidelines-avoid-magic-numbers)
+        constexpr auto n_entries = 50U;
+        auto write_file = [](const writer::Binary::Config& config)
+        {
+            auto writer = writer::Binary{ config };
+            ASSERT_TRUE(writer.init());
+            for (auto entry_idx : std::views::iota(0U, n_entries))
+            {
+                auto entry_point = EntryPoint<>{};
+                entry_point.set_locals(1.F, static_cast<float>(entry_idx), 2.F)
+                    .set_globals(std::pair{ entry_idx % 7, 0.5F }, std::pair{ 9, 2.F })
+                    .set_measurement(static_cast<float>(entry_idx))
+                    .set_sigma(0.5F);
+                ASSERT_TRUE(writer.add_entrypoint(entry_point));
+                ASSERT_TRUE(writer.write_current_entry());
+            }
+            writer.close();
+        };
+
+        auto plain_file_name = std::string{ "reader_compressed_round_trip_plain.bin" };
+        write_file(writer::Binary::Config{ .out_filename = plain_file_name });
+        auto plain_reader = Binary{ Config{ .in_filename = plain_file_name } };
+        ASSERT_TRUE(plain_reader.init());
+        const auto expected_entries = read_all_raw_entries(plain_reader);
+        ASSERT_EQ(expected_entries.size(), n_entries);
+
+        for (const auto is_async : { false, true })
+        {
+            auto file_name = std::string{ "reader_compressed_round_trip.bin" };
+            // Small blocks such that the entries are spread over multiple blocks.
+            write_file(writer::Binary::Config{ .out_filename = file_name,
+                                               .is_async = is_async,
+                                               .compression = common::Compression::zstd,
+                                               .compression_block_size = 256 });
+            EXPECT_LT(fs::file_size(file_name), fs::file_size(plain_file_name));
+
+            for (const auto use_memory_map : { false, true })
+            {
+                auto reader = Binary{ Config{ .in_filename = file_name, .use_memory_map = use_memory_map } };
+                ASSERT_TRUE(reader.init());
+                EXPECT_EQ(read_all_raw_entries(reader), expected_entries);
+                EXPECT_TRUE(reader.is_end_of_file());
+                EXPECT_EQ(reader.get_n_entries(), n_entries);
+
+                ASSERT_TRUE(reader.init());
+                auto n_read_entries = 0U;
+                for (const auto& entry : reader)
+                {
+                    ASSERT_EQ(entry.size(), 1U);
+                    EXPECT_EQ(entry.front().get_measurement(), static_cast<float>(n_read_entries));
+                    ++n_read_entries;
+                }
+                EXPECT_TRUE(reader.is_ok());
+                EXPECT_EQ(n_read_entries, n_entries);
+            }
+        }
+        // NOLINTEND(readability-function-cognitive-complexity, cppcoreguidelines-avoid-magic-numbers)
+    }
+
+    TEST(reader, compressed_corrupted_block)
+    {
+        auto file_name = std::string{ "reader_compressed_corrupted_block.bin" };
+        auto writer = writer::Binary{ writer::Binary::Config{ .out_filename = file_name,
+                                                              .compression = common::Compression::zstd } };
+        ASSERT_TRUE(writer.init());
+        auto entry_point = EntryPoint<>{};
+        entry_point.set_locals(1.F, 2.F).set_globals(std::pair{ 3, 4.F }).set_measurement(1.F).set_sigma(0.5F);
+        ASSERT_TRUE(writer.add_entrypoint(entry_point));
+        ASSERT_TRUE(writer.write_current_entry());
+        writer.close();
+
+        // Overwrite the uncompressed size of the first block.
+        {
+            auto file = std::fstream{ file_name, std::ios::in | std::ios::out | std::ios::binary };
+            file.seekp(static_cast<std::streamoff>(common::compressed_file::HEADER_SIZE + sizeof(uint32_t)));
+            const auto wrong_size = uint32_t{ 1 };
+            // NOLINTNEXTLINE (cppcoreguidelines-pro-type-reinterpret-cast)
+            file.write(reinterpret_cast<const char*>(&wrong_size), sizeof(wrong_size));
+        }
+
+        for (const auto use_memory_map : { false, true })
+        {
+            auto reader = Binary{ Config{ .in_filename = file_name, .use_memory_map = use_memory_map } };
+            ASSERT_TRUE(reader.init());
+            auto read_err = reader.read_one_entry();
+            ASSERT_FALSE(read_err);
+            EXPECT_EQ(read_err.error(), ErrorCode::reader_file_fail_to_decompress);
+            EXPECT_EQ(reader.get_n_entries(), 0U);
+        }
+    }
+
+    TEST(reader, index_range)
+    {
+        // NOLINTBEGIN(readability-function-cognitive-complexity, cppcoreguidelines-avoid-magic-numbers)
+        constexpr auto n_entries = 100U;
+        constexpr auto n_ranges = 3U;
+        constexpr auto n_entries_per_range = (n_entries + n_ranges - 1) / n_ranges;
+        auto file_name = std::string{ "reader_index_range.bin" };
+
+        for (const auto compression : { common::Compression::none, common::Compression::zstd })
+        {
+            auto writer = writer::Binary{ writer::Binary::Config{ .out_filename = file_name,
+                                                                  .compression = compression,
+                                                                  .compression_block_size = 256,
+                                                                  .index_stride = 8 } };
+            ASSERT_TRUE(writer.init());
+            for (auto entry_idx : std::views::iota(0U, n_entries))
+            {
+                auto entry_point = EntryPoint<>{};
+                entry_point.set_locals(1.F, 2.F)
+                    .set_globals(std::pair{ entry_idx % 5, 0.5F })
+                    .set_measurement(static_cast<float>(entry_idx))
+                    .set_sigma(0.5F);
+                ASSERT_TRUE(writer.add_entrypoint(entry_point));
+                ASSERT_TRUE(writer.write_current_entry());
+            }
+            writer.close();
+
+            auto index = common::EntryIndex{};
+            ASSERT_TRUE(index.read(common::EntryIndex::get_filename(file_name)));
+            EXPECT_EQ(index.get_n_entries(), n_entries);
+            ASSERT_FALSE(index.get_points().empty());
+            EXPECT_EQ(index.get_points().front().entry_idx, 0U);
+
+            for (const auto use_memory_map : { false, true })
+            {
+                auto measurements = std::vector<float>{};
+                for (auto range_idx : std::views::iota(0U, n_ranges))
+                {
+                    auto reader = Binary{ Config{ .in_filename = file_name, .use_memory_map = use_memory_map } };
+                    ASSERT_TRUE(
+                        reader.init_range(range_idx * n_entries_per_range, (range_idx + 1) * n_entries_per_range));
+                    for (const auto& entry : reader)
+                    {
+                        ASSERT_EQ(entry.size(), 1U);
+                        measurements.push_back(entry.front().get_measurement());
+                    }
+                    EXPECT_TRUE(reader.is_ok());
+                }
+                EXPECT_TRUE(std::ranges::equal(
+                    measurements,
+                    std::views::iota(0U, n_entries) | std::views::transform([](auto idx) -> float
+                                                                            { return static_cast<float>(idx); })));
+            }
+        }
+        // NOLINTEND(readability-function-cognitive-complexity, cppcoreguidelines-avoid-magic-numbers)
+    }
+
+    TEST(reader, index_range_missing_index)
+    {
+        auto file_name = std::string{ "reader_index_range_missing_index.bin" };
+        auto writer = writer::Binary{ writer::Binary::Config{ .out_filename = file_name } };
+        ASSERT_TRUE(writer.init());
+        writer.close();
+        EXPECT_FALSE(fs::exists(common::EntryIndex::get_filename(file_name)));
+
+        auto reader = Binary{ Config{ .in_filename = file_name } };
+        auto init_err = reader.init_range(0, 1);
+        ASSERT_FALSE(init_err);
+        EXPECT_EQ(init_err.error(), ErrorCode::reader_invalid_index);
+    }
 } // namespace centipede::test
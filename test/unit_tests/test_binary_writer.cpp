@@ -2,7 +2,11 @@
 #include <array>
 #include <cstdint>
 #include <filesystem>
+#include <fstream>
 #include <gtest/gtest.h>
+#include <ios>
+#include <iterator>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -153,5 +157,66 @@ TEST(writer, write_current_entry)
     ASSERT_TRUE(fs::exists(filename));
     EXPECT_GT(fs::file_size(filename), 0);
 }
+
+TEST(writer, async_same_file_as_sync)
+{
+    constexpr auto n_entries = 100;
+    const auto sync_filename = std::string{ "binary_writer_sync.bin" };
+    const auto async_filename = std::string{ "binary_writer_async.bin" };
+    auto sync_writer = Binary{ Config{ .out_filename = sync_filename } };
+    auto async_writer = Binary{ Config{ .out_filename = async_filename, .is_async = true } };
+    ASSERT_TRUE(sync_writer.init().has_value());
+    ASSERT_TRUE(async_writer.init().has_value());
+
+    for (auto entry_idx = 0; entry_idx < n_entries; ++entry_idx)
+    {
+        auto entry_point = valid_entry_point;
+        entry_point.set_measurement(static_cast<float>(entry_idx));
+        ASSERT_TRUE(sync_writer.add_entrypoint(entry_point).has_value());
+        ASSERT_TRUE(async_writer.add_entrypoint(entry_point).has_value());
+        auto sync_size = sync_writer.write_current_entry();
+        auto async_size = async_writer.write_current_entry();
+        ASSERT_TRUE(sync_size.has_value());
+        ASSERT_TRUE(async_size.has_value());
+        EXPECT_EQ(sync_size.value(), async_size.value());
+
+        const auto& buffer = async_writer.get_buffer();
+        EXPECT_EQ(buffer.first, std::vector{ 0U });
+        EXPECT_EQ(buffer.second, std::vector{ 0.F });
+    }
+    sync_writer.close();
+    async_writer.close();
+
+    auto read_file = [](const std::string& filename) -> std::vector<char>
+    {
+        auto file = std::ifstream{ filename, std::ios::binary };
+        return std::vector<char>{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+    };
+    const auto sync_data = read_file(sync_filename);
+    EXPECT_FALSE(sync_data.empty());
+    EXPECT_EQ(sync_data, read_file(async_filename));
+}
+
+TEST(writer, close_reports_index_error)
+{
+    for (const auto is_async : { false, true })
+    {
+        const auto filename = std::string{ "binary_writer_index_error.bin" };
+        // A directory with the name of the index file prevents the index from being written.
+        const auto index_filename = centipede::common::EntryIndex::get_filename(filename);
+        fs::create_directories(index_filename);
+
+        auto writer = Binary{ Config{ .out_filename = filename, .is_async = is_async, .index_stride = 1 } };
+        ASSERT_TRUE(writer.init().has_value());
+        ASSERT_TRUE(writer.add_entrypoint(valid_entry_point).has_value());
+        ASSERT_TRUE(writer.write_current_entry().has_value());
+
+        auto result = writer.close();
+        ASSERT_FALSE(result.has_value());
+        EXPECT_EQ(result.error(), ErrorCode::writer_file_fail_to_open);
+        EXPECT_TRUE(writer.close().has_value());
+        fs::remove_all(index_filename);
+    }
+}
 // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
 // TEST(writer, format) {}
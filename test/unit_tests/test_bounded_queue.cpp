@@ -0,0 +1,75 @@
+#include "centipede/util/bounded_queue.hpp"
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <ranges>
+#include <thread>
+#include <vector>
+
+using centipede::common::BoundedQueue;
+
+namespace centipede::test
+{
+    TEST(bounded_queue, constructor)
+    {
+        auto queue = BoundedQueue<int>{ 3 };
+        EXPECT_EQ(queue.capacity(), 3);
+        EXPECT_EQ(queue.size(), 0);
+
+        auto zero_queue = BoundedQueue<int>{ 0 };
+        EXPECT_EQ(zero_queue.capacity(), 1);
+    }
+
+    TEST(bounded_queue, push_pop_in_order)
+    {
+        auto queue = BoundedQueue<int>{ 3 };
+        EXPECT_TRUE(queue.push(1));
+        EXPECT_TRUE(queue.push(2));
+        EXPECT_EQ(queue.pop(), 1);
+        EXPECT_TRUE(queue.push(3));
+        EXPECT_TRUE(queue.push(4));
+        EXPECT_EQ(queue.size(), 3);
+        EXPECT_EQ(queue.pop(), 2);
+        EXPECT_EQ(queue.pop(), 3);
+        EXPECT_EQ(queue.pop(), 4);
+        EXPECT_EQ(queue.size(), 0);
+    }
+
+    TEST(bounded_queue, close)
+    {
+        auto queue = BoundedQueue<int>{ 2 };
+        EXPECT_TRUE(queue.push(1));
+        queue.close();
+        EXPECT_FALSE(queue.push(2));
+        EXPECT_EQ(queue.pop(), 1);
+        EXPECT_FALSE(queue.pop().has_value());
+    }
+
+    TEST(bounded_queue, multi_threads)
+    {
+        constexpr auto n_values = 1000;
+        constexpr auto n_consumers = 4;
+        auto queue = BoundedQueue<int>{ 8 };
+        auto sums = std::vector<long long>(n_consumers, 0);
+        {
+            auto consumers = std::vector<std::jthread>{};
+            for (auto& sum : sums)
+            {
+                consumers.emplace_back(
+                    [&queue, &sum]()
+                    {
+                        while (auto value = queue.pop())
+                        {
+                            sum += value.value();
+                        }
+                    });
+            }
+            for (const auto value : std::views::iota(1, n_values + 1))
+            {
+                EXPECT_TRUE(queue.push(value));
+            }
+            queue.close();
+        }
+        EXPECT_EQ(std::accumulate(sums.begin(), sums.end(), 0LL), n_values * (n_values + 1) / 2);
+    }
+} // namespace centipede::test
@@ -0,0 +1,250 @@
+#include "centipede/centipede.hpp"
+#include "centipede/core/engines/checkpoint.hpp"
+#include "centipede/util/error_types.hpp"
+#include <Eigen/Core>
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using Checkpoint = centipede::core::engine::Checkpoint<double>;
+
+namespace centipede::test
+{
+    namespace
+    {
+        using DenseGlobals = core::engine::Engine<core::engine::MatrixEngineType::eigen, double>::Globals;
+        using SparseGlobals = core::engine::Engine<core::engine::MatrixEngineType::eigen_sparse, double>::Globals;
+
+        constexpr auto n_test_globals = 9;
+
+        auto make_upper_matrix() -> Eigen::MatrixXd
+        {
+            auto matrix = Eigen::MatrixXd{ Eigen::MatrixXd::Random(n_test_globals, n_test_globals) };
+            matrix.triangularView<Eigen::StrictlyLower>().setZero();
+            // Some zero elements for the sparse format.
+            matrix.row(2).setZero();
+            return matrix;
+        }
+
+        template <typename GlobalsType>
+        auto make_globals(const Eigen::MatrixXd& matrix, const Eigen::VectorXd& rhs_vec) -> GlobalsType
+        {
+            auto globals = GlobalsType{};
+            if constexpr (std::is_same_v<GlobalsType, SparseGlobals>)
+            {
+                globals.factor_matrix = matrix.sparseView();
+            }
+            else
+            {
+                globals.factor_matrix = matrix;
+            }
+            globals.rhs_vec = rhs_vec;
+            return globals;
+        }
+
+        template <typename GlobalsType>
+        void check_round_trip(bool is_sparse_checkpoint)
+        {
+            const auto file_name = std::string{ "checkpoint_round_trip.ckpt" };
+            const auto matrix = make_upper_matrix();
+            const auto rhs_vec = Eigen::VectorXd{ Eigen::VectorXd::Random(n_test_globals) };
+            const auto log = Checkpoint::Log{ .n_entries_read = 5, .n_entries_rejected = 2 };
+            ASSERT_TRUE(Checkpoint::write(file_name, make_globals<DenseGlobals>(matrix, rhs_vec), log, {},
+                                          is_sparse_checkpoint));
+
+            auto checkpoint = Checkpoint{};
+            ASSERT_TRUE(checkpoint.open(file_name));
+            EXPECT_EQ(checkpoint.get_n_globals(), n_test_globals);
+            EXPECT_EQ(checkpoint.get_header().is_sparse, is_sparse_checkpoint ? 1U : 0U);
+
+            // Adding twice to a larger system gives twice the values in its top left corner.
+            auto globals = make_globals<GlobalsType>(Eigen::MatrixXd::Zero(n_test_globals + 2, n_test_globals + 2),
+                                                     Eigen::VectorXd::Zero(n_test_globals + 2));
+            ASSERT_TRUE(checkpoint.add_to_globals(globals));
+            ASSERT_TRUE(checkpoint.add_to_globals(globals));
+            const auto sum_matrix = Eigen::MatrixXd{ globals.factor_matrix };
+            EXPECT_TRUE(sum_matrix.topLeftCorner(n_test_globals, n_test_globals).isApprox(2. * matrix));
+            EXPECT_TRUE(sum_matrix.rightCols(2).isZero());
+            EXPECT_TRUE(globals.rhs_vec.head(n_test_globals).isApprox(2. * rhs_vec));
+
+            auto sum_log = Checkpoint::Log{ .n_entries_read = 1 };
+            checkpoint.add_to_log(sum_log);
+            EXPECT_EQ(sum_log.n_entries_read, 6);
+            EXPECT_EQ(sum_log.n_entries_rejected, 2);
+        }
+    } // namespace
+
+    TEST(checkpoint, round_trip)
+    {
+        check_round_trip<DenseGlobals>(false);
+        check_round_trip<DenseGlobals>(true);
+        check_round_trip<SparseGlobals>(false);
+        check_round_trip<SparseGlobals>(true);
+    }
+
+    TEST(checkpoint, reordered_indices)
+    {
+        // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+        const auto file_name = std::string{ "checkpoint_reordered_indices.ckpt" };
+        const auto matrix = make_upper_matrix();
+        const auto rhs_vec = Eigen::VectorXd{ Eigen::VectorXd::Random(n_test_globals) };
+        ASSERT_TRUE(Checkpoint::write(file_name, make_globals<DenseGlobals>(matrix, rhs_vec), {}));
+        auto checkpoint = Checkpoint{};
+        ASSERT_TRUE(checkpoint.open(file_name));
+
+        // Reverse the parameter order and drop the first parameter.
+        auto indices = std::vector<uint32_t>(n_test_globals);
+        for (auto idx = 0U; idx < n_test_globals; ++idx)
+        {
+            indices[idx] = (idx == 0) ? Checkpoint::skipped_index : n_test_globals - 1U - idx;
+        }
+        auto globals = make_globals<SparseGlobals>(Eigen::MatrixXd::Zero(n_test_globals, n_test_globals),
+                                                   Eigen::VectorXd::Zero(n_test_globals));
+        ASSERT_TRUE(checkpoint.add_to_globals(globals, indices));
+
+        const auto full_matrix = Eigen::MatrixXd{ matrix.selfadjointView<Eigen::Upper>() };
+        const auto sum_matrix = Eigen::MatrixXd{ globals.factor_matrix };
+        EXPECT_TRUE(sum_matrix.triangularView<Eigen::StrictlyLower>().toDenseMatrix().isZero());
+        for (auto row = 1; row < n_test_globals; ++row)
+        {
+            EXPECT_DOUBLE_EQ(globals.rhs_vec(n_test_globals - 1 - row), rhs_vec(row));
+            for (auto col = row; col < n_test_globals; ++col)
+            {
+                EXPECT_DOUBLE_EQ(sum_matrix(n_test_globals - 1 - col, n_test_globals - 1 - row), full_matrix(row, col));
+            }
+        }
+        EXPECT_EQ(globals.rhs_vec(n_test_globals - 1), 0.);
+
+        indices.front() = n_test_globals;
+        const auto out_of_bounds_err = checkpoint.add_to_globals(globals, indices);
+        ASSERT_FALSE(out_of_bounds_err);
+        EXPECT_EQ(out_of_bounds_err.error(), ErrorCode::reader_invalid_checkpoint);
+        // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+    }
+
+    TEST(checkpoint, reduce)
+    {
+        // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+        // Each part has the labels {5 * part_idx, ..., 5 * part_idx + 8}, such that consecutive parts overlap.
+        constexpr auto n_parts = 5U;
+        constexpr auto label_step = 5U;
+        constexpr auto n_labels = (label_step * (n_parts - 1U)) + n_test_globals;
+        auto file_names = std::vector<std::string>{};
+        auto expected_matrix = Eigen::MatrixXd{ Eigen::MatrixXd::Zero(n_labels, n_labels) };
+        auto expected_rhs_vec = Eigen::VectorXd{ Eigen::VectorXd::Zero(n_labels) };
+        for (auto part_idx = 0U; part_idx < n_parts; ++part_idx)
+        {
+            const auto matrix = make_upper_matrix();
+            const auto rhs_vec = Eigen::VectorXd{ Eigen::VectorXd::Random(n_test_globals) };
+            auto labels = std::vector<uint32_t>(n_test_globals);
+            for (auto idx = 0U; idx < n_test_globals; ++idx)
+            {
+                labels[idx] = (label_step * part_idx) + idx;
+            }
+            const auto offset = static_cast<Eigen::Index>(label_step * part_idx);
+            expected_matrix.block(offset, offset, n_test_globals, n_test_globals) += matrix;
+            expected_rhs_vec.segment(offset, n_test_globals) += rhs_vec;
+
+            file_names.push_back(std::format("checkpoint_reduce_{}.ckpt", part_idx));
+            ASSERT_TRUE(Checkpoint::write(file_names.back(), make_globals<DenseGlobals>(matrix, rhs_vec),
+                                          Checkpoint::Log{ .n_entries_read = part_idx + 1 }, labels,
+                                          part_idx % 2 == 0));
+        }
+
+        for (const auto is_sparse : { true, false })
+        {
+            const auto out_file_name = std::string{ "checkpoint_reduce.ckpt" };
+            ASSERT_TRUE(Checkpoint::reduce(
+                file_names, out_file_name, Checkpoint::ReduceConfig{ .n_threads = 2, .is_sparse = is_sparse }));
+            EXPECT_FALSE(std::filesystem::exists(out_file_name + ".reduce_0_0"));
+
+            auto checkpoint = Checkpoint{};
+            ASSERT_TRUE(checkpoint.open(out_file_name));
+            ASSERT_EQ(checkpoint.get_n_globals(), n_labels);
+            const auto labels = checkpoint.get_labels();
+            EXPECT_TRUE(std::ranges::is_sorted(labels));
+            EXPECT_EQ(labels.back(), n_labels - 1U);
+
+            auto globals =
+                make_globals<DenseGlobals>(Eigen::MatrixXd::Zero(n_labels, n_labels), Eigen::VectorXd::Zero(n_labels));
+            ASSERT_TRUE(checkpoint.add_to_globals(globals));
+            EXPECT_TRUE(globals.factor_matrix.isApprox(expected_matrix));
+            EXPECT_TRUE(globals.rhs_vec.isApprox(expected_rhs_vec));
+
+            auto log = Checkpoint::Log{};
+            checkpoint.add_to_log(log);
+            EXPECT_EQ(log.n_entries_read, 15);
+        }
+
+        // Checkpoints with and without labels can't be merged.
+        ASSERT_TRUE(Checkpoint::write(
+            file_names.front(), make_globals<DenseGlobals>(make_upper_matrix(), Eigen::VectorXd::Ones(n_test_globals)),
+            {}));
+        const auto reduce_err = Checkpoint::reduce(file_names, "checkpoint_reduce_invalid.ckpt");
+        ASSERT_FALSE(reduce_err);
+        EXPECT_EQ(reduce_err.error(), ErrorCode::reader_invalid_checkpoint);
+        EXPECT_FALSE(std::filesystem::exists("checkpoint_reduce_invalid.ckpt.reduce_0_1"));
+        // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+    }
+
+    TEST(checkpoint, failed_write_keeps_previous)
+    {
+        const auto file_name = std::string{ "checkpoint_failed_write.ckpt" };
+        const auto temp_file_name = file_name + ".tmp";
+        const auto globals = make_globals<DenseGlobals>(make_upper_matrix(), Eigen::VectorXd::Ones(n_test_globals));
+        ASSERT_TRUE(Checkpoint::write(file_name, globals, {}));
+        EXPECT_FALSE(std::filesystem::exists(temp_file_name));
+
+        // A partial temporary file left by a terminated process doesn't affect the checkpoint.
+        {
+            auto partial_file = std::ofstream{ temp_file_name, std::ios::binary | std::ios::trunc };
+            partial_file << "partial";
+        }
+        auto checkpoint = Checkpoint{};
+        ASSERT_TRUE(checkpoint.open(file_name));
+        EXPECT_EQ(checkpoint.get_n_globals(), n_test_globals);
+        checkpoint = Checkpoint{};
+
+        // A directory with the name of the temporary file lets the writing fail.
+        std::filesystem::remove(temp_file_name);
+        std::filesystem::create_directories(temp_file_name);
+        const auto larger_globals = make_globals<DenseGlobals>(Eigen::MatrixXd::Identity(n_test_globals + 1,
+                                                                                         n_test_globals + 1),
+                                                               Eigen::VectorXd::Ones(n_test_globals + 1));
+        auto write_err = Checkpoint::write(file_name, larger_globals, {});
+        ASSERT_FALSE(write_err);
+        EXPECT_EQ(write_err.error(), ErrorCode::writer_file_fail_to_open);
+        ASSERT_TRUE(checkpoint.open(file_name));
+        EXPECT_EQ(checkpoint.get_n_globals(), n_test_globals);
+        std::filesystem::remove_all(temp_file_name);
+    }
+
+    TEST(checkpoint, invalid_file)
+    {
+        const auto file_name = std::string{ "checkpoint_invalid_file.ckpt" };
+        const auto globals = make_globals<DenseGlobals>(make_upper_matrix(), Eigen::VectorXd::Ones(n_test_globals));
+        ASSERT_TRUE(Checkpoint::write(file_name, globals, {}));
+
+        auto float_checkpoint = core::engine::Checkpoint<float>{};
+        auto open_err = float_checkpoint.open(file_name);
+        ASSERT_FALSE(open_err);
+        EXPECT_EQ(open_err.error(), ErrorCode::reader_invalid_checkpoint);
+
+        std::filesystem::resize_file(file_name, std::filesystem::file_size(file_name) - sizeof(double));
+        auto checkpoint = Checkpoint{};
+        open_err = checkpoint.open(file_name);
+        ASSERT_FALSE(open_err);
+        EXPECT_EQ(open_err.error(), ErrorCode::reader_invalid_checkpoint);
+        EXPECT_FALSE(checkpoint.is_open());
+
+        open_err = checkpoint.open("checkpoint_missing_file.ckpt");
+        ASSERT_FALSE(open_err);
+        EXPECT_EQ(open_err.error(), ErrorCode::reader_file_fail_to_open);
+    }
+} // namespace centipede::test
@@ -1,7 +1,14 @@
 #include "centipede/centipede.hpp"
 #include "centipede/core/engines/eigen_engine.hpp"
+#include "shared.hpp"
+#include <Eigen/Cholesky>
 #include <Eigen/Core>
+#include <Eigen/LU>
+#include <Eigen/SparseCore>
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <format>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -10,6 +17,212 @@
 
 namespace centipede::test
 {
+    namespace
+    {
+        using SparseEngineClass = core::engine::Engine<core::engine::MatrixEngineType::eigen_sparse, float>;
+
+        auto make_sparse_globals(const Eigen::Matrix3f& factor_matrix, const Eigen::Vector3f& rhs_vec)
+        {
+            auto globals = SparseEngineClass::Globals{};
+            const auto upper_matrix = Eigen::Matrix3f{ factor_matrix.triangularView<Eigen::Upper>() };
+            globals.factor_matrix = upper_matrix.sparseView();
+            globals.rhs_vec = rhs_vec;
+            return globals;
+        }
+
+        template <typename EngineClass>
+        void check_iterative_solve(const EngineClass::Globals& globals, const Eigen::Vector3f& solution)
+        {
+            using core::engine::PreconditionerType;
+            using core::engine::SolverType;
+            for (const auto solver_type : { SolverType::conjugate_gradient, SolverType::minres })
+            {
+                for (const auto preconditioner : { PreconditionerType::none,
+                                                   PreconditionerType::diagonal,
+                                                   PreconditionerType::incomplete_cholesky })
+                {
+                    auto result = Result<float>{};
+                    const auto solver_config = core::engine::SolverConfig{
+                        .type = solver_type, .preconditioner = preconditioner, .tolerance = 1e-6
+                    };
+                    EngineClass::solve(globals, result, solver_config);
+                    ASSERT_EQ(result.error_status, ErrorCode::success)
+                        << std::format("Error: {}. \n result: {}", result.error_status, result);
+                    ASSERT_EQ(result.parameters.size(), 3);
+                    for (const auto [parameter, val] : std::views::zip(result.parameters, solution))
+                    {
+                        EXPECT_NEAR(parameter.second, val, 1e-4);
+                    }
+                }
+            }
+        }
+        /**
+         * @brief Compare the global system from a single entry with the reduced normal equations of the entry.
+         */
+        template <core::engine::MatrixEngineType engine_type>
+        void check_global_update()
+        {
+            // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+            using EngineClass = core::engine::Engine<engine_type, double>;
+            constexpr auto n_points = 6;
+            constexpr auto n_locals = 2;
+            constexpr auto n_globals = 5;
+
+            auto entry = FlatEntry{};
+            auto local_derivs = Eigen::MatrixXd::Zero(n_points, n_locals).eval();
+            auto global_derivs = Eigen::MatrixXd::Zero(n_points, n_globals).eval();
+            auto weights = Eigen::VectorXd::Zero(n_points).eval();
+            auto measurements = Eigen::VectorXd::Zero(n_points).eval();
+            for (const auto point_idx : std::views::iota(0, n_points))
+            {
+                const auto measurement = 0.5F * static_cast<float>(point_idx * point_idx) - 1.F;
+                const auto sigma = (point_idx % 2 == 0) ? 0.5F : 1.F;
+                entry.add_point(measurement, sigma);
+                measurements(point_idx) = measurement;
+                weights(point_idx) = 1. / (sigma * sigma);
+                for (const auto local_idx : std::views::iota(0, n_locals))
+                {
+                    const auto deriv = (local_idx == 0) ? 1.F : static_cast<float>(point_idx);
+                    entry.add_local(static_cast<uint32_t>(local_idx), deriv);
+                    local_derivs(point_idx, local_idx) = deriv;
+                }
+                for (const auto global_idx : { point_idx % n_globals, (point_idx + 2) % n_globals })
+                {
+                    const auto deriv = 1.F + (0.5F * static_cast<float>(global_idx));
+                    entry.add_global(static_cast<uint32_t>(global_idx), deriv);
+                    global_derivs(point_idx, global_idx) = deriv;
+                }
+            }
+
+            auto engine = EngineClass{ n_globals };
+            engine.fill_data(entry);
+            ASSERT_TRUE_RES(engine.analyze(0.));
+            auto globals = typename EngineClass::Globals{};
+            engine.add_to_globals(globals);
+
+            const auto local_square_inv =
+                (local_derivs.transpose() * weights.asDiagonal() * local_derivs).inverse().eval();
+            const auto local_global = (local_derivs.transpose() * weights.asDiagonal() * global_derivs).eval();
+            const auto expected_matrix = (global_derivs.transpose() * weights.asDiagonal() * global_derivs -
+                                          local_global.transpose() * local_square_inv * local_global)
+                                             .eval();
+            const auto local_solutions =
+                (local_square_inv * local_derivs.transpose() * weights.asDiagonal() * measurements).eval();
+            const auto expected_rhs = (global_derivs.transpose() * weights.asDiagonal() * measurements -
+                                       local_global.transpose() * local_solutions)
+                                          .eval();
+
+            const auto factor_matrix = Eigen::MatrixXd{ globals.factor_matrix };
+            for (const auto col : std::views::iota(0, n_globals))
+            {
+                for (const auto row : std::views::iota(0, col + 1))
+                {
+                    EXPECT_NEAR(factor_matrix(row, col), expected_matrix(row, col), 1e-8)
+                        << std::format("row: {}, col: {}", row, col);
+                }
+                EXPECT_NEAR(globals.rhs_vec(col), expected_rhs(col), 1e-8) << std::format("row: {}", col);
+            }
+            // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+        }
+
+        /**
+         * @brief Compare the local fit with down-weighted outliers and its global update with a re-weighted fit, whose
+         * local matrix is decomposed from scratch in each iteration.
+         */
+        void check_outlier_down_weighting(core::engine::OutlierWeightType weight_type, double threshold)
+        {
+            // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+            using EngineClass = core::engine::Engine<core::engine::MatrixEngineType::eigen, double>;
+            constexpr auto n_points = 10;
+            constexpr auto n_locals = 2;
+            constexpr auto n_globals = 2;
+            constexpr auto n_iterations = 4;
+            constexpr auto outlier_idx = 4;
+            constexpr auto sigma = 0.1F;
+
+            // Straight line with residuals of +-1 sigma and one outlier of 30 sigma.
+            auto entry = FlatEntry{};
+            auto local_derivs = Eigen::MatrixXd::Zero(n_points, n_locals).eval();
+            auto global_derivs = Eigen::MatrixXd::Zero(n_points, n_globals).eval();
+            auto measurements = Eigen::VectorXd::Zero(n_points).eval();
+            for (const auto point_idx : std::views::iota(0, n_points))
+            {
+                const auto position = static_cast<float>(point_idx);
+                const auto deviation = (point_idx == outlier_idx) ? 30.F : ((point_idx % 3 == 0) ? 1.F : -1.F);
+                const auto measurement = 1.F + (0.5F * position) + (deviation * sigma);
+                entry.add_point(measurement, sigma);
+                entry.add_local(0, 1.F);
+                entry.add_local(1, position);
+                entry.add_global(static_cast<uint32_t>(point_idx % n_globals), 1.F);
+                measurements(point_idx) = measurement;
+                local_derivs(point_idx, 0) = 1.;
+                local_derivs(point_idx, 1) = position;
+                global_derivs(point_idx, point_idx % n_globals) = 1.;
+            }
+
+            const auto original_weight = 1. / (static_cast<double>(sigma) * static_cast<double>(sigma));
+            const auto original_weights = Eigen::VectorXd{ Eigen::VectorXd::Constant(n_points, original_weight) };
+            auto weights = original_weights;
+            const auto fit = [&]() -> Eigen::VectorXd
+            {
+                return (local_derivs.transpose() * weights.asDiagonal() * local_derivs)
+                    .llt()
+                    .solve(local_derivs.transpose() * weights.asDiagonal() * measurements);
+            };
+            auto local_solutions = fit();
+            for ([[maybe_unused]] const auto iteration : std::views::iota(0, n_iterations))
+            {
+                const auto residuals = Eigen::VectorXd{ measurements - (local_derivs * local_solutions) };
+                for (const auto point_idx : std::views::iota(0, n_points))
+                {
+                    const auto scaled_residual =
+                        std::abs(residuals(point_idx)) * std::sqrt(original_weights(point_idx)) / threshold;
+                    const auto factor = (weight_type == core::engine::OutlierWeightType::huber)
+                                            ? std::min(1., 1. / scaled_residual)
+                                            : 1. / (1. + (scaled_residual * scaled_residual));
+                    weights(point_idx) = original_weights(point_idx) * factor;
+                }
+                local_solutions = fit();
+            }
+            const auto residuals = Eigen::VectorXd{ measurements - (local_derivs * local_solutions) };
+            EXPECT_LT(weights(outlier_idx), 0.1 * original_weights(outlier_idx));
+            EXPECT_NEAR(local_solutions(0), 1., 0.1);
+            EXPECT_NEAR(local_solutions(1), 0.5, 0.01);
+
+            auto engine = EngineClass{ n_globals };
+            engine.set_outlier_config({ .type = weight_type, .n_iterations = n_iterations });
+            engine.fill_data(entry);
+            ASSERT_TRUE_RES(engine.analyze(0.));
+            for (const auto local_idx : std::views::iota(0, n_locals))
+            {
+                EXPECT_NEAR(engine.get_local_solutions()(local_idx), local_solutions(local_idx), 1e-8);
+            }
+            const auto chi2 = residuals.dot(weights.asDiagonal() * residuals);
+            EXPECT_NEAR(engine.get_current_state().chi2, chi2, 1e-8 * chi2);
+
+            auto globals = EngineClass::Globals{};
+            engine.add_to_globals(globals);
+            const auto local_square_inv =
+                (local_derivs.transpose() * weights.asDiagonal() * local_derivs).inverse().eval();
+            const auto local_global = (local_derivs.transpose() * weights.asDiagonal() * global_derivs).eval();
+            const auto expected_matrix = (global_derivs.transpose() * weights.asDiagonal() * global_derivs -
+                                          local_global.transpose() * local_square_inv * local_global)
+                                             .eval();
+            const auto expected_rhs = (global_derivs.transpose() * weights.asDiagonal() * measurements -
+                                       local_global.transpose() * local_solutions)
+                                          .eval();
+            for (const auto col : std::views::iota(0, n_globals))
+            {
+                for (const auto row : std::views::iota(0, col + 1))
+                {
+                    EXPECT_NEAR(globals.factor_matrix(row, col), expected_matrix(row, col), 1e-6);
+                }
+                EXPECT_NEAR(globals.rhs_vec(col), expected_rhs(col), 1e-6);
+            }
+            // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+        }
+    } // namespace
+
     TEST(eigen_engine, constructor)
     {
         constexpr auto n_global_pars = 10;
@@ -44,6 +257,75 @@ namespace centipede::test
 
         const auto redundant_indicies = std::vector<std::size_t>{ 0, 2 };
         EXPECT_EQ(result.redundant_parameter_indices, redundant_indicies);
+        EXPECT_EQ(result.pivots.size(), 3);
+    }
+
+    TEST(eigen_engine, solve_rank_deficit_null_space)
+    {
+        using EngineClass = core::engine::Engine<core::engine::MatrixEngineType::eigen, double>;
+
+        // Two decoupled singular blocks of the parameters 0, 1 and 3, 4, whose null vectors are (1, 1) and (1, -1).
+        auto globals = EngineClass::Globals{};
+        globals.factor_matrix.resize(5, 5);
+        globals.factor_matrix << 1, -1, 0, 0, 0, //
+            0, 1, 0, 0, 0,                       //
+            0, 0, 2, 0, 0,                       //
+            0, 0, 0, 4, 4,                       //
+            0, 0, 0, 0, 4;
+        globals.rhs_vec = Eigen::VectorXd::Ones(5);
+
+        auto result = Result<double>{};
+        EngineClass::solve(globals, result);
+        EXPECT_EQ(result.error_status, ErrorCode::analysis_rank_deficit);
+        EXPECT_EQ(result.rank_deficit, 2);
+        EXPECT_EQ(result.pivots.size(), 5);
+        EXPECT_EQ(result.redundant_parameter_indices, (std::vector<std::size_t>{ 0, 1, 3, 4 }));
+    }
+
+    TEST(eigen_engine, solve_rank_deficit_accumulated)
+    {
+        // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+        using EngineClass = core::engine::Engine<core::engine::MatrixEngineType::eigen, double>;
+        constexpr auto n_globals = 4;
+        constexpr auto n_entries = 4;
+
+        // The parameters 0 and 1 always have the same derivatives, such that (1, -1, 0, 0) is in the null space. The
+        // local parameter is only measured by the points without globals, such that the accumulated factor matrix is
+        // exactly singular. Its largest diagonal elements belong to the parameters 0 and 1, which are pivoted first in
+        // the LDLT decomposition.
+        auto engine = EngineClass{ n_globals };
+        auto entry = FlatEntry{};
+        for (const auto entry_idx : std::views::iota(0, n_entries))
+        {
+            entry.clear();
+            for (const auto measurement : { 1.F, 2.F })
+            {
+                entry.add_point(measurement, 1.F);
+                entry.add_local(0, 1.F);
+            }
+            entry.add_point(static_cast<float>(entry_idx), 1.F);
+            entry.add_global(0, 2.F);
+            entry.add_global(1, 2.F);
+            entry.add_global(2, 1.F);
+            entry.add_point(1.F, 1.F);
+            entry.add_global(2, 1.F);
+            entry.add_global(3, 1.F);
+            entry.add_point(-1.F, 1.F);
+            entry.add_global(3, 1.F);
+            engine.fill_data(entry);
+            ASSERT_TRUE_RES(engine.analyze(0.));
+        }
+        auto globals = EngineClass::Globals{};
+        engine.add_to_globals(globals);
+
+        auto result = Result<double>{};
+        EngineClass::solve(globals, result);
+        EXPECT_EQ(result.error_status, ErrorCode::analysis_rank_deficit)
+            << std::format("Error: {}. \n result: {}", result.error_status, result);
+        EXPECT_EQ(result.rank_deficit, 1);
+        EXPECT_EQ(result.pivots.size(), n_globals);
+        EXPECT_EQ(result.redundant_parameter_indices, (std::vector<std::size_t>{ 0, 1 }));
+        // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
     }
 
     TEST(eigen_engine, solve_negative_definite)
@@ -67,6 +349,25 @@ namespace centipede::test
             << std::format("Error: {}. \n result: {}", result.error_status, result);
     }
 
+    TEST(eigen_engine, solve_slightly_negative_definite)
+    {
+        using EngineClass = core::engine::Engine<core::engine::MatrixEngineType::eigen, double>;
+
+        // The Schur complement -1e-10 is small, but far above the rounding errors.
+        auto globals = EngineClass::Globals{};
+        globals.factor_matrix.resize(3, 3);
+        globals.factor_matrix << 1, 1, 0, //
+            0, 1 - 1e-10, 0,              //
+            0, 0, 2;
+        globals.rhs_vec = Eigen::VectorXd::Ones(3);
+
+        auto result = Result<double>{};
+        EngineClass::solve(globals, result);
+        EXPECT_EQ(result.error_status, ErrorCode::analysis_global_negative_definite)
+            << std::format("Error: {}. \n result: {}", result.error_status, result);
+        EXPECT_EQ(result.pivots.size(), 3);
+    }
+
     TEST(eigen_engine, solve_zero_factor_matrix)
     {
         using EngineClass = core::engine::Engine<core::engine::MatrixEngineType::eigen, float>;
@@ -136,4 +437,478 @@ namespace centipede::test
             EXPECT_NEAR(parameter.second, val, 1e-4);
         }
     }
+
+    TEST(eigen_engine, solve_iterative)
+    {
+        using EngineClass = core::engine::Engine<core::engine::MatrixEngineType::eigen, float>;
+        auto globals = EngineClass::Globals{};
+        globals.factor_matrix.resize(3, 3);
+        globals.factor_matrix << 11, 2, 3, 2, 5, 6, 3, 6, 9;
+        globals.rhs_vec = Eigen::Vector3f{ 1.F, -2.F, 0.5F };
+        const auto solution = Eigen::Vector3f{ globals.factor_matrix.inverse() * globals.rhs_vec };
+
+        check_iterative_solve<EngineClass>(globals, solution);
+    }
+
+    TEST(eigen_engine, solve_iterative_not_converged)
+    {
+        using EngineClass = core::engine::Engine<core::engine::MatrixEngineType::eigen, float>;
+        auto globals = EngineClass::Globals{};
+        globals.factor_matrix.resize(3, 3);
+        globals.factor_matrix << 11, 2, 3, 2, 5, 6, 3, 6, 9;
+        globals.rhs_vec = Eigen::Vector3f{ 1.F, 2.F, 3.F };
+
+        auto result = Result<float>{};
+        EngineClass::solve(globals,
+                           result,
+                           core::engine::SolverConfig{ .type = core::engine::SolverType::conjugate_gradient,
+                                                       .preconditioner = core::engine::PreconditionerType::none,
+                                                       .tolerance = 1e-6,
+                                                       .max_iterations = 1 });
+        EXPECT_EQ(result.error_status, ErrorCode::analysis_solver_not_converged)
+            << std::format("Error: {}.", result.error_status);
+        EXPECT_EQ(result.n_solver_iterations, 1);
+    }
+
+    namespace
+    {
+        /**
+         * @brief Solve a factor matrix with the weak mode of a common shift, which is fixed by a constraint, and
+         * compare with the solution of the dense bordered system.
+         */
+        template <typename EngineClass>
+        void check_constrained_solve(const core::engine::SolverConfig& solver_config)
+        {
+            auto factor_matrix = Eigen::Matrix3f{};
+            factor_matrix << 2, -1, -1, -1, 2, -1, -1, -1, 2;
+            const auto rhs_vec = Eigen::Vector3f{ 1.F, 0.F, -1.F };
+            const auto constraints = std::vector<core::engine::Constraint<float>>{
+                { .terms = { { 0, 1.F }, { 1, 1.F }, { 2, 1.F } }, .value = 0.3F }
+            };
+            auto bordered_matrix = Eigen::Matrix4d{ Eigen::Matrix4d::Zero() };
+            bordered_matrix.topLeftCorner<3, 3>() = factor_matrix.cast<double>();
+            bordered_matrix.block<1, 3>(3, 0).setOnes();
+            bordered_matrix.block<3, 1>(0, 3).setOnes();
+            const auto bordered_rhs = Eigen::Vector4d{ 1., 0., -1., 0.3 };
+            const auto solution = Eigen::Vector4d{ bordered_matrix.fullPivLu().solve(bordered_rhs) };
+
+            auto globals = typename EngineClass::Globals{};
+            if constexpr (EngineClass::is_sparse)
+            {
+                globals = make_sparse_globals(factor_matrix, rhs_vec);
+            }
+            else
+            {
+                globals.factor_matrix = factor_matrix;
+                globals.factor_matrix.template triangularView<Eigen::StrictlyLower>().setZero();
+                globals.rhs_vec = rhs_vec;
+            }
+
+            auto result = Result<float>{};
+            EngineClass::solve(globals, constraints, result, solver_config);
+            ASSERT_EQ(result.error_status, ErrorCode::success) << std::format("Error: {}.", result.error_status);
+            ASSERT_EQ(result.parameters.size(), 3);
+            for (const auto [parameter, val] : std::views::zip(result.parameters, solution.head<3>()))
+            {
+                EXPECT_NEAR(parameter.second, val, 1e-4);
+            }
+        }
+    } // namespace
+
+    TEST(eigen_engine, solve_constrained)
+    {
+        using EngineClass = core::engine::Engine<core::engine::MatrixEngineType::eigen, float>;
+        check_constrained_solve<EngineClass>({});
+        check_constrained_solve<SparseEngineClass>({});
+    }
+
+    TEST(eigen_engine, solve_constrained_iterative)
+    {
+        using EngineClass = core::engine::Engine<core::engine::MatrixEngineType::eigen, float>;
+        for (const auto preconditioner : { core::engine::PreconditionerType::none,
+                                           core::engine::PreconditionerType::diagonal,
+                                           core::engine::PreconditionerType::incomplete_cholesky })
+        {
+            const auto config = core::engine::SolverConfig{ .type = core::engine::SolverType::conjugate_gradient,
+                                                            .preconditioner = preconditioner };
+            check_constrained_solve<EngineClass>(config);
+            check_constrained_solve<SparseEngineClass>(config);
+        }
+    }
+
+    TEST(eigen_engine, solve_constrained_singular)
+    {
+        // The constraint doesn't fix the common shift.
+        auto factor_matrix = Eigen::Matrix3f{};
+        factor_matrix << 2, -1, -1, -1, 2, -1, -1, -1, 2;
+        const auto globals = make_sparse_globals(factor_matrix, Eigen::Vector3f{ 1.F, 0.F, -1.F });
+        const auto constraints =
+            std::vector<core::engine::Constraint<float>>{ { .terms = { { 0, 1.F }, { 1, -1.F } }, .value = 0.F } };
+
+        auto result = Result<float>{};
+        SparseEngineClass::solve(globals, constraints, result);
+        EXPECT_EQ(result.error_status, ErrorCode::analysis_rank_deficit);
+    }
+
+    namespace
+    {
+        /**
+         * @brief Compare the parameter errors with the square roots of the diagonal of the inverse factor matrix.
+         */
+        template <typename EngineClass>
+        void check_parameter_errors()
+        {
+            // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+            constexpr auto n_globals = 30;
+            auto factor_matrix = Eigen::MatrixXd{ Eigen::MatrixXd::Zero(n_globals, n_globals) };
+            for (const auto idx : std::views::iota(0, n_globals))
+            {
+                factor_matrix(idx, idx) = 4. + (idx % 3);
+                if (idx + 1 < n_globals)
+                {
+                    factor_matrix(idx, idx + 1) = -1.;
+                }
+                if (idx + 7 < n_globals)
+                {
+                    factor_matrix(idx, idx + 7) = 0.5;
+                }
+            }
+            const auto inverse_diagonal = Eigen::VectorXd{
+                Eigen::MatrixXd{ factor_matrix.selfadjointView<Eigen::Upper>() }.inverse().diagonal()
+            };
+
+            auto globals = typename EngineClass::Globals{};
+            if constexpr (EngineClass::is_sparse)
+            {
+                globals.factor_matrix = factor_matrix.sparseView();
+            }
+            else
+            {
+                globals.factor_matrix = factor_matrix;
+            }
+            globals.rhs_vec = Eigen::VectorXd::Ones(n_globals);
+
+            auto result = Result<double>{};
+            EngineClass::solve(globals, result);
+            ASSERT_EQ(result.error_status, ErrorCode::success);
+            EXPECT_TRUE(result.errors.empty());
+
+            EngineClass::solve(globals, result, { .compute_errors = true });
+            ASSERT_EQ(result.error_status, ErrorCode::success);
+            ASSERT_EQ(result.errors.size(), n_globals);
+            for (const auto [idx, error] : std::views::enumerate(result.errors))
+            {
+                EXPECT_EQ(error.first, idx);
+                EXPECT_NEAR(error.second, std::sqrt(inverse_diagonal(idx)), 1e-12);
+            }
+
+            // The iterative solvers don't compute the errors.
+            EngineClass::solve(
+                globals, result, { .type = core::engine::SolverType::conjugate_gradient, .compute_errors = true });
+            ASSERT_EQ(result.error_status, ErrorCode::success);
+            EXPECT_TRUE(result.errors.empty());
+            // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+        }
+    } // namespace
+
+    TEST(eigen_engine, solve_parameter_errors)
+    {
+        check_parameter_errors<core::engine::Engine<core::engine::MatrixEngineType::eigen, double>>();
+    }
+
+    TEST(eigen_sparse_engine, solve_parameter_errors)
+    {
+        check_parameter_errors<core::engine::Engine<core::engine::MatrixEngineType::eigen_sparse, double>>();
+    }
+
+    TEST(eigen_engine, global_update)
+    {
+        check_global_update<core::engine::MatrixEngineType::eigen>();
+    }
+
+    TEST(eigen_engine, outlier_down_weighting)
+    {
+        // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+        check_outlier_down_weighting(core::engine::OutlierWeightType::huber, 1.345);
+        check_outlier_down_weighting(core::engine::OutlierWeightType::cauchy, 2.3849);
+        // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+    }
+
+    TEST(eigen_engine, outlier_down_weighting_keeps_entry)
+    {
+        // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+        using DenseMaster = core::engine::Master<double>;
+        auto entry = FlatEntry{};
+        for (const auto point_idx : std::views::iota(0, 8))
+        {
+            const auto position = static_cast<float>(point_idx);
+            entry.add_point((point_idx == 3) ? 5.F : position, 0.1F);
+            entry.add_local(0, 1.F);
+            entry.add_local(1, position);
+            entry.add_global(0, 1.F);
+        }
+
+        auto master = DenseMaster{ DenseMaster::Config{ .n_globals = 1 } };
+        const auto res = master.analyze(entry);
+        ASSERT_FALSE(res.has_value());
+        EXPECT_EQ(res.error(), ErrorCode::analysis_local_fit_rejected);
+
+        auto robust_master = DenseMaster{ DenseMaster::Config{
+            .n_globals = 1, .outlier = { .type = core::engine::OutlierWeightType::cauchy, .n_iterations = 5 } } };
+        ASSERT_TRUE_RES(robust_master.analyze(entry));
+        EXPECT_NEAR(robust_master.get_engine().get_local_solutions()(1), 1., 1e-3);
+        // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+    }
+
+    TEST(eigen_engine, upper_triangle_only)
+    {
+        using DenseMaster = core::engine::Master<double>;
+        constexpr auto n_entries = 20;
+        constexpr auto n_points = 10;
+
+        auto master = DenseMaster{ DenseMaster::Config{ .n_globals = DEFAULT_MAX_GLOBAL_ID, .alpha = 0. } };
+        for ([[maybe_unused]] const auto entry_idx : std::views::iota(0, n_entries))
+        {
+            for (const auto& entry_point : generate_random_entry_points(n_points))
+            {
+                ASSERT_TRUE_RES(master.add_entrypoint(entry_point));
+            }
+            [[maybe_unused]] auto res = master.analyze();
+        }
+
+        const auto& factor_matrix = master.get_engine().get_global_factor_matrix();
+        EXPECT_FALSE(factor_matrix.template triangularView<Eigen::Upper>().toDenseMatrix().isZero());
+        EXPECT_TRUE(factor_matrix.template triangularView<Eigen::StrictlyLower>().toDenseMatrix().isZero());
+    }
+
+    TEST(eigen_engine, steady_state_scratch_memory)
+    {
+        using DenseMaster = core::engine::Master<double>;
+        constexpr auto n_entries = 50;
+        constexpr auto n_points = 10;
+
+        auto master = DenseMaster{ DenseMaster::Config{ .n_globals = DEFAULT_MAX_GLOBAL_ID, .alpha = 0. } };
+        const auto analyze_entries = [&master]()
+        {
+            for ([[maybe_unused]] const auto entry_idx : std::views::iota(0, n_entries))
+            {
+                for (const auto& entry_point : generate_random_entry_points(n_points))
+                {
+                    ASSERT_TRUE_RES(master.add_entrypoint(entry_point));
+                }
+                [[maybe_unused]] auto res = master.analyze();
+            }
+        };
+
+        analyze_entries();
+        const auto capacity = master.get_engine().get_arena().get_capacity();
+        EXPECT_GT(capacity, 0);
+        analyze_entries();
+        EXPECT_EQ(master.get_engine().get_arena().get_capacity(), capacity);
+    }
+
+    TEST(eigen_engine, no_arena_overflow_after_warm_up)
+    {
+        using DenseMaster = core::engine::Master<double>;
+        constexpr auto n_entries = 50;
+        constexpr auto n_points = 10;
+
+        auto entries = std::vector<std::vector<EntryPoint<>>>{};
+        for ([[maybe_unused]] const auto entry_idx : std::views::iota(0, n_entries))
+        {
+            entries.push_back(generate_random_entry_points(n_points));
+        }
+
+        auto master = DenseMaster{ DenseMaster::Config{ .n_globals = DEFAULT_MAX_GLOBAL_ID, .alpha = 0. } };
+        const auto analyze_entries = [&master, &entries]()
+        {
+            for (const auto& entry : entries)
+            {
+                for (const auto& entry_point : entry)
+                {
+                    ASSERT_TRUE_RES(master.add_entrypoint(entry_point));
+                }
+                [[maybe_unused]] auto res = master.analyze();
+            }
+        };
+
+        analyze_entries();
+        const auto& arena = master.get_engine().get_arena();
+        const auto n_overflows = arena.get_n_overflows();
+        EXPECT_GT(n_overflows, 0);
+        analyze_entries();
+        EXPECT_EQ(arena.get_n_overflows(), n_overflows);
+    }
+
+    TEST(eigen_engine, fixed_n_locals_same_result_as_dynamic)
+    {
+        // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+        using DynamicMaster = core::engine::Master<double>;
+        using FixedMaster = core::engine::Master<double, { .n_locals = DEFAULT_N_LOCALS }>;
+        constexpr auto n_entries = 100;
+        constexpr auto n_points = 10;
+
+        auto dynamic_master =
+            DynamicMaster{ DynamicMaster::Config{ .n_globals = DEFAULT_MAX_GLOBAL_ID, .alpha = 0. } };
+        auto fixed_master = FixedMaster{ FixedMaster::Config{ .n_globals = DEFAULT_MAX_GLOBAL_ID, .alpha = 0. } };
+
+        for ([[maybe_unused]] const auto entry_idx : std::views::iota(0, n_entries))
+        {
+            for (const auto& entry_point : generate_random_entry_points(n_points))
+            {
+                ASSERT_TRUE_RES(dynamic_master.add_entrypoint(entry_point));
+                ASSERT_TRUE_RES(fixed_master.add_entrypoint(entry_point));
+            }
+            const auto dynamic_res = dynamic_master.analyze();
+            const auto fixed_res = fixed_master.analyze();
+            ASSERT_EQ(dynamic_res.has_value(), fixed_res.has_value());
+            const auto& dynamic_locals = dynamic_master.get_engine().get_local_solutions();
+            const auto& fixed_locals = fixed_master.get_engine().get_local_solutions();
+            ASSERT_EQ(dynamic_locals.size(), fixed_locals.size());
+            for (const auto& [dynamic_val, fixed_val] : std::views::zip(dynamic_locals, fixed_locals))
+            {
+                EXPECT_NEAR(dynamic_val, fixed_val, 1e-8 * (1. + std::abs(dynamic_val)));
+            }
+        }
+
+        ASSERT_EQ(dynamic_master.solve().has_value(), fixed_master.solve().has_value());
+        const auto& dynamic_parameters = dynamic_master.get_result().parameters;
+        const auto& fixed_parameters = fixed_master.get_result().parameters;
+        ASSERT_EQ(dynamic_parameters.size(), fixed_parameters.size());
+        for (const auto& [dynamic_par, fixed_par] : std::views::zip(dynamic_parameters, fixed_parameters))
+        {
+            EXPECT_NEAR(dynamic_par.second, fixed_par.second, 1e-6 * (1. + std::abs(dynamic_par.second)));
+        }
+        // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+    }
+
+    TEST(eigen_engine, fixed_n_locals_incompatible_entry)
+    {
+        using FixedMaster = core::engine::Master<double, { .n_locals = DEFAULT_N_LOCALS }>;
+        auto master = FixedMaster{ FixedMaster::Config{ .n_globals = DEFAULT_MAX_GLOBAL_ID } };
+
+        const auto entry_points = generate_random_entry_points(1, DEFAULT_N_GLOBALS, DEFAULT_N_LOCALS + 1);
+        const auto res = master.add_entrypoint(entry_points.front());
+        ASSERT_FALSE(res.has_value());
+        EXPECT_EQ(res.error(), ErrorCode::handler_incomp_n_locals);
+
+        auto flat_entry = FlatEntry{};
+        flat_entry.add_point(1.F, 1.F);
+        flat_entry.add_local(DEFAULT_N_LOCALS, 1.F);
+        const auto flat_res = master.analyze(flat_entry);
+        ASSERT_FALSE(flat_res.has_value());
+        EXPECT_EQ(flat_res.error(), ErrorCode::handler_incomp_n_locals);
+    }
+
+    TEST(eigen_sparse_engine, constructor)
+    {
+        constexpr auto n_global_pars = 10;
+        auto engine = SparseEngineClass{ n_global_pars };
+        const auto& factor_matrix = engine.get_global_factor_matrix();
+        EXPECT_EQ(factor_matrix.rows(), n_global_pars);
+        EXPECT_EQ(factor_matrix.cols(), n_global_pars);
+        EXPECT_EQ(factor_matrix.nonZeros(), 0);
+        const auto& rhs_vec = engine.get_global_rhs_vector();
+        EXPECT_EQ(rhs_vec.rows(), n_global_pars);
+    }
+
+    TEST(eigen_sparse_engine, global_update)
+    {
+        check_global_update<core::engine::MatrixEngineType::eigen_sparse>();
+    }
+
+    TEST(eigen_sparse_engine, solve)
+    {
+        auto result = Result<float>{};
+        auto factor_matrix = Eigen::Matrix3f{};
+        factor_matrix << 11, 2, 3, 2, 5, 6, 3, 6, 9;
+        const auto rhs_vec = Eigen::Vector3f{ 1.F, 2.F, 3.F };
+        const auto globals = make_sparse_globals(factor_matrix, rhs_vec);
+        const auto solution = (factor_matrix.inverse() * rhs_vec).eval();
+
+        SparseEngineClass::solve(globals, result);
+        ASSERT_EQ(result.error_status, ErrorCode::success)
+            << std::format("Error: {}. \n result: {}", result.error_status, result);
+
+        ASSERT_EQ(result.parameters.size(), 3);
+        for (const auto [parameter, val] : std::views::zip(result.parameters, solution))
+        {
+            EXPECT_NEAR(parameter.second, val, 1e-4);
+        }
+    }
+
+    TEST(eigen_sparse_engine, solve_iterative)
+    {
+        auto factor_matrix = Eigen::Matrix3f{};
+        factor_matrix << 11, 2, 3, 2, 5, 6, 3, 6, 9;
+        const auto rhs_vec = Eigen::Vector3f{ 1.F, -2.F, 0.5F };
+        const auto solution = Eigen::Vector3f{ factor_matrix.inverse() * rhs_vec };
+
+        check_iterative_solve<SparseEngineClass>(make_sparse_globals(factor_matrix, rhs_vec), solution);
+    }
+
+    TEST(eigen_sparse_engine, solve_rank_deficit)
+    {
+        auto result = Result<float>{};
+        auto factor_matrix = Eigen::Matrix3f{};
+        factor_matrix << 1, 2, 3, 2, 5, 6, 3, 6, 9;
+        const auto globals = make_sparse_globals(factor_matrix, Eigen::Vector3f{ 1.F, 2.F, 3.F });
+
+        SparseEngineClass::solve(globals, result);
+        EXPECT_EQ(result.error_status, ErrorCode::analysis_rank_deficit);
+        EXPECT_EQ(result.rank_deficit, 1);
+    }
+
+    TEST(eigen_sparse_engine, solve_negative_definite)
+    {
+        auto result = Result<float>{};
+        auto factor_matrix = Eigen::Matrix3f{};
+        factor_matrix << 1, 2, 11, 2, 5, 6, 11, 6, 9;
+        const auto globals = make_sparse_globals(factor_matrix, Eigen::Vector3f{ 1.F, 2.F, 3.F });
+
+        SparseEngineClass::solve(globals, result);
+        EXPECT_EQ(result.error_status, ErrorCode::analysis_global_negative_definite);
+    }
+
+    TEST(eigen_sparse_engine, solve_zero_factor_matrix)
+    {
+        auto result = Result<float>{};
+        const auto globals = make_sparse_globals(Eigen::Matrix3f::Zero(), Eigen::Vector3f{ 1.F, 2.F, 3.F });
+
+        SparseEngineClass::solve(globals, result);
+        EXPECT_EQ(result.error_status, ErrorCode::analysis_factor_matrix_zero);
+    }
+
+    TEST(eigen_sparse_engine, same_result_as_dense)
+    {
+        // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+        using DenseMaster = core::engine::Master<double>;
+        using SparseMaster = core::engine::Master<double, { .engine_type = EngineType::eigen_sparse }>;
+        constexpr auto n_entries = 100;
+        constexpr auto n_points = 10;
+
+        auto dense_master = DenseMaster{ DenseMaster::Config{ .n_globals = DEFAULT_MAX_GLOBAL_ID, .alpha = 0. } };
+        auto sparse_master = SparseMaster{ SparseMaster::Config{ .n_globals = DEFAULT_MAX_GLOBAL_ID, .alpha = 0. } };
+
+        for ([[maybe_unused]] const auto entry_idx : std::views::iota(0, n_entries))
+        {
+            for (const auto& entry_point : generate_random_entry_points(n_points))
+            {
+                ASSERT_TRUE_RES(dense_master.add_entrypoint(entry_point));
+                ASSERT_TRUE_RES(sparse_master.add_entrypoint(entry_point));
+            }
+            [[maybe_unused]] auto dense_res = dense_master.analyze();
+            [[maybe_unused]] auto sparse_res = sparse_master.analyze();
+        }
+
+        ASSERT_EQ(dense_master.solve().has_value(), sparse_master.solve().has_value());
+        const auto& dense_parameters = dense_master.get_result().parameters;
+        const auto& sparse_parameters = sparse_master.get_result().parameters;
+        ASSERT_EQ(dense_parameters.size(), sparse_parameters.size());
+        for (const auto& [dense_par, sparse_par] : std::views::zip(dense_parameters, sparse_parameters))
+        {
+            EXPECT_NEAR(dense_par.second, sparse_par.second, 1e-6 * (1. + std::abs(dense_par.second)));
+        }
+        // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+    }
 } // namespace centipede::test
@@ -1,5 +1,9 @@
 #include "centipede/centipede.hpp"
+#include "centipede/data/flat_entry.hpp"
+#include <algorithm>
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <format>
 #include <gtest/gtest.h>
 #include <utility>
@@ -106,3 +110,68 @@ TEST(dynamic_entrypoint, add_elements)
     EXPECT_EQ(entry.get_globals(), global_test);
 }
 // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+
+TEST(flat_entry, add_points)
+{
+    // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+    auto entry = centipede::FlatEntry{};
+    entry.clear();
+    EXPECT_TRUE(entry.empty());
+
+    entry.add_point(1.F);
+    entry.add_local(0, 2.F);
+    entry.add_local(2, 3.F);
+    entry.set_sigma(0.5F);
+    entry.add_global(10, 4.F);
+    entry.add_point(5.F, 0.1F);
+    entry.add_global(3, 6.F);
+
+    ASSERT_EQ(entry.size(), 2);
+    EXPECT_EQ(entry[0].get_measurement(), 1.F);
+    EXPECT_EQ(entry[0].get_sigma(), 0.5F);
+    EXPECT_TRUE(std::ranges::equal(entry[0].get_locals(), std::vector{ 2.F, 3.F }));
+    EXPECT_TRUE(std::ranges::equal(entry[0].get_local_labels(), std::vector<uint32_t>{ 0, 2 }));
+    EXPECT_TRUE(std::ranges::equal(entry[0].get_globals(), std::vector{ std::pair<uint32_t, float>{ 10, 4.F } }));
+    EXPECT_EQ(entry[1].get_measurement(), 5.F);
+    EXPECT_EQ(entry[1].get_sigma(), 0.1F);
+    EXPECT_TRUE(entry[1].get_locals().empty());
+    EXPECT_TRUE(std::ranges::equal(entry[1].get_globals(), std::vector{ std::pair<uint32_t, float>{ 3, 6.F } }));
+    EXPECT_TRUE(std::ranges::equal(entry.get_global_offsets(), std::vector<uint32_t>{ 0, 1, 2 }));
+    // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+
+    auto n_points = std::size_t{};
+    for ([[maybe_unused]] const auto& point : entry)
+    {
+        ++n_points;
+    }
+    EXPECT_EQ(n_points, entry.size());
+
+    entry.clear();
+    EXPECT_TRUE(entry.empty());
+    EXPECT_TRUE(entry.get_local_labels().empty());
+    EXPECT_TRUE(std::ranges::equal(entry.get_local_offsets(), std::vector<uint32_t>{ 0 }));
+}
+
+TEST(flat_entry, remove_globals_if)
+{
+    // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+    auto entry = centipede::FlatEntry{};
+    entry.add_point(1.F, 1.F);
+    entry.add_global(1, 1.F);
+    entry.add_global(7, 2.F);
+    entry.add_global(2, 3.F);
+    entry.add_point(2.F, 1.F);
+    entry.add_global(8, 4.F);
+    entry.add_point(3.F, 1.F);
+    entry.add_global(3, 5.F);
+
+    entry.remove_globals_if([](uint32_t label) { return label > 5; });
+    ASSERT_EQ(entry.size(), 3);
+    EXPECT_TRUE(std::ranges::equal(entry.get_global_offsets(), std::vector<uint32_t>{ 0, 2, 2, 3 }));
+    EXPECT_TRUE(std::ranges::equal(entry[0].get_global_labels(), std::vector<uint32_t>{ 1, 2 }));
+    EXPECT_TRUE(std::ranges::equal(entry[0].get_global_values(), std::vector{ 1.F, 3.F }));
+    EXPECT_TRUE(entry[1].get_global_labels().empty());
+    EXPECT_TRUE(std::ranges::equal(entry[2].get_global_labels(), std::vector<uint32_t>{ 3 }));
+    EXPECT_TRUE(std::ranges::equal(entry[2].get_global_values(), std::vector{ 5.F }));
+    // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+}
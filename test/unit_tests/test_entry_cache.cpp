@@ -0,0 +1,132 @@
+#include "centipede/data/flat_entry.hpp"
+#include "centipede/reader/entry_cache.hpp"
+#include "centipede/util/error_types.hpp"
+#include "centipede/util/return_types.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <ranges>
+#include <span>
+#include <string>
+#include <vector>
+
+using centipede::reader::EntryCache;
+
+namespace centipede::test
+{
+    namespace
+    {
+        // Entry `entry_idx` has `entry_idx % 4 + 1` points with two local and `entry_idx % 3` global derivatives.
+        auto make_entry(uint32_t entry_idx) -> FlatEntry
+        {
+            // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+            auto entry = FlatEntry{};
+            for (const auto point_idx : std::views::iota(0U, (entry_idx % 4U) + 1U))
+            {
+                const auto value = static_cast<float>((entry_idx * 10U) + point_idx);
+                entry.add_point(value, 0.1F * (value + 1.F));
+                entry.add_local(0, 1.F);
+                entry.add_local(1, value);
+                for (const auto global_idx : std::views::iota(0U, entry_idx % 3U))
+                {
+                    entry.add_global(entry_idx + global_idx, -value);
+                }
+            }
+            return entry;
+            // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+        }
+
+        void expect_equal_entries(const FlatEntry& entry, const FlatEntry& expected_entry)
+        {
+            EXPECT_EQ(entry.get_n_locals(), expected_entry.get_n_locals());
+            EXPECT_TRUE(std::ranges::equal(entry.get_measurements(), expected_entry.get_measurements()));
+            EXPECT_TRUE(std::ranges::equal(entry.get_sigmas(), expected_entry.get_sigmas()));
+            EXPECT_TRUE(std::ranges::equal(entry.get_local_offsets(), expected_entry.get_local_offsets()));
+            EXPECT_TRUE(std::ranges::equal(entry.get_local_labels(), expected_entry.get_local_labels()));
+            EXPECT_TRUE(std::ranges::equal(entry.get_local_values(), expected_entry.get_local_values()));
+            EXPECT_TRUE(std::ranges::equal(entry.get_global_offsets(), expected_entry.get_global_offsets()));
+            EXPECT_TRUE(std::ranges::equal(entry.get_global_labels(), expected_entry.get_global_labels()));
+            EXPECT_TRUE(std::ranges::equal(entry.get_global_values(), expected_entry.get_global_values()));
+        }
+
+        void check_round_trip(const std::string& spill_filename)
+        {
+            // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+            constexpr auto n_entries = 50U;
+            auto entries = std::vector<FlatEntry>{};
+            for (const auto entry_idx : std::views::iota(0U, n_entries))
+            {
+                entries.push_back(make_entry(entry_idx));
+            }
+            entries.emplace_back();
+
+            auto cache = EntryCache{ EntryCache::Config{
+                .spill_filename = spill_filename, .batch_size = 7, .spill_buffer_size = 256 } };
+            ASSERT_TRUE(cache.add(std::span{ entries }.first(10)));
+            ASSERT_TRUE(cache.add(std::span{ entries }.subspan(10)));
+            EXPECT_EQ(cache.get_n_entries(), n_entries);
+
+            const auto unfinished_err =
+                cache.for_each_batch([](std::span<const FlatEntry>) -> EnumError<> { return {}; });
+            ASSERT_FALSE(unfinished_err);
+            EXPECT_EQ(unfinished_err.error(), ErrorCode::reader_uninitialized);
+
+            ASSERT_TRUE(cache.finish());
+            const auto finished_err = cache.add(entries.front());
+            ASSERT_FALSE(finished_err);
+            EXPECT_EQ(finished_err.error(), ErrorCode::writer_uninitialized);
+
+            // Each replay gives the same entries in batches of at most 7 entries.
+            for ([[maybe_unused]] const auto replay_idx : std::views::iota(0, 2))
+            {
+                auto entry_idx = std::size_t{};
+                ASSERT_TRUE(cache.for_each_batch(
+                    [&entry_idx, &entries](std::span<const FlatEntry> batch) -> EnumError<>
+                    {
+                        EXPECT_LE(batch.size(), 7);
+                        for (const auto& entry : batch)
+                        {
+                            expect_equal_entries(entry, entries[entry_idx]);
+                            ++entry_idx;
+                        }
+                        return {};
+                    }));
+                EXPECT_EQ(entry_idx, n_entries);
+            }
+
+            // The replay stops at the first error.
+            auto n_batches = 0;
+            const auto replay_err = cache.for_each_batch(
+                [&n_batches](std::span<const FlatEntry>) -> EnumError<>
+                {
+                    ++n_batches;
+                    return std::unexpected{ ErrorCode::handler_incomp_n_locals };
+                });
+            ASSERT_FALSE(replay_err);
+            EXPECT_EQ(replay_err.error(), ErrorCode::handler_incomp_n_locals);
+            EXPECT_EQ(n_batches, 1);
+            // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+        }
+    } // namespace
+
+    TEST(entry_cache, in_memory)
+    {
+        check_round_trip("");
+    }
+
+    TEST(entry_cache, spill_file)
+    {
+        const auto spill_filename = std::string{ "entry_cache_spill_file.cache" };
+        check_round_trip(spill_filename);
+        EXPECT_FALSE(std::filesystem::exists(spill_filename));
+
+        auto invalid_cache = EntryCache{ EntryCache::Config{ .spill_filename = "entry_cache_missing_dir/entries.cache",
+                                                             .spill_buffer_size = 1 } };
+        const auto add_err = invalid_cache.add(make_entry(1));
+        ASSERT_FALSE(add_err);
+        EXPECT_EQ(add_err.error(), ErrorCode::writer_file_fail_to_open);
+    }
+} // namespace centipede::test
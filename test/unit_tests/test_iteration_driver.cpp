@@ -0,0 +1,152 @@
+#include "centipede/centipede.hpp"
+#include "centipede/core/iteration_driver.hpp"
+#include "centipede/reader/multi_file.hpp"
+#include "centipede/writer/binary.hpp"
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <gtest/gtest.h>
+#include <random>
+#include <ranges>
+#include <string>
+#include <vector>
+
+namespace centipede::test
+{
+    namespace
+    {
+        using Driver = core::IterationDriver<double, { .has_label_map = true }>;
+
+        constexpr auto n_files = 2U;
+        constexpr auto n_entries_per_file = 300U;
+        constexpr auto label_stride = 1000U;
+        constexpr auto sigma = 0.01F;
+        // Offsets of the planes 1 to 4. The planes 0 and 5 are the reference of the straight tracks.
+        constexpr auto plane_offsets = std::array{ 0.3, -0.2, 0.25, -0.15 };
+
+        auto write_data_files() -> std::vector<std::string>
+        {
+            // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+            auto file_names = std::vector<std::string>{};
+            auto rnd_engine = std::mt19937{ 1 };
+            auto rnd_track_dst = std::uniform_real_distribution<float>{ -1.F, 1.F };
+            auto rnd_noise_dst = std::normal_distribution<float>{ 0.F, sigma };
+            for (const auto file_idx : std::views::iota(0U, n_files))
+            {
+                file_names.push_back(std::format("iteration_driver_{}.bin", file_idx));
+                auto writer = writer::Binary{ writer::Binary::Config{ .out_filename = file_names.back() } };
+                EXPECT_TRUE(writer.init());
+                for ([[maybe_unused]] const auto entry_idx : std::views::iota(0U, n_entries_per_file))
+                {
+                    const auto offset = rnd_track_dst(rnd_engine);
+                    const auto slope = rnd_track_dst(rnd_engine);
+                    for (const auto plane_idx : std::views::iota(0U, plane_offsets.size() + 2U))
+                    {
+                        const auto position = static_cast<float>(plane_idx);
+                        auto measurement = offset + (slope * position) + rnd_noise_dst(rnd_engine);
+                        auto entry_point = EntryPoint<>{};
+                        entry_point.set_locals(1.F, position);
+                        if (plane_idx >= 1 and plane_idx <= plane_offsets.size())
+                        {
+                            measurement += static_cast<float>(plane_offsets.at(plane_idx - 1));
+                            entry_point.add_global(plane_idx * label_stride, 1.F);
+                        }
+                        entry_point.set_measurement(measurement).set_sigma(sigma);
+                        EXPECT_TRUE(writer.add_entrypoint(entry_point));
+                    }
+                    EXPECT_TRUE(writer.write_current_entry());
+                }
+                writer.close();
+            }
+            return file_names;
+            // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+        }
+
+        auto make_config(std::vector<double> chi2_cut_factors, std::string spill_filename = {}) -> Driver::Config
+        {
+            return Driver::Config{
+                .master = { .n_globals = plane_offsets.size(), .alpha = core::engine::significance_level_3_sigma },
+                .n_iterations = 3,
+                .chi2_cut_factors = std::move(chi2_cut_factors),
+                .cache = { .spill_filename = std::move(spill_filename) },
+            };
+        }
+    } // namespace
+
+    TEST(iteration_driver, linear_convergence)
+    {
+        // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+        const auto file_names = write_data_files();
+        const auto spill_filename = std::string{ "iteration_driver_linear_convergence.cache" };
+        auto parameters = std::vector<std::vector<Driver::IdxValuePair>>{};
+        for (const auto& filename : { std::string{}, spill_filename })
+        {
+            // The loose cut accepts all entries, such that the first iteration gives the least squares solution.
+            auto driver = Driver{ make_config({ 1e6 }, filename) };
+            ASSERT_TRUE(driver.run({ .in_filenames = file_names, .n_threads = 1 }));
+            ASSERT_EQ(driver.get_results().size(), 3);
+            EXPECT_EQ(driver.get_cache()->get_n_entries(), n_files * n_entries_per_file);
+
+            const auto& first_result = driver.get_results().front();
+            EXPECT_EQ(first_result.n_entries, n_files * n_entries_per_file);
+            EXPECT_EQ(first_result.n_entries_rejected, 0);
+            // The problem is linear, the following iterations don't correct the parameters anymore.
+            for (const auto& result : driver.get_results() | std::views::drop(1))
+            {
+                EXPECT_EQ(result.n_entries, n_files * n_entries_per_file);
+                for (const auto& [label, correction] : result.parameters)
+                {
+                    EXPECT_NEAR(correction, 0., 1e-8) << "label " << label;
+                }
+            }
+
+            ASSERT_EQ(driver.get_parameters().size(), plane_offsets.size());
+            for (const auto& [plane_idx, parameter] : std::views::enumerate(driver.get_parameters()))
+            {
+                EXPECT_EQ(parameter.first, (plane_idx + 1) * label_stride);
+                EXPECT_NEAR(parameter.second, plane_offsets.at(static_cast<std::size_t>(plane_idx)), 5e-3);
+            }
+            parameters.push_back(driver.get_parameters());
+        }
+        EXPECT_FALSE(std::filesystem::exists(spill_filename));
+        for (const auto& [parameter, spilled_parameter] : std::views::zip(parameters.front(), parameters.back()))
+        {
+            EXPECT_NEAR(parameter.second, spilled_parameter.second, 1e-12);
+        }
+        // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+    }
+
+    TEST(iteration_driver, chi2_cut_factors)
+    {
+        // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+        const auto file_names = write_data_files();
+        const auto n_entries = n_files * n_entries_per_file;
+
+        // Before the offsets are corrected, the nominal cut rejects almost all entries.
+        auto nominal_driver = Driver{ make_config({}) };
+        [[maybe_unused]] auto nominal_res = nominal_driver.run({ .in_filenames = file_names, .n_threads = 1 });
+        ASSERT_FALSE(nominal_driver.get_results().empty());
+        EXPECT_GT(nominal_driver.get_results().front().n_entries_rejected, n_entries * 9 / 10);
+
+        auto driver = Driver{ make_config({ 1e6, 1. }) };
+        EXPECT_DOUBLE_EQ(driver.get_chi2_cut_factor(0), 1e6);
+        EXPECT_DOUBLE_EQ(driver.get_chi2_cut_factor(5), 1.);
+        ASSERT_TRUE(driver.run({ .in_filenames = file_names, .n_threads = 1 }));
+        const auto& results = driver.get_results();
+        ASSERT_EQ(results.size(), 3);
+        EXPECT_EQ(results.front().n_entries_rejected, 0);
+        // After the first correction, the nominal cut only rejects the tails.
+        for (const auto& result : results | std::views::drop(1))
+        {
+            EXPECT_LT(result.n_entries_rejected, n_entries / 50);
+        }
+        for (const auto& [plane_idx, parameter] : std::views::enumerate(driver.get_parameters()))
+        {
+            EXPECT_NEAR(parameter.second, plane_offsets.at(static_cast<std::size_t>(plane_idx)), 5e-3);
+        }
+        // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+    }
+} // namespace centipede::test
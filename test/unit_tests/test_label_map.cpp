@@ -0,0 +1,47 @@
+#include "centipede/util/label_map.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <vector>
+
+using centipede::common::LabelMap;
+
+namespace centipede::test
+{
+    TEST(label_map, insert_and_find)
+    {
+        auto label_map = LabelMap{};
+        EXPECT_TRUE(label_map.empty());
+        EXPECT_EQ(label_map.insert(100'000'000U), 0);
+        EXPECT_EQ(label_map.insert(42U), 1);
+        EXPECT_EQ(label_map.insert(100'000'000U), 0);
+        ASSERT_EQ(label_map.size(), 2);
+
+        EXPECT_EQ(label_map.find(42U), 1);
+        EXPECT_FALSE(label_map.find(7U).has_value());
+        EXPECT_EQ(label_map.get_label(0), 100'000'000U);
+        EXPECT_EQ(label_map.get_label(1), 42U);
+    }
+
+    TEST(label_map, sort_and_truncate)
+    {
+        auto label_map = LabelMap{};
+        const auto labels = std::vector<uint32_t>{ 30, 10, 20, 10 };
+        label_map.insert(labels);
+        ASSERT_EQ(label_map.size(), 3);
+
+        label_map.sort();
+        EXPECT_TRUE(std::ranges::equal(label_map.get_labels(), std::vector<uint32_t>{ 10, 20, 30 }));
+        EXPECT_EQ(label_map.find(10U), 0);
+        EXPECT_EQ(label_map.find(30U), 2);
+
+        label_map.truncate(1);
+        EXPECT_EQ(label_map.size(), 1);
+        EXPECT_FALSE(label_map.find(20U).has_value());
+        EXPECT_EQ(label_map.insert(20U), 1);
+
+        label_map.clear();
+        EXPECT_TRUE(label_map.empty());
+        EXPECT_FALSE(label_map.find(10U).has_value());
+    }
+} // namespace centipede::test
@@ -0,0 +1,69 @@
+#include "centipede/centipede.hpp"
+#include "centipede/reader/label_statistics.hpp"
+#include "centipede/writer/binary.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <ranges>
+#include <string>
+#include <utility>
+#include <vector>
+
+using centipede::reader::LabelStatistics;
+
+namespace centipede::test
+{
+    TEST(label_statistics, scan)
+    {
+        // NOLINTBEGIN(readability-function-cognitive-complexity, cppcoreguidelines-avoid-magic-numbers)
+        constexpr auto n_entries = 40U;
+        constexpr auto common_label = 1000U;
+        auto file_name = std::string{ "label_statistics_scan.bin" };
+        auto writer = writer::Binary{ writer::Binary::Config{ .out_filename = file_name, .index_stride = 4 } };
+        ASSERT_TRUE(writer.init());
+        for (const auto entry_idx : std::views::iota(0U, n_entries))
+        {
+            auto entry_point = EntryPoint<>{};
+            entry_point.set_locals(1.F, 2.F).set_measurement(1.F).set_sigma(0.5F);
+            entry_point.add_global(entry_idx % 5U, 1.F).add_global(common_label, 2.F);
+            if (entry_idx < 3U)
+            {
+                entry_point.add_global(100U + entry_idx, 3.F);
+            }
+            ASSERT_TRUE(writer.add_entrypoint(entry_point));
+            ASSERT_TRUE(writer.write_current_entry());
+        }
+        writer.close();
+
+        for (const auto n_threads : { 1U, 4U })
+        {
+            auto statistics = LabelStatistics{};
+            ASSERT_TRUE(statistics.scan(file_name, { .n_threads = n_threads }));
+            EXPECT_EQ(statistics.get_n_entries(), n_entries);
+            EXPECT_EQ(statistics.get_counts().size(), 9);
+            EXPECT_EQ(statistics.get_count(common_label), n_entries);
+            EXPECT_EQ(statistics.get_count(2U), 8);
+            EXPECT_EQ(statistics.get_count(101U), 1);
+            EXPECT_EQ(statistics.get_count(7U), 0);
+
+            const auto label_map = statistics.make_label_map(8);
+            EXPECT_TRUE(
+                std::ranges::equal(label_map.get_labels(), std::vector<uint32_t>{ 0, 1, 2, 3, 4, common_label }));
+        }
+
+        auto statistics = LabelStatistics{};
+        ASSERT_TRUE(statistics.scan(file_name));
+        ASSERT_TRUE(statistics.scan(file_name, { .use_memory_map = false }));
+        EXPECT_EQ(statistics.get_n_entries(), 2 * n_entries);
+        EXPECT_EQ(statistics.get_count(common_label), 2 * n_entries);
+        // NOLINTEND(readability-function-cognitive-complexity, cppcoreguidelines-avoid-magic-numbers)
+    }
+
+    TEST(label_statistics, missing_file)
+    {
+        auto statistics = LabelStatistics{};
+        const auto scan_err = statistics.scan("label_statistics_missing_file.bin");
+        ASSERT_FALSE(scan_err);
+        EXPECT_EQ(statistics.get_n_entries(), 0);
+    }
+} // namespace centipede::test
@@ -1,11 +1,21 @@
 #include "centipede/centipede.hpp"
 #include "shared.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <expected>
+#include <functional>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <memory>
+#include <random>
+#include <ranges>
+#include <span>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace
 {
@@ -38,10 +48,14 @@ namespace centipede::core::engine
         Engine(std::size_t n_globals) { mock_helper->construct_with(n_globals); }
         using Globals = Globals;
 
-        static void solve(const Globals& globals, Result<DataType>& result) { mock_helper->solve(globals, result); }
+        static void solve(const Globals& globals, Result<DataType>& result, const SolverConfig& /*solver_config*/ = {})
+        {
+            mock_helper->solve(globals, result);
+        }
 
         MOCK_METHOD(void, add_to_globals, (Globals & globals), (const));
         MOCK_METHOD((void), fill_data, (const Entry<DataType>& entry), (const));
+        MOCK_METHOD((void), fill_data, (const FlatEntry& entry), (const));
         MOCK_METHOD((void), add_to_result, (Result<DataType> & result), (const));
         MOCK_METHOD((EnumError<>), analyze, (double alpha), (const));
 
@@ -201,4 +215,599 @@ namespace centipede::test
         EXPECT_FALSE(res);
         EXPECT_EQ(res.error(), ErrorCode::analysis_rank_deficit);
     }
+
+    TEST(master_engine_multi_slaves, analyze_and_solve)
+    {
+        // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+        using SingleMaster = engine::Master<double>;
+        using MultiMaster = engine::Master<double, { .has_multi_slaves = true }>;
+        constexpr auto n_entries = 200;
+        constexpr auto n_points = 10;
+
+        auto single_master = SingleMaster{ SingleMaster::Config{ .n_globals = DEFAULT_MAX_GLOBAL_ID, .alpha = 0. } };
+        auto multi_master =
+            MultiMaster{ MultiMaster::Config{ .n_globals = DEFAULT_MAX_GLOBAL_ID, .alpha = 0., .n_slaves = 4 } };
+        EXPECT_EQ(multi_master.get_slave_pool().get_slaves().size(), 4);
+
+        for ([[maybe_unused]] const auto entry_idx : std::views::iota(0, n_entries))
+        {
+            for (const auto& entry_point : generate_random_entry_points(n_points))
+            {
+                ASSERT_TRUE_RES(single_master.add_entrypoint(entry_point));
+                ASSERT_TRUE_RES(multi_master.add_entrypoint(entry_point));
+            }
+            [[maybe_unused]] auto single_res = single_master.analyze();
+            EXPECT_TRUE_RES(multi_master.analyze());
+            EXPECT_EQ(multi_master.get_current_state().point_index, 0);
+        }
+
+        const auto single_solve_res = single_master.solve();
+        const auto multi_solve_res = multi_master.solve();
+        ASSERT_EQ(single_solve_res.has_value(), multi_solve_res.has_value());
+
+        const auto& single_result = single_master.get_result();
+        const auto& multi_result = multi_master.get_result();
+        EXPECT_EQ(single_result.n_entries, n_entries);
+        EXPECT_EQ(single_result.n_entries, multi_result.n_entries);
+        EXPECT_EQ(single_result.n_entries_rejected, multi_result.n_entries_rejected);
+        ASSERT_EQ(single_result.parameters.size(), multi_result.parameters.size());
+        for (const auto& [single_par, multi_par] : std::views::zip(single_result.parameters, multi_result.parameters))
+        {
+            EXPECT_EQ(single_par.first, multi_par.first);
+            EXPECT_NEAR(single_par.second, multi_par.second, 1e-6 * (1. + std::abs(single_par.second)));
+        }
+        // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+    }
+
+    namespace
+    {
+        /**
+         * @brief Solve the global systems of two masters and compare their parameters.
+         *
+         * Both global systems must be solved. The parameters are compared after sorting them by their labels, where
+         * the labels of the first master are converted to the labels of the second master.
+         */
+        template <typename MasterType, typename OtherMasterType, typename ToOtherLabel = std::identity>
+        void expect_same_parameters(MasterType& master,
+                                    OtherMasterType& other_master,
+                                    ToOtherLabel to_other_label = {})
+        {
+            // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+            ASSERT_TRUE_RES(master.solve());
+            ASSERT_TRUE_RES(other_master.solve());
+            auto parameters = master.get_result().parameters;
+            for (auto& par : parameters)
+            {
+                par.first = to_other_label(par.first);
+            }
+            auto other_parameters = other_master.get_result().parameters;
+            ASSERT_FALSE(parameters.empty());
+            ASSERT_EQ(parameters.size(), other_parameters.size());
+            std::ranges::sort(parameters);
+            std::ranges::sort(other_parameters);
+            for (const auto& [par, other_par] : std::views::zip(parameters, other_parameters))
+            {
+                EXPECT_EQ(par.first, other_par.first);
+                EXPECT_NEAR(par.second, other_par.second, 1e-6 * (1. + std::abs(par.second)));
+            }
+            // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+        }
+
+        // Zero local derivatives are dropped, as they are not stored in binary files.
+        auto to_flat_entry(const std::vector<EntryPoint<>>& entry_points, FlatEntry& flat_entry)
+        {
+            flat_entry.clear();
+            for (const auto& entry_point : entry_points)
+            {
+                flat_entry.add_point(entry_point.get_measurement(), entry_point.get_sigma());
+                for (const auto [local_idx, local] : std::views::enumerate(entry_point.get_locals()))
+                {
+                    if (local != 0)
+                    {
+                        flat_entry.add_local(static_cast<uint32_t>(local_idx), local);
+                    }
+                }
+                for (const auto [global_idx, global] : entry_point.get_globals())
+                {
+                    flat_entry.add_global(global_idx, global);
+                }
+            }
+        }
+
+        template <typename MasterType>
+        void check_flat_entry_analysis()
+        {
+            // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+            constexpr auto n_entries = 100;
+            constexpr auto n_points = 10;
+
+            auto master = MasterType{ typename MasterType::Config{ .n_globals = DEFAULT_MAX_GLOBAL_ID, .alpha = 0. } };
+            auto flat_master =
+                MasterType{ typename MasterType::Config{ .n_globals = DEFAULT_MAX_GLOBAL_ID, .alpha = 0. } };
+            auto flat_entry = FlatEntry{};
+
+            for ([[maybe_unused]] const auto entry_idx : std::views::iota(0, n_entries))
+            {
+                const auto entry_points = generate_random_entry_points(n_points);
+                for (const auto& entry_point : entry_points)
+                {
+                    ASSERT_TRUE_RES(master.add_entrypoint(entry_point));
+                }
+                [[maybe_unused]] auto res = master.analyze();
+                to_flat_entry(entry_points, flat_entry);
+                [[maybe_unused]] auto flat_res = flat_master.analyze(flat_entry);
+            }
+
+            expect_same_parameters(master, flat_master);
+            const auto& result = master.get_result();
+            const auto& flat_result = flat_master.get_result();
+            EXPECT_EQ(result.n_entries, flat_result.n_entries);
+            EXPECT_EQ(result.n_entries_rejected, flat_result.n_entries_rejected);
+            // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+        }
+
+        template <typename MasterType>
+        void check_flat_batch_analysis()
+        {
+            // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+            constexpr auto n_entries = 100;
+            constexpr auto n_points = 10;
+            constexpr auto batch_size = 16;
+
+            auto master = MasterType{ typename MasterType::Config{ .n_globals = DEFAULT_MAX_GLOBAL_ID, .alpha = 0. } };
+            auto batch_master =
+                MasterType{ typename MasterType::Config{ .n_globals = DEFAULT_MAX_GLOBAL_ID, .alpha = 0. } };
+
+            // Each entry appears twice, such that the batches contain entries with identical global parameters.
+            auto flat_entries = std::vector<FlatEntry>(2 * n_entries);
+            for (const auto entry_idx : std::views::iota(0, n_entries))
+            {
+                to_flat_entry(generate_random_entry_points(n_points), flat_entries[2 * entry_idx]);
+                flat_entries[(2 * entry_idx) + 1] = flat_entries[2 * entry_idx];
+            }
+            flat_entries.emplace_back();
+
+            for (const auto& flat_entry : flat_entries)
+            {
+                [[maybe_unused]] auto res = master.analyze(flat_entry);
+            }
+            for (const auto batch : flat_entries | std::views::chunk(batch_size))
+            {
+                ASSERT_TRUE_RES(batch_master.analyze(std::span<const FlatEntry>{ batch }));
+            }
+
+            expect_same_parameters(master, batch_master);
+            const auto& result = master.get_result();
+            const auto& batch_result = batch_master.get_result();
+            EXPECT_EQ(result.n_entries, batch_result.n_entries);
+            EXPECT_EQ(result.n_entries_rejected, batch_result.n_entries_rejected);
+            // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+        }
+    } // namespace
+
+    TEST(master_engine_flat_entry, same_result_as_entrypoints)
+    {
+        check_flat_entry_analysis<engine::Master<double>>();
+    }
+
+    TEST(master_engine_flat_entry, multi_slaves_same_result_as_entrypoints)
+    {
+        check_flat_entry_analysis<engine::Master<double, { .has_multi_slaves = true }>>();
+    }
+
+    TEST(master_engine_flat_entry, batch_same_result_as_single_entries)
+    {
+        check_flat_batch_analysis<engine::Master<double>>();
+        check_flat_batch_analysis<engine::Master<double, { .engine_type = EngineType::eigen_sparse }>>();
+    }
+
+    TEST(master_engine_flat_entry, multi_slaves_batch_same_result_as_single_entries)
+    {
+        check_flat_batch_analysis<engine::Master<double, { .has_multi_slaves = true }>>();
+    }
+
+    TEST(master_engine_flat_entry, batch_incompatible_n_locals)
+    {
+        using FixedMaster = engine::Master<double, { .n_locals = DEFAULT_N_LOCALS }>;
+        auto master = FixedMaster{ FixedMaster::Config{ .n_globals = DEFAULT_MAX_GLOBAL_ID } };
+
+        auto flat_entries = std::vector<FlatEntry>(2);
+        to_flat_entry(generate_random_entry_points(1), flat_entries[0]);
+        to_flat_entry(generate_random_entry_points(1, DEFAULT_N_GLOBALS, DEFAULT_N_LOCALS + 1), flat_entries[1]);
+        const auto res = master.analyze(std::span<const FlatEntry>{ flat_entries });
+        ASSERT_FALSE(res.has_value());
+        EXPECT_EQ(res.error(), ErrorCode::handler_incomp_n_locals);
+        EXPECT_EQ(master.get_engine().get_log().n_entries_read, 0);
+    }
+
+    TEST(master_engine_flat_entry, trailing_zero_local)
+    {
+        // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+        using FixedMaster = engine::Master<double, { .n_locals = DEFAULT_N_LOCALS }>;
+        constexpr auto n_points = 10;
+        auto master = FixedMaster{ FixedMaster::Config{ .n_globals = DEFAULT_MAX_GLOBAL_ID, .alpha = 0. } };
+        auto flat_master = FixedMaster{ FixedMaster::Config{ .n_globals = DEFAULT_MAX_GLOBAL_ID, .alpha = 0. } };
+
+        // The derivatives of the last local parameter are zero in all entrypoints.
+        auto entry_points = generate_random_entry_points(n_points, DEFAULT_N_GLOBALS, DEFAULT_N_LOCALS - 1);
+        for (auto& entry_point : entry_points)
+        {
+            entry_point.add_local(0.F);
+            ASSERT_TRUE_RES(master.add_entrypoint(entry_point));
+        }
+        const auto res = master.analyze();
+        ASSERT_FALSE(res.has_value());
+        EXPECT_EQ(res.error(), ErrorCode::analysis_local_fit_rank_deficit);
+
+        auto flat_entry = FlatEntry{};
+        to_flat_entry(entry_points, flat_entry);
+        EXPECT_EQ(flat_entry.get_n_locals(), DEFAULT_N_LOCALS - 1);
+        const auto flat_res = flat_master.analyze(flat_entry);
+        ASSERT_FALSE(flat_res.has_value());
+        EXPECT_EQ(flat_res.error(), res.error());
+        EXPECT_EQ(flat_master.get_engine().get_current_state().n_locals, DEFAULT_N_LOCALS);
+        EXPECT_EQ(flat_master.get_engine().get_log().n_entries_local_rank_deficit, 1);
+        // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+    }
+
+    namespace
+    {
+        constexpr auto SPARSE_LABEL_STRIDE = 1'000'003U;
+
+        auto to_sparse_label(uint32_t label) -> uint32_t { return (label * SPARSE_LABEL_STRIDE) + 7U; }
+
+        template <typename MasterType>
+        void check_label_map_analysis()
+        {
+            // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+            constexpr auto n_entries = 100;
+            constexpr auto n_points = 10;
+
+            auto master = engine::Master<double>{ { .n_globals = DEFAULT_MAX_GLOBAL_ID, .alpha = 0. } };
+            auto mapped_master = MasterType{ typename MasterType::Config{ .n_globals = DEFAULT_MAX_GLOBAL_ID,
+                                                                          .alpha = 0. } };
+            auto flat_entry = FlatEntry{};
+
+            for (const auto entry_idx : std::views::iota(0, n_entries))
+            {
+                const auto entry_points = generate_random_entry_points(n_points);
+                for (const auto& entry_point : entry_points)
+                {
+                    ASSERT_TRUE_RES(master.add_entrypoint(entry_point));
+                }
+                [[maybe_unused]] auto res = master.analyze();
+
+                // Half of the entries go through the entrypoint interface, half as flat entries.
+                if (entry_idx % 2 == 0)
+                {
+                    for (const auto& entry_point : entry_points)
+                    {
+                        auto sparse_point = EntryPoint<>{};
+                        sparse_point.set_measurement(entry_point.get_measurement()).set_sigma(entry_point.get_sigma());
+                        for (const auto local : entry_point.get_locals())
+                        {
+                            sparse_point.add_local(local);
+                        }
+                        for (const auto [label, global] : entry_point.get_globals())
+                        {
+                            sparse_point.add_global(to_sparse_label(label), global);
+                        }
+                        ASSERT_TRUE_RES(mapped_master.add_entrypoint(sparse_point));
+                    }
+                    [[maybe_unused]] auto mapped_res = mapped_master.analyze();
+                }
+                else
+                {
+                    to_flat_entry(entry_points, flat_entry);
+                    std::ranges::transform(flat_entry.get_global_labels(),
+                                           flat_entry.get_global_labels().begin(),
+                                           to_sparse_label);
+                    ASSERT_TRUE_RES(mapped_master.analyze(flat_entry));
+                }
+            }
+
+            // With label maps, the order of the parameters depends on the order in which the labels are inserted.
+            expect_same_parameters(master,
+                                   mapped_master,
+                                   [](std::size_t label) -> std::size_t
+                                   { return to_sparse_label(static_cast<uint32_t>(label)); });
+            EXPECT_EQ(master.get_result().n_entries, mapped_master.get_result().n_entries);
+            // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+        }
+    } // namespace
+
+    TEST(master_engine_label_map, same_result_as_dense_labels)
+    {
+        check_label_map_analysis<engine::Master<double, { .has_label_map = true }>>();
+        check_label_map_analysis<
+            engine::Master<double, { .engine_type = EngineType::eigen_sparse, .has_label_map = true }>>();
+    }
+
+    TEST(master_engine_label_map, multi_slaves_same_result_as_dense_labels)
+    {
+        check_label_map_analysis<engine::Master<double, { .has_multi_slaves = true, .has_label_map = true }>>();
+    }
+
+    TEST(master_engine_label_map, too_many_globals)
+    {
+        using MappedMaster = engine::Master<double, { .has_label_map = true }>;
+        auto label_map = common::LabelMap{};
+        label_map.insert(std::vector<uint32_t>{ 500, 100 });
+        label_map.sort();
+        auto master = MappedMaster{ MappedMaster::Config{ .n_globals = 3, .label_map = std::move(label_map) } };
+        EXPECT_EQ(master.get_label_map().find(100U), 0);
+
+        auto flat_entry = FlatEntry{};
+        flat_entry.add_point(1.F, 1.F);
+        flat_entry.add_local(0, 1.F);
+        flat_entry.add_global(100, 1.F);
+        flat_entry.add_global(300, 1.F);
+        flat_entry.add_global(700, 1.F);
+        const auto res = master.analyze(flat_entry);
+        ASSERT_FALSE(res.has_value());
+        EXPECT_EQ(res.error(), ErrorCode::handler_too_many_globals);
+        EXPECT_EQ(master.get_label_map().size(), 2);
+
+        auto entry_point = EntryPoint<>{};
+        entry_point.set_measurement(1.F).set_sigma(1.F).add_local(1.F);
+        entry_point.add_global(300, 1.F).add_global(500, 1.F);
+        ASSERT_TRUE_RES(master.add_entrypoint(entry_point));
+        EXPECT_EQ(master.get_label_map().find(300U), 2);
+        EXPECT_EQ(master.get_current_state().entry.global_derivs.size(), 2);
+    }
+
+    TEST(master_engine_label_map, multi_slaves_too_many_globals_recycles_entry)
+    {
+        using MappedMaster = engine::Master<double, { .has_multi_slaves = true, .has_label_map = true }>;
+        auto master = MappedMaster{ MappedMaster::Config{ .n_globals = 1, .n_slaves = 1 } };
+
+        auto flat_entry = FlatEntry{};
+        flat_entry.add_point(1.F, 1.F);
+        flat_entry.add_local(0, 1.F);
+        flat_entry.add_global(100, 1.F);
+        flat_entry.add_global(300, 1.F);
+        const auto res = master.analyze(flat_entry);
+        ASSERT_FALSE(res.has_value());
+        EXPECT_EQ(res.error(), ErrorCode::handler_too_many_globals);
+        EXPECT_EQ(master.get_slave_pool().get_n_recycled_flat_entries(), 1);
+    }
+
+    TEST(master_engine_label_map, fixed_label_map_skips_labels)
+    {
+        // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+        using MappedMaster = engine::Master<double, { .has_label_map = true }>;
+        constexpr auto n_entries = 100;
+        constexpr auto n_points = 10;
+        constexpr auto n_kept_labels = DEFAULT_MAX_GLOBAL_ID / 2;
+
+        auto label_map = common::LabelMap{};
+        for (const auto label : std::views::iota(0U, static_cast<uint32_t>(n_kept_labels)))
+        {
+            label_map.insert(to_sparse_label(label));
+        }
+        auto master = engine::Master<double>{ { .n_globals = n_kept_labels, .alpha = 0. } };
+        auto mapped_master = MappedMaster{ MappedMaster::Config{ .n_globals = n_kept_labels,
+                                                                 .alpha = 0.,
+                                                                 .label_map = std::move(label_map),
+                                                                 .is_label_map_fixed = true } };
+        auto flat_entry = FlatEntry{};
+        for ([[maybe_unused]] const auto entry_idx : std::views::iota(0, n_entries))
+        {
+            to_flat_entry(generate_random_entry_points(n_points), flat_entry);
+            std::ranges::transform(
+                flat_entry.get_global_labels(), flat_entry.get_global_labels().begin(), to_sparse_label);
+            ASSERT_TRUE_RES(mapped_master.analyze(flat_entry));
+            flat_entry.remove_globals_if([](uint32_t label) { return label >= to_sparse_label(n_kept_labels); });
+            std::ranges::transform(flat_entry.get_global_labels(),
+                                   flat_entry.get_global_labels().begin(),
+                                   [](uint32_t label) { return (label - 7U) / SPARSE_LABEL_STRIDE; });
+            [[maybe_unused]] auto res = master.analyze(flat_entry);
+        }
+        EXPECT_EQ(mapped_master.get_label_map().size(), n_kept_labels);
+
+        expect_same_parameters(master,
+                               mapped_master,
+                               [](std::size_t label) -> std::size_t
+                               { return to_sparse_label(static_cast<uint32_t>(label)); });
+        // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+    }
+
+    namespace
+    {
+        /**
+         * @brief Compare the results of a master analyzing all entries and a master resuming from the checkpoint of
+         * another master, which analyzed the first half of the entries.
+         */
+        template <typename MasterType>
+        void check_checkpoint_resume(bool is_sparse_checkpoint, bool has_sparse_labels = false)
+        {
+            // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+            constexpr auto n_entries = 100;
+            constexpr auto n_points = 10;
+            const auto file_name = std::string{ "master_engine_checkpoint_resume.ckpt" };
+            const auto config = typename MasterType::Config{ .n_globals = DEFAULT_MAX_GLOBAL_ID, .alpha = 0. };
+
+            auto master = MasterType{ config };
+            auto first_master = MasterType{ config };
+            auto resumed_master = MasterType{ config };
+            auto flat_entry = FlatEntry{};
+            for (const auto entry_idx : std::views::iota(0, n_entries))
+            {
+                to_flat_entry(generate_random_entry_points(n_points), flat_entry);
+                if (has_sparse_labels)
+                {
+                    std::ranges::transform(
+                        flat_entry.get_global_labels(), flat_entry.get_global_labels().begin(), to_sparse_label);
+                }
+                [[maybe_unused]] auto res = master.analyze(flat_entry);
+                [[maybe_unused]] auto partial_res = (entry_idx < n_entries / 2) ? first_master.analyze(flat_entry)
+                                                                                : resumed_master.analyze(flat_entry);
+            }
+            ASSERT_TRUE_RES(first_master.write_checkpoint(file_name, is_sparse_checkpoint));
+            ASSERT_TRUE_RES(resumed_master.add_checkpoint(file_name));
+
+            expect_same_parameters(master, resumed_master);
+            const auto& result = master.get_result();
+            const auto& resumed_result = resumed_master.get_result();
+            EXPECT_EQ(result.n_entries, resumed_result.n_entries);
+            EXPECT_EQ(result.n_entries_rejected, resumed_result.n_entries_rejected);
+            // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+        }
+    } // namespace
+
+    TEST(master_engine_checkpoint, resume_same_result)
+    {
+        check_checkpoint_resume<engine::Master<double>>(false);
+        check_checkpoint_resume<engine::Master<double>>(true);
+        check_checkpoint_resume<engine::Master<double, { .engine_type = EngineType::eigen_sparse }>>(false);
+        check_checkpoint_resume<engine::Master<double, { .engine_type = EngineType::eigen_sparse }>>(true);
+    }
+
+    TEST(master_engine_checkpoint, multi_slaves_resume_same_result)
+    {
+        check_checkpoint_resume<engine::Master<double, { .has_multi_slaves = true }>>(true);
+    }
+
+    TEST(master_engine_checkpoint, label_map_resume_same_result)
+    {
+        check_checkpoint_resume<engine::Master<double, { .has_label_map = true }>>(false, true);
+        check_checkpoint_resume<
+            engine::Master<double, { .engine_type = EngineType::eigen_sparse, .has_label_map = true }>>(true, true);
+    }
+
+    TEST(master_engine_checkpoint, invalid_checkpoint)
+    {
+        using MappedMaster = engine::Master<double, { .has_label_map = true }>;
+        const auto file_name = std::string{ "master_engine_invalid_checkpoint.ckpt" };
+        auto flat_entry = FlatEntry{};
+        to_flat_entry(generate_random_entry_points(1), flat_entry);
+
+        auto master = engine::Master<double>{ { .n_globals = DEFAULT_MAX_GLOBAL_ID } };
+        auto missing_res = master.add_checkpoint("master_engine_missing_checkpoint.ckpt");
+        ASSERT_FALSE(missing_res);
+        EXPECT_EQ(missing_res.error(), ErrorCode::reader_file_fail_to_open);
+
+        // Checkpoint with more global parameters than the master.
+        [[maybe_unused]] auto res = master.analyze(flat_entry);
+        ASSERT_TRUE_RES(master.write_checkpoint(file_name));
+        auto small_master = engine::Master<double>{ { .n_globals = DEFAULT_MAX_GLOBAL_ID / 2 } };
+        auto size_res = small_master.add_checkpoint(file_name);
+        ASSERT_FALSE(size_res);
+        EXPECT_EQ(size_res.error(), ErrorCode::reader_invalid_checkpoint);
+
+        // Checkpoints with and without labels can't be mixed.
+        auto mapped_master = MappedMaster{ MappedMaster::Config{ .n_globals = DEFAULT_MAX_GLOBAL_ID } };
+        auto labels_res = mapped_master.add_checkpoint(file_name);
+        ASSERT_FALSE(labels_res);
+        EXPECT_EQ(labels_res.error(), ErrorCode::reader_invalid_checkpoint);
+        [[maybe_unused]] auto mapped_res = mapped_master.analyze(flat_entry);
+        ASSERT_TRUE_RES(mapped_master.write_checkpoint(file_name));
+        labels_res = master.add_checkpoint(file_name);
+        ASSERT_FALSE(labels_res);
+        EXPECT_EQ(labels_res.error(), ErrorCode::reader_invalid_checkpoint);
+    }
+
+    namespace
+    {
+        // Offsets of six planes of straight tracks, which don't change the sum and the tilt of the planes.
+        constexpr auto constrained_offsets = std::array{ 0.1, -0.2, 0.1, 0.05, -0.1, 0.05 };
+
+        auto to_plane_label(std::size_t plane_idx) -> uint32_t { return static_cast<uint32_t>(plane_idx + 1) * 100U; }
+
+        /**
+         * @brief Solve the offsets of all planes, whose common shift and tilt are only fixed by constraints.
+         */
+        template <typename MasterType>
+        void check_constrained_planes()
+        {
+            // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+            constexpr auto sigma = 0.001F;
+            // The loose chi2 cut accepts the entries before the offsets are corrected.
+            const auto make_master = []()
+            {
+                return MasterType{ typename MasterType::Config{
+                    .n_globals = constrained_offsets.size(), .alpha = 0., .chi2_cut_factor = 1e6 } };
+            };
+            auto sum_constraint = engine::Constraint<double>{};
+            auto tilt_constraint = engine::Constraint<double>{};
+            for (const auto plane_idx : std::views::iota(0UZ, constrained_offsets.size()))
+            {
+                sum_constraint.terms.emplace_back(to_plane_label(plane_idx), 1.);
+                tilt_constraint.terms.emplace_back(to_plane_label(plane_idx), static_cast<double>(plane_idx));
+            }
+
+            auto entries = std::vector<FlatEntry>(200);
+            auto rnd_engine = std::mt19937{ 1 };
+            auto rnd_track_dst = std::uniform_real_distribution<float>{ -1.F, 1.F };
+            auto rnd_noise_dst = std::normal_distribution<float>{ 0.F, sigma };
+            for (auto& entry : entries)
+            {
+                const auto offset = rnd_track_dst(rnd_engine);
+                const auto slope = rnd_track_dst(rnd_engine);
+                for (const auto [plane_idx, plane_offset] : std::views::enumerate(constrained_offsets))
+                {
+                    const auto position = static_cast<float>(plane_idx);
+                    entry.add_point(offset + (slope * position) + static_cast<float>(plane_offset) +
+                                        rnd_noise_dst(rnd_engine),
+                                    sigma);
+                    entry.add_local(0, 1.F);
+                    entry.add_local(1, position);
+                    entry.add_global(to_plane_label(static_cast<std::size_t>(plane_idx)), 1.F);
+                }
+            }
+
+            // The shift and the tilt of all planes are weak modes, such that the global system is singular.
+            auto unconstrained_master = make_master();
+            ASSERT_TRUE_RES(unconstrained_master.analyze(entries));
+            const auto unconstrained_res = unconstrained_master.solve();
+            EXPECT_FALSE(unconstrained_res);
+
+            // With global parameters, the constraints apply to the sums of the parameters and the corrections.
+            for (const auto initial_parameter : { 0., 0.1 })
+            {
+                auto master = make_master();
+                if (initial_parameter != 0.)
+                {
+                    auto parameters = std::vector<typename MasterType::Result::IdxValuePair>{};
+                    for (const auto plane_idx : std::views::iota(0UZ, constrained_offsets.size()))
+                    {
+                        parameters.emplace_back(to_plane_label(plane_idx), initial_parameter);
+                    }
+                    ASSERT_TRUE_RES(master.set_global_parameters(parameters));
+                }
+                ASSERT_TRUE_RES(master.add_constraint(sum_constraint));
+                ASSERT_TRUE_RES(master.add_constraint(tilt_constraint));
+                EXPECT_EQ(master.get_constraints().size(), 2);
+                ASSERT_TRUE_RES(master.analyze(entries));
+                ASSERT_TRUE_RES(master.solve());
+
+                const auto& parameters = master.get_result().parameters;
+                ASSERT_EQ(parameters.size(), constrained_offsets.size());
+                for (const auto [plane_idx, parameter] : std::views::enumerate(parameters))
+                {
+                    const auto expected_offset = constrained_offsets.at(static_cast<std::size_t>(plane_idx));
+                    EXPECT_EQ(parameter.first, to_plane_label(static_cast<std::size_t>(plane_idx)));
+                    EXPECT_NEAR(parameter.second + initial_parameter, expected_offset, 1e-3);
+                }
+            }
+            // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+        }
+    } // namespace
+
+    TEST(master_engine_constraints, fix_weak_modes)
+    {
+        check_constrained_planes<engine::Master<double, { .has_label_map = true }>>();
+        check_constrained_planes<
+            engine::Master<double, { .engine_type = EngineType::eigen_sparse, .has_label_map = true }>>();
+    }
+
+    TEST(master_engine_constraints, invalid_label)
+    {
+        auto master = engine::Master<double>{ { .n_globals = 3 } };
+        const auto constraint_res =
+            master.add_constraint({ .terms = { { 0, 1. }, { 3, 1. } }, .value = 0. }); // NOLINT (magic numbers)
+        ASSERT_FALSE(constraint_res);
+        EXPECT_EQ(constraint_res.error(), ErrorCode::handler_too_many_globals);
+        EXPECT_TRUE(master.get_constraints().empty());
+    }
 } // namespace centipede::test
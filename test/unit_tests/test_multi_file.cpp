@@ -0,0 +1,145 @@
+#include "centipede/centipede.hpp"
+#include "centipede/reader/multi_file.hpp"
+#include "centipede/util/error_types.hpp"
+#include "centipede/writer/binary.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <ios>
+#include <ranges>
+#include <string>
+#include <vector>
+
+using centipede::reader::MultiFile;
+namespace fs = std::filesystem;
+
+namespace centipede::test
+{
+    namespace
+    {
+        // Each entry has one point with the global labels `file_idx` and `100 + entry_idx`.
+        void write_test_file(const std::string& file_name, uint32_t file_idx, uint32_t n_entries)
+        {
+            // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+            auto writer = writer::Binary{ writer::Binary::Config{ .out_filename = file_name } };
+            ASSERT_TRUE(writer.init());
+            for (const auto entry_idx : std::views::iota(0U, n_entries))
+            {
+                auto entry_point = EntryPoint<>{};
+                entry_point.set_locals(1.F, 2.F).set_measurement(1.F).set_sigma(0.5F);
+                entry_point.add_global(file_idx, 1.F).add_global(100U + entry_idx, 2.F);
+                ASSERT_TRUE(writer.add_entrypoint(entry_point));
+                ASSERT_TRUE(writer.write_current_entry());
+            }
+            writer.close();
+            // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+        }
+    } // namespace
+
+    TEST(multi_file, read_all_files)
+    {
+        // NOLINTBEGIN (cppcoreguidelines-avoid-magic-numbers)
+        constexpr auto n_files = 5U;
+        auto file_names = std::vector<std::string>{};
+        auto n_expected_entries = std::vector<uint32_t>{};
+        for (const auto file_idx : std::views::iota(0U, n_files))
+        {
+            file_names.push_back(std::format("multi_file_read_all_files_{}.bin", file_idx));
+            n_expected_entries.push_back(10U * (file_idx + 1U));
+            write_test_file(file_names.back(), file_idx, n_expected_entries.back());
+        }
+
+        for (const auto use_memory_map : { true, false })
+        {
+            auto input = MultiFile{ MultiFile::Config{ .in_filenames = file_names,
+                                                       .n_threads = 3,
+                                                       .batch_size = 4,
+                                                       .max_n_queued_batches = 2,
+                                                       .use_memory_map = use_memory_map } };
+            ASSERT_TRUE(input.start());
+
+            auto n_entries = std::vector<uint32_t>(n_files);
+            auto n_batches = 0U;
+            while (auto batch = input.next_batch())
+            {
+                ++n_batches;
+                EXPECT_LE(batch->n_entries, 4);
+                for (const auto& entry : batch->get_entries())
+                {
+                    const auto labels = entry.get_global_labels();
+                    ASSERT_EQ(labels.size(), 2);
+                    ASSERT_LT(labels.front(), n_files);
+                    ++n_entries[labels.front()];
+                }
+                input.recycle(std::move(batch.value()));
+            }
+            EXPECT_TRUE(input.is_ok());
+            EXPECT_EQ(n_entries, n_expected_entries);
+            EXPECT_EQ(input.get_n_entries(), 150);
+            EXPECT_GE(n_batches, 150U / 4U);
+        }
+        // NOLINTEND (cppcoreguidelines-avoid-magic-numbers)
+    }
+
+    TEST(multi_file, missing_file)
+    {
+        write_test_file("multi_file_missing_file_0.bin", 0, 3);
+        auto input = MultiFile{ MultiFile::Config{
+            .in_filenames = { "multi_file_missing_file_0.bin", "multi_file_missing_file_1.bin" }, .n_threads = 1 } };
+        ASSERT_TRUE(input.start());
+        while (auto batch = input.next_batch())
+        {
+            input.recycle(std::move(batch.value()));
+        }
+        EXPECT_EQ(input.get_status(), ErrorCode::reader_file_fail_to_open);
+
+        auto empty_input = MultiFile{ MultiFile::Config{} };
+        const auto start_err = empty_input.start();
+        ASSERT_FALSE(start_err);
+        EXPECT_EQ(start_err.error(), ErrorCode::reader_invalid_filename);
+    }
+
+    TEST(multi_file, find_files)
+    {
+        const auto dir = fs::path{ "multi_file_find_files" };
+        fs::remove_all(dir);
+        fs::create_directory(dir);
+        for (const auto* name : { "run_1.bin", "run_2.bin", "run_10.bin", "run_1.bin.idx", "other.bin" })
+        {
+            auto file = std::ofstream{ dir / name, std::ios::out | std::ios::binary | std::ios::trunc };
+        }
+
+        const auto all_runs = MultiFile::find_files((dir / "run_*.bin").string());
+        ASSERT_TRUE(all_runs);
+        EXPECT_EQ(all_runs.value(),
+                  (std::vector<std::string>{
+                      (dir / "run_1.bin").string(), (dir / "run_10.bin").string(), (dir / "run_2.bin").string() }));
+
+        const auto single_digit_runs = MultiFile::find_files((dir / "run_?.bin").string());
+        ASSERT_TRUE(single_digit_runs);
+        EXPECT_EQ(single_digit_runs->size(), 2);
+
+        const auto missing_dir = MultiFile::find_files("multi_file_missing_dir/*.bin");
+        ASSERT_FALSE(missing_dir);
+        EXPECT_EQ(missing_dir.error(), ErrorCode::reader_file_fail_to_open);
+    }
+
+    TEST(multi_file, select_shard)
+    {
+        const auto file_names = std::vector<std::string>{ "0.bin", "1.bin", "2.bin", "3.bin", "4.bin" };
+        const auto shard_0 = MultiFile::select_shard(file_names, 0, 2);
+        ASSERT_TRUE(shard_0);
+        EXPECT_EQ(shard_0.value(), (std::vector<std::string>{ "0.bin", "2.bin", "4.bin" }));
+        const auto shard_1 = MultiFile::select_shard(file_names, 1, 2);
+        ASSERT_TRUE(shard_1);
+        EXPECT_EQ(shard_1.value(), (std::vector<std::string>{ "1.bin", "3.bin" }));
+
+        const auto invalid_shard = MultiFile::select_shard(file_names, 2, 2);
+        ASSERT_FALSE(invalid_shard);
+        EXPECT_EQ(invalid_shard.error(), ErrorCode::reader_invalid_filename);
+    }
+} // namespace centipede::test